@@ -20,6 +20,15 @@ int main(int argc, char **argv) {
     f.compute_root();
     f.debug_to_file("f.tiff");
 
+    // Exercise vector code in the C backend, including a gather
+    // (f(y, x)) and a vectorized call to an extern function.
+    f.vectorize(x, 8);
+    g.vectorize(x, 8);
+
+    // And parallel loops.
+    f.parallel(y);
+    g.parallel(y);
+
     std::vector<Argument> args;
     args.push_back(input);
 
@@ -9,6 +9,7 @@
 #include <cstddef>
 #include <limits>
 #include <map>
+#include <tuple>
 #include <ostream>
 #include <string>
 
@@ -1026,6 +1027,15 @@ vector<int> radix_factor(int N) {
         }
     }
 
+    // Break what's left into its prime factors. A few DFTs of small
+    // prime sizes are much cheaper than one direct DFT of their product.
+    for (int p = 3; p * p <= N; p += 2) {
+        while (N % p == 0) {
+            R.push_back(p);
+            N /= p;
+        }
+    }
+
     // If there are still factors left over, just include them as a radix.
     if (N != 1 || R.empty()) {
         R.push_back(N);
@@ -1057,3 +1067,100 @@ Func fft2d_c2r(ComplexFunc c,
                const Fft2dDesc& desc) {
     return fft2d_c2r(c, radix_factor(N0), radix_factor(N1), target, desc);
 }
+
+FftPlan::FftPlan(FftType type, int N0, int N1, int sign, bool batched,
+                 const Target& target, const Fft2dDesc& desc)
+    : target(target) {
+    Var c("c"), x("x"), y("y"), b("b");
+
+    vector<Var> args = {x, y};
+    vector<Expr> re_args = {0, x, y};
+    vector<Expr> im_args = {1, x, y};
+    if (batched) {
+        args.push_back(b);
+        re_args.push_back(b);
+        im_args.push_back(b);
+    }
+    vector<Var> c_args = args;
+    c_args.insert(c_args.begin(), c);
+
+    // The transform, and the Func that computes it.
+    Func fft;
+    ComplexFunc complex_fft;
+    if (type == FftType::R2C) {
+        input = ImageParam(Float(32), (int)args.size(), "input");
+        Func in("in");
+        in(args) = input(args);
+        complex_fft = fft2d_r2c(in, N0, N1, target, desc);
+        fft = complex_fft;
+    } else {
+        input = ImageParam(Float(32), (int)args.size() + 1, "input");
+        input.set_bounds(0, 0, 2);
+        input.set_stride(1, 2);
+        ComplexFunc in("in");
+        in(args) = ComplexExpr(input(re_args), input(im_args));
+        if (type == FftType::C2R) {
+            fft = fft2d_c2r(in, N0, N1, target, desc);
+        } else {
+            complex_fft = fft2d_c2c(in, N0, N1, sign, target, desc);
+            fft = complex_fft;
+        }
+    }
+
+    Func result("result");
+    if (complex_fft.defined()) {
+        result(c_args) = select(c == 0, re(complex_fft(args)), im(complex_fft(args)));
+        result.output_buffer().set_bounds(0, 0, 2);
+        result.output_buffer().set_stride(1, 2);
+        result.bound(c, 0, 2).unroll(c);
+    } else {
+        result(args) = fft(args);
+    }
+
+    // Each FFT in a batch is independent.
+    if (batched) {
+        fft.compute_at(result, b);
+        result.parallel(b);
+    } else {
+        fft.compute_root();
+    }
+
+    pipeline = Pipeline(result);
+    pipeline.compile_jit(target);
+}
+
+std::shared_ptr<FftPlan> FftPlan::get(FftType type, int N0, int N1, int sign,
+                                      bool batched,
+                                      const Target& target,
+                                      float gain,
+                                      int vector_width,
+                                      bool parallel) {
+    if (type == FftType::R2C) {
+        sign = -1;
+    } else if (type == FftType::C2R) {
+        sign = 1;
+    }
+
+    typedef std::tuple<FftType, int, int, int, bool, string, float, int, bool> Key;
+    static std::map<Key, std::shared_ptr<FftPlan>> cache;
+    static std::mutex cache_mutex;
+
+    Key key(type, N0, N1, sign, batched, target.to_string(), gain, vector_width, parallel);
+
+    std::lock_guard<std::mutex> lock(cache_mutex);
+    std::shared_ptr<FftPlan> &plan = cache[key];
+    if (!plan) {
+        Fft2dDesc desc;
+        desc.gain = gain;
+        desc.vector_width = vector_width;
+        desc.parallel = parallel;
+        plan.reset(new FftPlan(type, N0, N1, sign, batched, target, desc));
+    }
+    return plan;
+}
+
+void FftPlan::execute(const Image<float> &in, Image<float> out) {
+    std::lock_guard<std::mutex> lock(mutex);
+    input.set(in);
+    pipeline.realize(out, target);
+}
@@ -3,6 +3,8 @@
 
 #include <algorithm>
 #include <limits>
+#include <memory>
+#include <mutex>
 #include <vector>
 #include <string>
 
@@ -66,4 +68,42 @@ Halide::Func fft2d_c2r(ComplexFunc c, int N0, int N1,
                        const Halide::Target& target,
                        const Fft2dDesc& desc = Fft2dDesc());
 
+// The kinds of transform an FftPlan can compute.
+enum class FftType { C2C, R2C, C2R };
+
+// A compiled N0 x N1 2D FFT, ready to run on buffers. Plans are cached,
+// so getting a plan that has been used before does not compile it again.
+//
+// Real buffers have dimensions [N0, N1]. Complex buffers have dimensions
+// [2, N0, N1], where dimension 0 holds the real and imaginary parts, and
+// must have a stride of 2 in dimension 1. The complex side of an R2C or
+// C2R transform has N1 / 2 + 1 rows. A batched plan transforms each slice
+// of one more, outermost, dimension, in parallel.
+class FftPlan {
+public:
+    // Get a plan, compiling it if it isn't in the cache already. sign is
+    // -1 for a forward C2C transform and 1 for an inverse. R2C transforms
+    // are always forward and C2R transforms always inverse, so sign is
+    // ignored for them. The remaining parameters are as in Fft2dDesc.
+    static std::shared_ptr<FftPlan> get(FftType type, int N0, int N1, int sign,
+                                         bool batched,
+                                         const Halide::Target& target,
+                                         float gain = 1.0f,
+                                         int vector_width = 0,
+                                         bool parallel = false);
+
+    // Compute the transform of input into output. Calls to the same plan
+    // from different threads are serialized.
+    void execute(const Halide::Image<float> &input, Halide::Image<float> output);
+
+private:
+    FftPlan(FftType type, int N0, int N1, int sign, bool batched,
+            const Halide::Target& target, const Fft2dDesc& desc);
+
+    Halide::ImageParam input;
+    Halide::Pipeline pipeline;
+    Halide::Target target;
+    std::mutex mutex;
+};
+
 #endif
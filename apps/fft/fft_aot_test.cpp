@@ -1,7 +1,10 @@
 #include <cmath>
+#include <complex>
 #include <iostream>
 #include <iomanip>
 
+#include "benchmark.h"
+
 #include "generated/fft_forward_r2c.h"
 #include "generated/fft_inverse_c2r.h"
 #include "generated/fft_forward_c2c.h"
@@ -13,6 +16,25 @@ const float kPi = 3.14159265358979310000f;
 const size_t kSize = 16;
 }
 
+// Compute the 2D DFT of the kSize x kSize interleaved complex signal in
+// directly, as a baseline for the FFT.
+void naive_dft_forward_c2c(const float *in, float *out) {
+    for (size_t k1 = 0; k1 < kSize; k1++) {
+        for (size_t k0 = 0; k0 < kSize; k0++) {
+            std::complex<float> sum = 0;
+            for (size_t n1 = 0; n1 < kSize; n1++) {
+                for (size_t n0 = 0; n0 < kSize; n0++) {
+                    float theta = -2 * kPi * ((k0 * n0 + k1 * n1) % kSize) / kSize;
+                    std::complex<float> x(in[(n0 + n1 * kSize) * 2], in[(n0 + n1 * kSize) * 2 + 1]);
+                    sum += x * std::polar(1.0f, theta);
+                }
+            }
+            out[(k0 + k1 * kSize) * 2] = sum.real();
+            out[(k0 + k1 * kSize) * 2 + 1] = sum.imag();
+        }
+    }
+}
+
 // Make a buffer_t for real input to the FFT.
 buffer_t real_buffer(float *storage, int32_t y_size = kSize) {
     buffer_t buf = {0};
@@ -284,5 +306,30 @@ int main(int argc, char **argv) {
         }
     }
 
+    // Throughput of the compiled FFTs, compared to computing the DFT
+    // directly. MFLOP/s uses the conventional 5 N log2(N) operation count
+    // for a complex FFT of N points, and half that for a real FFT.
+    {
+        std::cout << "Throughput:" << std::endl;
+
+        const double n = kSize * kSize;
+        const double flops = 5 * n * std::log2(n);
+        const int reps = 1000;
+
+        buffer_t c_in = complex_buffer(input);
+        buffer_t c_out = complex_buffer(output);
+        buffer_t r_in = real_buffer(input);
+        buffer_t rc_out = complex_buffer(output, kSize / 2 + 1);
+
+        double c2c_t = benchmark(10, reps, [&]() { fft_forward_c2c(&c_in, &c_out); }) * 1e6;
+        double r2c_t = benchmark(10, reps, [&]() { fft_forward_r2c(&r_in, &rc_out); }) * 1e6;
+        double dft_t = benchmark(3, 10, [&]() { naive_dft_forward_c2c(input, output); }) * 1e6;
+
+        std::cout << std::setw(12) << "" << std::setw(12) << "Time (us)" << std::setw(12) << "MFLOP/s" << std::endl;
+        std::cout << std::setw(12) << "c2c" << std::setw(12) << c2c_t << std::setw(12) << flops / c2c_t << std::endl;
+        std::cout << std::setw(12) << "r2c" << std::setw(12) << r2c_t << std::setw(12) << flops / 2 / r2c_t << std::endl;
+        std::cout << std::setw(12) << "naive c2c" << std::setw(12) << dft_t << std::setw(12) << flops / dft_t << std::endl;
+    }
+
     exit(0);
 }
@@ -4,6 +4,7 @@
 // algorithms.
 
 #include "Halide.h"
+#include <complex>
 #include <cstdio>
 #include <vector>
 #include "fft.h"
@@ -35,6 +36,93 @@ double log2(double x) {
     return log(x)/log(2.0);
 }
 
+// Compute the 2D DFT of the N0 x N1 complex signal x directly, to check
+// the FFT against.
+std::vector<std::complex<double>> naive_dft2d(const std::vector<std::complex<double>> &x,
+                                              int N0, int N1, int sign) {
+    const double pi = 3.14159265358979323846;
+    std::vector<std::complex<double>> X(N0 * N1);
+    for (int k1 = 0; k1 < N1; k1++) {
+        for (int k0 = 0; k0 < N0; k0++) {
+            std::complex<double> sum = 0;
+            for (int n1 = 0; n1 < N1; n1++) {
+                for (int n0 = 0; n0 < N0; n0++) {
+                    double theta = sign * 2 * pi * ((double)k0 * n0 / N0 + (double)k1 * n1 / N1);
+                    sum += x[n0 + n1 * N0] * std::polar(1.0, theta);
+                }
+            }
+            X[k0 + k1 * N0] = sum;
+        }
+    }
+    return X;
+}
+
+// Check batched plans of a size that isn't a power of two against the
+// direct DFT. Returns false on a mismatch.
+bool test_plans(const Target &target) {
+    const int N0 = 15, N1 = 12, batch = 3;
+    const double tolerance = 1e-3;
+
+    Image<float> c_in(2, N0, N1, batch), c_out(2, N0, N1, batch);
+    Image<float> r_in(N0, N1, batch), r_out(N0, N1, batch);
+    Image<float> rc_out(2, N0, N1/2 + 1, batch);
+    for (int b = 0; b < batch; b++) {
+        for (int y = 0; y < N1; y++) {
+            for (int x = 0; x < N0; x++) {
+                c_in(0, x, y, b) = (float)rand()/(float)RAND_MAX;
+                c_in(1, x, y, b) = (float)rand()/(float)RAND_MAX;
+                r_in(x, y, b) = c_in(0, x, y, b);
+            }
+        }
+    }
+
+    FftPlan::get(FftType::C2C, N0, N1, -1, true, target)->execute(c_in, c_out);
+    FftPlan::get(FftType::R2C, N0, N1, -1, true, target)->execute(r_in, rc_out);
+    FftPlan::get(FftType::C2R, N0, N1, 1, true, target, 1.0f/(N0*N1))->execute(rc_out, r_out);
+
+    for (int b = 0; b < batch; b++) {
+        std::vector<std::complex<double>> c(N0 * N1), r(N0 * N1);
+        for (int y = 0; y < N1; y++) {
+            for (int x = 0; x < N0; x++) {
+                c[x + y * N0] = std::complex<double>(c_in(0, x, y, b), c_in(1, x, y, b));
+                r[x + y * N0] = r_in(x, y, b);
+            }
+        }
+        std::vector<std::complex<double>> C = naive_dft2d(c, N0, N1, -1);
+        std::vector<std::complex<double>> R = naive_dft2d(r, N0, N1, -1);
+
+        for (int y = 0; y < N1; y++) {
+            for (int x = 0; x < N0; x++) {
+                std::complex<double> c2c(c_out(0, x, y, b), c_out(1, x, y, b));
+                if (std::abs(c2c - C[x + y * N0]) > tolerance) {
+                    printf("Batched c2c plan mismatch at (%d, %d, %d)\n", x, y, b);
+                    return false;
+                }
+                if (y <= N1/2) {
+                    std::complex<double> r2c(rc_out(0, x, y, b), rc_out(1, x, y, b));
+                    if (std::abs(r2c - R[x + y * N0]) > tolerance) {
+                        printf("Batched r2c plan mismatch at (%d, %d, %d)\n", x, y, b);
+                        return false;
+                    }
+                }
+                if (std::abs(r_out(x, y, b) - r_in(x, y, b)) > tolerance) {
+                    printf("Batched c2r plan did not invert r2c at (%d, %d, %d)\n", x, y, b);
+                    return false;
+                }
+            }
+        }
+    }
+
+    // Getting the same plan again should find it in the cache.
+    if (FftPlan::get(FftType::C2C, N0, N1, -1, true, target) !=
+        FftPlan::get(FftType::C2C, N0, N1, -1, true, target)) {
+        printf("FFT plan was not cached\n");
+        return false;
+    }
+
+    return true;
+}
+
 int main(int argc, char **argv) {
     int W = 32;
     int H = 32;
@@ -127,6 +215,10 @@ int main(int argc, char **argv) {
         }
     }
 
+    if (!test_plans(target)) {
+        return -1;
+    }
+
     // For a description of the methodology used here, see
     // http://www.fftw.org/speed/method.html
 
@@ -227,6 +319,28 @@ int main(int argc, char **argv) {
            2.5*W*H*(log2(W) + log2(H))/fftw_t,
            fftw_t / halide_t);
 
+    // Compare building and compiling an FFT for each transform with
+    // reusing a cached plan.
+    {
+        Image<float> plan_in(2, W, H), plan_out(2, W, H);
+        for (int y = 0; y < H; y++) {
+            for (int x = 0; x < W; x++) {
+                plan_in(0, x, y) = in(x, y);
+                plan_in(1, x, y) = 0.0f;
+            }
+        }
+
+        double rebuild_t = benchmark(1, 3, [&]() {
+            fft2d_c2c(make_complex(in), W, H, -1, target, fwd_desc).realize(W, H, target);
+        })*1e6;
+        double plan_t = benchmark(samples, reps, [&]() {
+            FftPlan::get(FftType::C2C, W, H, -1, false, target)->execute(plan_in, plan_out);
+        })*1e6;
+
+        printf("\n%12s %10s %10s\n", "", "Rebuilt", "Plan");
+        printf("%12s %10.3f %10.3f\n", "c2c (us)", rebuild_t, plan_t);
+    }
+
 #ifdef WITH_FFTW
     fftwf_destroy_plan(c2c_plan);
     fftwf_destroy_plan(r2c_plan);
@@ -2,7 +2,8 @@
 //
 // Benchmarks BLAS subroutines using Halide's implementation. Will
 // construct random size x size matrices and/or size x 1 vectors
-// to test the subroutine with.
+// to test the subroutine with. For L3 subroutines, size may also be
+// given as MxNxK to multiply an M x K matrix by a K x N matrix.
 //
 // Accepted values for subroutine are:
 //    L1: scal, copy, axpy, dot, nrm2
@@ -57,8 +58,12 @@ struct BenchmarksBase {
     }
 
     Matrix random_matrix(int N) {
-        Matrix buff(N * N);
-        for (int i=0; i<N*N; ++i) {
+        return random_matrix(N, N);
+    }
+
+    Matrix random_matrix(int M, int N) {
+        Matrix buff(M * N);
+        for (int i=0; i<M*N; ++i) {
             buff[i] = random_scalar();
         }
         return buff;
@@ -66,31 +71,31 @@ struct BenchmarksBase {
 
     BenchmarksBase(std::string n) : name(n) {}
 
-    void run(std::string benchmark, int size) {
+    void run(std::string benchmark, int M, int N, int K) {
         if (benchmark == "copy") {
-            bench_copy(size);
+            bench_copy(M);
         } else if (benchmark == "scal") {
-            bench_scal(size);
+            bench_scal(M);
         } else if (benchmark == "axpy") {
-            bench_axpy(size);
+            bench_axpy(M);
         } else if (benchmark == "dot") {
-            bench_dot(size);
+            bench_dot(M);
         } else if (benchmark == "asum") {
-            bench_asum(size);
+            bench_asum(M);
         } else if (benchmark == "gemv_notrans") {
-            this->bench_gemv_notrans(size);
+            this->bench_gemv_notrans(M);
         } else if (benchmark == "gemv_trans") {
-            this->bench_gemv_trans(size);
+            this->bench_gemv_trans(M);
         } else if (benchmark == "ger") {
-            this->bench_ger(size);
+            this->bench_ger(M);
         } else if (benchmark == "gemm_notrans") {
-            this->bench_gemm_notrans(size);
+            this->bench_gemm_notrans(M, N, K);
         } else if (benchmark == "gemm_transA") {
-            this->bench_gemm_transA(size);
+            this->bench_gemm_transA(M, N, K);
         } else if (benchmark == "gemm_transB") {
-            this->bench_gemm_transB(size);
+            this->bench_gemm_transB(M, N, K);
         } else if (benchmark == "gemm_transAB") {
-            this->bench_gemm_transAB(size);
+            this->bench_gemm_transAB(M, N, K);
         }
     }
 
@@ -102,10 +107,10 @@ struct BenchmarksBase {
     virtual void bench_gemv_notrans(int N) =0;
     virtual void bench_gemv_trans(int N) =0;
     virtual void bench_ger(int N) =0;
-    virtual void bench_gemm_notrans(int N) =0;
-    virtual void bench_gemm_transA(int N) =0;
-    virtual void bench_gemm_transB(int N) =0;
-    virtual void bench_gemm_transAB(int N) =0;
+    virtual void bench_gemm_notrans(int M, int N, int K) =0;
+    virtual void bench_gemm_transA(int M, int N, int K) =0;
+    virtual void bench_gemm_transB(int M, int N, int K) =0;
+    virtual void bench_gemm_transAB(int M, int N, int K) =0;
 };
 
 struct BenchmarksFloat : public BenchmarksBase<float> {
@@ -132,21 +137,21 @@ struct BenchmarksFloat : public BenchmarksBase<float> {
     L2Benchmark(ger, "s", cblas_sger(CblasColMajor, N, N, alpha, &(x[0]), 1,
                                      &(y[0]), 1, &(A[0]), N))
 
-    L3Benchmark(gemm_notrans, "s", cblas_sgemm(CblasColMajor, CblasNoTrans, CblasNoTrans, N, N, N,
-                                               alpha, &(A[0]), N, &(B[0]), N,
-                                               beta, &(C[0]), N))
+    L3Benchmark(gemm_notrans, "s", cblas_sgemm(CblasColMajor, CblasNoTrans, CblasNoTrans, M, N, K,
+                                               alpha, &(A[0]), lda, &(B[0]), ldb,
+                                               beta, &(C[0]), ldc))
 
-    L3Benchmark(gemm_transA, "s", cblas_sgemm(CblasColMajor, CblasTrans, CblasNoTrans, N, N, N,
-                                              alpha, &(A[0]), N, &(B[0]), N,
-                                              beta, &(C[0]), N))
+    L3Benchmark(gemm_transA, "s", cblas_sgemm(CblasColMajor, CblasTrans, CblasNoTrans, M, N, K,
+                                              alpha, &(A[0]), lda, &(B[0]), ldb,
+                                              beta, &(C[0]), ldc))
 
-    L3Benchmark(gemm_transB, "s", cblas_sgemm(CblasColMajor, CblasNoTrans, CblasTrans, N, N, N,
-                                              alpha, &(A[0]), N, &(B[0]), N,
-                                              beta, &(C[0]), N))
+    L3Benchmark(gemm_transB, "s", cblas_sgemm(CblasColMajor, CblasNoTrans, CblasTrans, M, N, K,
+                                              alpha, &(A[0]), lda, &(B[0]), ldb,
+                                              beta, &(C[0]), ldc))
 
-    L3Benchmark(gemm_transAB, "s", cblas_sgemm(CblasColMajor, CblasTrans, CblasTrans, N, N, N,
-                                               alpha, &(A[0]), N, &(B[0]), N,
-                                               beta, &(C[0]), N))
+    L3Benchmark(gemm_transAB, "s", cblas_sgemm(CblasColMajor, CblasTrans, CblasTrans, M, N, K,
+                                               alpha, &(A[0]), lda, &(B[0]), ldb,
+                                               beta, &(C[0]), ldc))
 };
 
 struct BenchmarksDouble : public BenchmarksBase<double> {
@@ -173,21 +178,21 @@ struct BenchmarksDouble : public BenchmarksBase<double> {
     L2Benchmark(ger, "d", cblas_dger(CblasColMajor, N, N, alpha, &(x[0]), 1,
                                      &(y[0]), 1, &(A[0]), N))
 
-    L3Benchmark(gemm_notrans, "d", cblas_dgemm(CblasColMajor, CblasNoTrans, CblasNoTrans, N, N, N,
-                                               alpha, &(A[0]), N, &(B[0]), N,
-                                               beta, &(C[0]), N))
+    L3Benchmark(gemm_notrans, "d", cblas_dgemm(CblasColMajor, CblasNoTrans, CblasNoTrans, M, N, K,
+                                               alpha, &(A[0]), lda, &(B[0]), ldb,
+                                               beta, &(C[0]), ldc))
 
-    L3Benchmark(gemm_transA, "d", cblas_dgemm(CblasColMajor, CblasTrans, CblasNoTrans, N, N, N,
-                                              alpha, &(A[0]), N, &(B[0]), N,
-                                              beta, &(C[0]), N))
+    L3Benchmark(gemm_transA, "d", cblas_dgemm(CblasColMajor, CblasTrans, CblasNoTrans, M, N, K,
+                                              alpha, &(A[0]), lda, &(B[0]), ldb,
+                                              beta, &(C[0]), ldc))
 
-    L3Benchmark(gemm_transB, "d", cblas_dgemm(CblasColMajor, CblasNoTrans, CblasTrans, N, N, N,
-                                              alpha, &(A[0]), N, &(B[0]), N,
-                                              beta, &(C[0]), N))
+    L3Benchmark(gemm_transB, "d", cblas_dgemm(CblasColMajor, CblasNoTrans, CblasTrans, M, N, K,
+                                              alpha, &(A[0]), lda, &(B[0]), ldb,
+                                              beta, &(C[0]), ldc))
 
-    L3Benchmark(gemm_transAB, "d", cblas_dgemm(CblasColMajor, CblasTrans, CblasTrans, N, N, N,
-                                               alpha, &(A[0]), N, &(B[0]), N,
-                                               beta, &(C[0]), N))
+    L3Benchmark(gemm_transAB, "d", cblas_dgemm(CblasColMajor, CblasTrans, CblasTrans, M, N, K,
+                                               alpha, &(A[0]), lda, &(B[0]), ldb,
+                                               beta, &(C[0]), ldc))
 };
 
 int main(int argc, char* argv[]) {
@@ -198,13 +203,24 @@ int main(int argc, char* argv[]) {
 
     std::string subroutine = argv[1];
     char type = subroutine[0];
-    int  size = std::stoi(argv[2]);
+
+    // Square matrices are given by a single size, and other shapes
+    // by MxNxK.
+    std::string size = argv[2];
+    int M = std::stoi(size), N = M, K = M;
+    size_t x = size.find('x');
+    if (x != std::string::npos) {
+        size = size.substr(x + 1);
+        N = std::stoi(size);
+        x = size.find('x');
+        K = (x != std::string::npos) ? std::stoi(size.substr(x + 1)) : N;
+    }
 
     subroutine = subroutine.substr(1);
     if (type == 's') {
-        BenchmarksFloat (BLAS_NAME).run(subroutine, size);
+        BenchmarksFloat (BLAS_NAME).run(subroutine, M, N, K);
     } else if (type == 'd') {
-        BenchmarksDouble(BLAS_NAME).run(subroutine, size);
+        BenchmarksDouble(BLAS_NAME).run(subroutine, M, N, K);
     }
 
     return 0;
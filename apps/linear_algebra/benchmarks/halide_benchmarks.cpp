@@ -2,7 +2,8 @@
 //
 // Benchmarks BLAS subroutines using Halide's implementation. Will
 // construct random size x size matrices and/or size x 1 vectors
-// to test the subroutine with.
+// to test the subroutine with. For L3 subroutines, size may also be
+// given as MxNxK to multiply an M x K matrix by a K x N matrix.
 //
 // Accepted values for subroutine are:
 //    L1: scal, copy, axpy, dot, nrm2
@@ -46,9 +47,13 @@ struct BenchmarksBase {
     }
 
     Matrix random_matrix(int N) {
-        Matrix buff(Halide::type_of<T>(), N, N);
+        return random_matrix(N, N);
+    }
+
+    Matrix random_matrix(int M, int N) {
+        Matrix buff(Halide::type_of<T>(), M, N);
         Scalar *A = (Scalar*)buff.host_ptr();
-        for (int i=0; i<N*N; ++i) {
+        for (int i=0; i<M*N; ++i) {
             A[i] = random_scalar();
         }
         return buff;
@@ -56,31 +61,31 @@ struct BenchmarksBase {
 
     BenchmarksBase(std::string n) : name(n) {}
 
-    void run(std::string benchmark, int size) {
+    void run(std::string benchmark, int M, int N, int K) {
         if (benchmark == "copy") {
-            bench_copy(size);
+            bench_copy(M);
         } else if (benchmark == "scal") {
-            bench_scal(size);
+            bench_scal(M);
         } else if (benchmark == "axpy") {
-            bench_axpy(size);
+            bench_axpy(M);
         } else if (benchmark == "dot") {
-            bench_dot(size);
+            bench_dot(M);
         } else if (benchmark == "asum") {
-            bench_asum(size);
+            bench_asum(M);
         } else if (benchmark == "gemv_notrans") {
-            bench_gemv_notrans(size);
+            bench_gemv_notrans(M);
         } else if (benchmark == "gemv_trans") {
-            bench_gemv_trans(size);
+            bench_gemv_trans(M);
         } else if (benchmark == "ger") {
-            bench_ger(size);
+            bench_ger(M);
         } else if (benchmark == "gemm_notrans") {
-            bench_gemm_notrans(size);
+            bench_gemm_notrans(M, N, K);
         } else if (benchmark == "gemm_transA") {
-            bench_gemm_transA(size);
+            bench_gemm_transA(M, N, K);
         } else if (benchmark == "gemm_transB") {
-            bench_gemm_transB(size);
+            bench_gemm_transB(M, N, K);
         } else if (benchmark == "gemm_transAB") {
-            bench_gemm_transAB(size);
+            bench_gemm_transAB(M, N, K);
         }
     }
 
@@ -92,10 +97,10 @@ struct BenchmarksBase {
     virtual void bench_gemv_notrans(int N) =0;
     virtual void bench_gemv_trans(int N) =0;
     virtual void bench_ger(int N) =0;
-    virtual void bench_gemm_notrans(int N) =0;
-    virtual void bench_gemm_transA(int N) =0;
-    virtual void bench_gemm_transB(int N) =0;
-    virtual void bench_gemm_transAB(int N) =0;
+    virtual void bench_gemm_notrans(int M, int N, int K) =0;
+    virtual void bench_gemm_transA(int M, int N, int K) =0;
+    virtual void bench_gemm_transB(int M, int N, int K) =0;
+    virtual void bench_gemm_transAB(int M, int N, int K) =0;
 };
 
 struct BenchmarksFloat : public BenchmarksBase<float> {
@@ -176,13 +181,24 @@ int main(int argc, char* argv[]) {
 
     std::string subroutine = argv[1];
     char type = subroutine[0];
-    int  size = std::stoi(argv[2]);
+
+    // Square matrices are given by a single size, and other shapes
+    // by MxNxK.
+    std::string size = argv[2];
+    int M = std::stoi(size), N = M, K = M;
+    size_t x = size.find('x');
+    if (x != std::string::npos) {
+        size = size.substr(x + 1);
+        N = std::stoi(size);
+        x = size.find('x');
+        K = (x != std::string::npos) ? std::stoi(size.substr(x + 1)) : N;
+    }
 
     subroutine = subroutine.substr(1);
     if (type == 's') {
-        BenchmarksFloat ("Halide").run(subroutine, size);
+        BenchmarksFloat ("Halide").run(subroutine, M, N, K);
     } else if (type == 'd') {
-        BenchmarksDouble("Halide").run(subroutine, size);
+        BenchmarksDouble("Halide").run(subroutine, M, N, K);
     }
 
     return 0;
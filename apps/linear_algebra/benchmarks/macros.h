@@ -50,21 +50,38 @@
                   << std::endl;                                         \
     }
 
-#define L3GFLOPS(N) (3.0 + N) * N * N * 1e-3 / elapsed
+// The benchmark name says which of A and B are transposed. Leading
+// dimensions are given for libraries that want them.
+#define L3GFLOPS(M, N, K) (3.0 + K) * M * N * 1e-3 / elapsed
 #define L3Benchmark(benchmark, type, code)                              \
-    virtual void bench_##benchmark(int N) {                             \
+    virtual void bench_##benchmark(int M, int N, int K) {               \
+        const std::string op(#benchmark);                               \
+        const bool tA = op.find("transA") != std::string::npos;         \
+        const bool tB = (op.find("transB") != std::string::npos ||      \
+                         op.find("transAB") != std::string::npos);      \
+        const int lda = tA ? K : M;                                     \
+        const int ldb = tB ? N : K;                                     \
+        const int ldc = M;                                              \
+        (void) lda;                                                     \
+        (void) ldb;                                                     \
+        (void) ldc;                                                     \
         Scalar alpha = random_scalar();                                 \
         Scalar beta = random_scalar();                                  \
-        Matrix A(random_matrix(N));                                     \
-        Matrix B(random_matrix(N));                                     \
-        Matrix C(random_matrix(N));                                     \
+        Matrix A(tA ? random_matrix(K, M) : random_matrix(M, K));       \
+        Matrix B(tB ? random_matrix(N, K) : random_matrix(K, N));       \
+        Matrix C(random_matrix(M, N));                                  \
                                                                         \
         time_it(code)                                                   \
                                                                         \
+        std::string size = std::to_string(M);                           \
+        if (M != N || N != K) {                                         \
+            size += "x" + std::to_string(N) + "x" + std::to_string(K);  \
+        }                                                               \
+                                                                        \
         std::cout << std::setw(8) << name                               \
                   << std::setw(15) << type << #benchmark                \
-                  << std::setw(8) << std::to_string(N)                  \
+                  << " " << std::setw(7) << size                       \
                   << std::setw(20) << std::to_string(elapsed)           \
-                  << std::setw(20) << L3GFLOPS(N)                       \
+                  << std::setw(20) << L3GFLOPS(M, N, K)                 \
                   << std::endl;                                         \
     }
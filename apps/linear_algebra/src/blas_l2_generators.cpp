@@ -236,10 +236,102 @@ class GERGenerator :
     }
 };
 
+// Generator class for batches of small gemv operations. The matrices
+// and vectors are stacked along their last dimension, and the whole
+// batch is done in one call.
+template<class T>
+class BatchedGEMVGenerator :
+        public Generator<BatchedGEMVGenerator<T>> {
+  public:
+    typedef Generator<BatchedGEMVGenerator<T>> Base;
+    using Base::target;
+    using Base::get_target;
+    using Base::natural_vector_size;
+
+    GeneratorParam<bool> assertions_enabled_ = {"assertions_enabled", false};
+    GeneratorParam<bool> transpose_ = {"transpose", false};
+    GeneratorParam<int>  matrices_per_task_ = {"matrices_per_task", 16};
+
+    // Standard ordering of parameters in GEMV functions.
+    Param<T>   a_ = {"a", 1.0};
+    ImageParam A_ = {type_of<T>(), 3, "A"};
+    ImageParam x_ = {type_of<T>(), 2, "x"};
+    Param<T>   b_ = {"b", 1.0};
+    ImageParam y_ = {type_of<T>(), 2, "y"};
+
+    void SetupTarget() {
+        if (!assertions_enabled_) {
+            target.set(get_target()
+                       .with_feature(Target::NoAsserts)
+                       .with_feature(Target::NoBoundsQuery));
+        }
+    }
+
+    Func build() {
+        SetupTarget();
+
+        const Expr size = transpose_ ? A_.height() : A_.width();
+        const Expr sum_size = transpose_ ? A_.width() : A_.height();
+        const Expr batch_size = A_.channels();
+
+        const int vec_size = natural_vector_size(type_of<T>());
+        const int matrices_per_task = ((matrices_per_task_ + vec_size - 1) / vec_size) * vec_size;
+
+        Var i("i"), k("k"), n("n"), nv("nv"), t("t");
+
+        Func A("A");
+        if (transpose_) {
+            A(i, k, n) = A_(k, i, n);
+        } else {
+            A(i, k, n) = A_(i, k, n);
+        }
+
+        Func Ax("Ax");
+        RDom rk(0, sum_size, "rk");
+        Ax(i, n) += A(i, rk, n) * x_(rk, n);
+
+        Func result("result");
+        result(i, n) = b_ * y_(i, n) + a_ * Ax(i, n);
+
+        // Vectorize along the result if it's long enough, and give
+        // each task several matrices to amortize the cost of
+        // dispatching it.
+        result.specialize(size >= vec_size)
+                .vectorize(i, vec_size)
+                .specialize(batch_size >= matrices_per_task)
+                .split(n, t, n, matrices_per_task).parallel(t);
+
+        // Otherwise vectorize across the matrices instead.
+        result.specialize(batch_size >= matrices_per_task)
+                .split(n, t, n, matrices_per_task).parallel(t)
+                .split(n, n, nv, vec_size).reorder(nv, i, n).vectorize(nv);
+
+        Ax.compute_at(result, n);
+        Ax.specialize(size >= vec_size).vectorize(i, vec_size);
+        Ax.update().specialize(size >= vec_size)
+                .reorder(i, rk, n).vectorize(i, vec_size);
+        Ax.specialize(batch_size >= matrices_per_task)
+                .reorder(n, i).vectorize(n, vec_size);
+        Ax.update().specialize(batch_size >= matrices_per_task)
+                .reorder(n, i, rk).vectorize(n, vec_size);
+
+        A_.set_min(0, 0).set_min(1, 0).set_min(2, 0);
+        x_.set_bounds(0, 0, sum_size).set_bounds(1, 0, batch_size);
+        y_.set_bounds(0, 0, size).set_bounds(1, 0, batch_size);
+        result.output_buffer()
+                .set_bounds(0, 0, size)
+                .set_bounds(1, 0, batch_size);
+
+        return result;
+    }
+};
+
 
 RegisterGenerator<GEMVGenerator<float>>   register_sgemv("sgemv");
 RegisterGenerator<GEMVGenerator<double>>  register_dgemv("dgemv");
 RegisterGenerator<GERGenerator<float>>    register_sger("sger");
 RegisterGenerator<GERGenerator<double>>   register_dger("dger");
+RegisterGenerator<BatchedGEMVGenerator<float>>   register_sgemv_batched("sgemv_batched");
+RegisterGenerator<BatchedGEMVGenerator<double>>  register_dgemv_batched("dgemv_batched");
 
 }  // namespace
@@ -29,12 +29,29 @@ class GEMMGenerator :
         // Matrices are interpreted as column-major by default. The
         // transpose GeneratorParams are used to handle cases where
         // one or both is actually row major.
-        const Expr num_rows = A_.width();
-        const Expr num_cols = B_.height();
-        const Expr sum_size = A_.height();
-
+        const bool transpose_A = (bool)transpose_A_;
+        const bool transpose_B = (bool)transpose_B_;
+        const Expr num_rows = C_.width();
+        const Expr num_cols = C_.height();
+        const Expr sum_size = transpose_A ? A_.width() : A_.height();
+
+        // The micro-kernel computes an mr x nr tile of the result,
+        // held in 2 * nr vector registers.
         const int vec = natural_vector_size(a_.type());
-        const int s = vec * 2;
+        const int mr = vec * 2;
+        const int nr = 4;
+
+        // Each parallel task computes an mc x nc block of the result,
+        // one kc deep slice of the sum at a time. For each slice the
+        // task packs the kc x mc block of A it needs into mr-wide
+        // panels, and the kc x nc block of B into nr-wide panels, so
+        // that the micro-kernel reads both contiguously. An A panel
+        // and a B panel fit in L1 together, and the packed block of
+        // A stays in L2 while it is used against each panel of B.
+        const int mc = mr * 8;
+        const int nc = nr * 32;
+        const Expr num_slices = (sum_size + 255) / 256;
+        const Expr kc = (sum_size + num_slices - 1) / num_slices;
 
         ImageParam A_in, B_in;
 
@@ -51,38 +68,44 @@ class GEMMGenerator :
             B_in = B_;
         }
 
-        Var i, j, ii, ji, jii, iii, io, jo, t;
-        Var ti[3], tj[3];
+        Var i, j, k, ii, ji, io, jo, it, jt, ko, t;
         Func result("result");
 
-        // Swizzle A for better memory order in the inner loop.
-        Func A("A"), B("B"), Btmp("Btmp"), As("As"), Atmp("Atmp");
-        Atmp(i, j) = BoundaryConditions::constant_exterior(A_in, cast<T>(0))(i, j);
+        // Pad with zeros, so that panels and slices may run off the
+        // edges of the matrices without changing the result.
+        Func Apad = BoundaryConditions::constant_exterior(A_in, cast<T>(0));
+        Func Bpad = BoundaryConditions::constant_exterior(B_in, cast<T>(0));
 
+        Func A("A"), B("B");
         if (transpose_A_) {
-            As(i, j, io) = Atmp(j, io*s + i);
+            A(i, k) = Apad(k, i);
         } else {
-            As(i, j, io) = Atmp(io*s + i, j);
+            A(i, k) = Apad(i, k);
         }
-
-        A(i, j) = As(i % s, j, i / s);
-
-        Btmp(i, j) = B_in(i, j);
         if (transpose_B_) {
-            B(i, j) = Btmp(j, i);
+            B(k, j) = Bpad(j, k);
         } else {
-            B(i, j) = Btmp(i, j);
+            B(k, j) = Bpad(k, j);
         }
 
-        Var k("k");
-        Func prod;
-        // Express all the products we need to do a matrix multiply as a 3D Func.
-        prod(k, i, j) = A(i, k) * B(k, j);
-
-        // Reduce the products along k.
+        // Panel io of A holds rows [io*mr, io*mr + mr), and panel jo of
+        // B holds columns [jo*nr, jo*nr + nr). Both are stored so that
+        // the elements used by one step of the micro-kernel are
+        // adjacent.
+        Func A_packed("A_packed"), B_packed("B_packed");
+        A_packed(ii, k, io) = A(io*mr + ii, k);
+        B_packed(ji, k, jo) = B(k, jo*nr + ji);
+
+        // The product over one slice of the sum.
+        Func part("part");
+        RDom rk(0, kc);
+        part(i, j, ko) += (A_packed(i % mr, ko*kc + rk, i / mr) *
+                           B_packed(j % nr, ko*kc + rk, j / nr));
+
+        // Reduce the slices.
         Func AB("AB");
-        RDom rv(0, sum_size);
-        AB(i, j) += prod(rv, i, j);
+        RDom rko(0, num_slices);
+        AB(i, j) += part(i, j, rko);
 
         Func ABt("ABt");
         if (transpose_AB) {
@@ -95,66 +118,136 @@ class GEMMGenerator :
         // Do the part that makes it a 'general' matrix multiply.
         result(i, j) = (a_ * ABt(i, j) + b_ * C_(i, j));
 
-        result.tile(i, j, ti[1], tj[1], i, j, 2*s, 2*s, TailStrategy::GuardWithIf);
-        if (transpose_AB) {
-            result
-                .tile(i, j, ii, ji, 4, s)
-                .tile(i, j, ti[0], tj[0], i, j, s/4, 1);
+        result
+            .tile(i, j, io, jo, i, j, mc, nc, TailStrategy::GuardWithIf)
+            .fuse(io, jo, t).parallel(t);
+
+        AB.compute_at(result, t)
+            .vectorize(i, vec);
+        AB.update()
+            .tile(i, j, it, jt, ii, ji, mr, nr)
+            .reorder(ii, ji, it, jt, rko)
+            .vectorize(ii, vec).unroll(ii).unroll(ji);
+
+        // Pack once per slice of each block.
+        A_packed.compute_at(AB, rko)
+            .vectorize(ii, vec).unroll(ii);
+        B_packed.compute_at(AB, rko)
+            .vectorize(k, vec).unroll(ji);
+
+        // The micro-kernel. The accumulators live in registers across
+        // the whole slice.
+        part.compute_at(AB, it)
+            .vectorize(i, vec).unroll(i).unroll(j)
+            .update()
+            .reorder(i, j, rk)
+            .vectorize(i, vec).unroll(i).unroll(j);
 
-        } else {
-            result
-                .tile(i, j, ii, ji, s, 4)
-                .tile(i, j, ti[0], tj[0], i, j, 1, s/4);
-        }
+        A_.set_min(0, 0).set_min(1, 0);
+        B_.set_bounds(transpose_B ? 1 : 0, 0, sum_size).set_min(transpose_B ? 0 : 1, 0);
+        C_.set_bounds(0, 0, num_rows).set_bounds(1, 0, num_cols);
+        result.output_buffer().set_bounds(0, 0, num_rows).set_bounds(1, 0, num_cols);
+
+        return result;
+    }
+};
+
+// Generator class for batches of small gemm operations. The matrices
+// are stacked along a third dimension, and the whole batch is done in
+// one call.
+template<class T>
+class BatchedGEMMGenerator :
+        public Generator<BatchedGEMMGenerator<T>> {
+  public:
+    typedef Generator<BatchedGEMMGenerator<T>> Base;
+    using Base::target;
+    using Base::get_target;
+    using Base::natural_vector_size;
+
+    GeneratorParam<bool> assertions_enabled_ = {"assertions_enabled", false};
+    GeneratorParam<bool> transpose_A_ = {"transpose_A", false};
+    GeneratorParam<bool> transpose_B_ = {"transpose_B", false};
+    GeneratorParam<int>  matrices_per_task_ = {"matrices_per_task", 16};
 
-        // If we have enough work per task, parallelize over these tiles.
-        result.specialize(num_rows >= 512 && num_cols >= 512)
-            .fuse(tj[1], ti[1], t).parallel(t);
+    // Standard ordering of parameters in GEMM functions.
+    Param<T>   a_ = {"a", 1.0};
+    ImageParam A_ = {type_of<T>(), 3, "A"};
+    ImageParam B_ = {type_of<T>(), 3, "B"};
+    Param<T>   b_ = {"b", 1.0};
+    ImageParam C_ = {type_of<T>(), 3, "C"};
 
-        // Otherwise tile one more time before parallelizing, or don't
-        // parallelize at all.
-        result.specialize(num_rows >= 128 && num_cols >= 128)
-            .tile(ti[1], tj[1], ti[2], tj[2], ti[1], tj[1], 2, 2)
-            .fuse(tj[2], ti[2], t).parallel(t);
+    void SetupTarget() {
+        if (!assertions_enabled_) {
+            target.set(get_target()
+                       .with_feature(Target::NoAsserts)
+                       .with_feature(Target::NoBoundsQuery));
+        }
+    }
 
-        result.rename(tj[0], t);
+    Func build() {
+        SetupTarget();
 
-        result.bound(i, 0, num_rows).bound(j, 0, num_cols);
+        const Expr num_rows = C_.width();
+        const Expr num_cols = C_.height();
+        const Expr batch_size = C_.channels();
+        const Expr sum_size = transpose_A_ ? A_.width() : A_.height();
 
-        As.compute_root()
-            .split(j, jo, ji, s).reorder(i, ji, io, jo)
-            .unroll(i).vectorize(ji)
-            .specialize(A_.width() >= 256 && A_.height() >= 256).parallel(jo, 4);
+        const int vec = natural_vector_size(a_.type());
+        const int matrices_per_task = ((matrices_per_task_ + vec - 1) / vec) * vec;
 
-        Atmp.compute_at(As, io)
-            .vectorize(i).unroll(j);
+        Var i("i"), j("j"), k("k"), n("n"), nv("nv"), t("t");
 
+        Func A("A"), B("B");
+        if (transpose_A_) {
+            A(i, k, n) = A_(k, i, n);
+        } else {
+            A(i, k, n) = A_(i, k, n);
+        }
         if (transpose_B_) {
-            B.compute_at(result, t)
-                .tile(i, j, ii, ji, 8, 8)
-                .vectorize(ii).unroll(ji);
-            Btmp.reorder_storage(j, i)
-                .compute_at(B, i)
-                .vectorize(i)
-                .unroll(j);
+            B(k, j, n) = B_(j, k, n);
+        } else {
+            B(k, j, n) = B_(k, j, n);
         }
 
+        Func AB("AB");
+        RDom rk(0, sum_size, "rk");
+        AB(i, j, n) += A(i, rk, n) * B(rk, j, n);
 
-        AB.compute_at(result, i)
-            .bound_extent(j, 4).unroll(j)
-            .bound_extent(i, s).vectorize(i)
-            .update()
-            .reorder(i, j, rv).unroll(j).unroll(rv, 2).vectorize(i);
-        if (transpose_AB) {
-            ABt.compute_at(result, i)
-                .bound_extent(i, 4).unroll(i)
-                .bound_extent(j, s).vectorize(j);
-        }
-
-        A_.set_min(0, 0).set_min(1, 0);
-        B_.set_bounds(0, 0, sum_size).set_min(1, 0);
-        C_.set_bounds(0, 0, num_rows).set_bounds(1, 0, num_cols);
-        result.output_buffer().set_bounds(0, 0, num_rows).set_bounds(1, 0, num_cols);
+        Func result("result");
+        result(i, j, n) = a_ * AB(i, j, n) + b_ * C_(i, j, n);
+
+        // Vectorize down the columns if they're long enough, and give
+        // each task several matrices to amortize the cost of
+        // dispatching it.
+        result.specialize(num_rows >= vec)
+            .vectorize(i, vec)
+            .specialize(batch_size >= matrices_per_task)
+            .split(n, t, n, matrices_per_task).parallel(t);
+
+        // Otherwise vectorize across the matrices instead.
+        result.specialize(batch_size >= matrices_per_task)
+            .split(n, t, n, matrices_per_task).parallel(t)
+            .split(n, n, nv, vec).reorder(nv, i, j, n).vectorize(nv);
+
+        // The products for one matrix, or for one vector of matrices,
+        // fit in L1.
+        AB.compute_at(result, n);
+        AB.specialize(num_rows >= vec).vectorize(i, vec);
+        AB.update().specialize(num_rows >= vec)
+            .reorder(i, rk, j, n).vectorize(i, vec);
+        AB.specialize(batch_size >= matrices_per_task)
+            .reorder(n, i, j).vectorize(n, vec);
+        AB.update().specialize(batch_size >= matrices_per_task)
+            .reorder(n, i, rk, j).vectorize(n, vec);
+
+        A_.set_min(0, 0).set_min(1, 0).set_bounds(2, 0, batch_size);
+        B_.set_bounds(transpose_B_ ? 1 : 0, 0, sum_size)
+            .set_min(transpose_B_ ? 0 : 1, 0).set_bounds(2, 0, batch_size);
+        C_.set_bounds(0, 0, num_rows).set_bounds(1, 0, num_cols).set_min(2, 0);
+        result.output_buffer()
+            .set_bounds(0, 0, num_rows)
+            .set_bounds(1, 0, num_cols)
+            .set_bounds(2, 0, batch_size);
 
         return result;
     }
@@ -162,5 +255,7 @@ class GEMMGenerator :
 
 RegisterGenerator<GEMMGenerator<float>>    register_sgemm("sgemm");
 RegisterGenerator<GEMMGenerator<double>>   register_dgemm("dgemm");
+RegisterGenerator<BatchedGEMMGenerator<float>>    register_sgemm_batched("sgemm_batched");
+RegisterGenerator<BatchedGEMMGenerator<double>>   register_dgemm_batched("dgemm_batched");
 
 }  // namespace
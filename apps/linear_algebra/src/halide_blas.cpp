@@ -1,3 +1,4 @@
+#include <stdint.h>
 #include <string.h>
 #include <iostream>
 #include "halide_blas.h"
@@ -61,6 +62,81 @@ void init_matrix_buffer(const int M, const int N, const double *A, const int lda
     buff->elem_size = sizeof(double);
 }
 
+void init_batched_vector_buffer(const int N, const int count, const float *x, const int incx,
+                                const int stride, buffer_t *buff) {
+    init_vector_buffer(N, x, incx, buff);
+    buff->extent[1] = count;
+    buff->stride[1] = stride;
+}
+
+void init_batched_vector_buffer(const int N, const int count, const double *x, const int incx,
+                                const int stride, buffer_t *buff) {
+    init_vector_buffer(N, x, incx, buff);
+    buff->extent[1] = count;
+    buff->stride[1] = stride;
+}
+
+void init_batched_matrix_buffer(const int M, const int N, const int count, const float *A,
+                                const int lda, const int stride, buffer_t *buff) {
+    init_matrix_buffer(M, N, A, lda, buff);
+    buff->extent[2] = count;
+    buff->stride[2] = stride;
+}
+
+void init_batched_matrix_buffer(const int M, const int N, const int count, const double *A,
+                                const int lda, const int stride, buffer_t *buff) {
+    init_matrix_buffer(M, N, A, lda, buff);
+    buff->extent[2] = count;
+    buff->stride[2] = stride;
+}
+
+// Get the spacing in elements of p[first] and p[first + 1]. Returns
+// false if it isn't a whole number of elements that fits in a
+// buffer_t stride.
+template<typename T>
+bool pointer_stride(const T *const *p, const int first, int *stride) {
+    intptr_t bytes = (intptr_t)p[first + 1] - (intptr_t)p[first];
+    intptr_t elems = bytes / (intptr_t)sizeof(T);
+    *stride = (int)elems;
+    return bytes % (intptr_t)sizeof(T) == 0 && elems == (intptr_t)*stride;
+}
+
+// Returns whether p[first + count] continues the spacing of p[first]
+// and p[first + 1].
+template<typename T>
+bool continues_run(const T *const *p, const int first, const int count) {
+    intptr_t step = (intptr_t)p[first + 1] - (intptr_t)p[first];
+    return (intptr_t)p[first + count] - (intptr_t)p[first] == step * count;
+}
+
+// Split arrays of pointers to the operands of a batch of gemms into
+// runs in which all three operands are evenly spaced, and call
+// f(first, count, strideA, strideB, strideC) for each run.
+template<typename T, typename F>
+void for_each_strided_run(const T *const *A, const T *const *B, T *const *C,
+                          const int batch_count, F f) {
+    int first = 0;
+    while (first < batch_count) {
+        int count = 1, sA = 0, sB = 0, sC = 0;
+        // The problems in a run are done in parallel, so a run must
+        // not write the same C twice.
+        if (first + 1 < batch_count &&
+            pointer_stride(A, first, &sA) &&
+            pointer_stride(B, first, &sB) &&
+            pointer_stride(C, first, &sC) && sC != 0) {
+            count = 2;
+            while (first + count < batch_count &&
+                   continues_run(A, first, count) &&
+                   continues_run(B, first, count) &&
+                   continues_run(C, first, count)) {
+                count++;
+            }
+        }
+        f(first, count, sA, sB, sC);
+        first += count;
+    }
+}
+
 }
 
 #ifdef __cplusplus
@@ -247,6 +323,64 @@ void hblas_dgemv(const enum HBLAS_ORDER Order, const enum HBLAS_TRANSPOSE trans,
     assert_no_error(halide_dgemv(t, a, &buff_A, &buff_x, b, &buff_y));
 }
 
+//////////////////
+// gemv_batched //
+//////////////////
+
+void hblas_sgemv_strided_batched(const enum HBLAS_ORDER Order, const enum HBLAS_TRANSPOSE trans,
+                                 const int M, const int N, const float a, const float *A,
+                                 const int lda, const int strideA, const float *x, const int incx,
+                                 const int stridex, const float b, float *y, const int incy,
+                                 const int stridey, const int batch_count) {
+    bool t = false;
+    switch (trans) {
+    case HblasNoTrans:
+        t = false; break;
+    case HblasConjTrans:
+    case HblasTrans:
+        t = true; break;
+    };
+
+    buffer_t buff_A, buff_x, buff_y;
+    init_batched_matrix_buffer(M, N, batch_count, A, lda, strideA, &buff_A);
+    if (t) {
+        init_batched_vector_buffer(M, batch_count, x, incx, stridex, &buff_x);
+        init_batched_vector_buffer(N, batch_count, y, incy, stridey, &buff_y);
+    } else {
+        init_batched_vector_buffer(N, batch_count, x, incx, stridex, &buff_x);
+        init_batched_vector_buffer(M, batch_count, y, incy, stridey, &buff_y);
+    }
+
+    assert_no_error(halide_sgemv_batched(t, a, &buff_A, &buff_x, b, &buff_y));
+}
+
+void hblas_dgemv_strided_batched(const enum HBLAS_ORDER Order, const enum HBLAS_TRANSPOSE trans,
+                                 const int M, const int N, const double a, const double *A,
+                                 const int lda, const int strideA, const double *x, const int incx,
+                                 const int stridex, const double b, double *y, const int incy,
+                                 const int stridey, const int batch_count) {
+    bool t = false;
+    switch (trans) {
+    case HblasNoTrans:
+        t = false; break;
+    case HblasConjTrans:
+    case HblasTrans:
+        t = true; break;
+    };
+
+    buffer_t buff_A, buff_x, buff_y;
+    init_batched_matrix_buffer(M, N, batch_count, A, lda, strideA, &buff_A);
+    if (t) {
+        init_batched_vector_buffer(M, batch_count, x, incx, stridex, &buff_x);
+        init_batched_vector_buffer(N, batch_count, y, incy, stridey, &buff_y);
+    } else {
+        init_batched_vector_buffer(N, batch_count, x, incx, stridex, &buff_x);
+        init_batched_vector_buffer(M, batch_count, y, incy, stridey, &buff_y);
+    }
+
+    assert_no_error(halide_dgemv_batched(t, a, &buff_A, &buff_x, b, &buff_y));
+}
+
 //////////
 // ger  //
 //////////
@@ -359,6 +493,122 @@ void hblas_dgemm(const enum HBLAS_ORDER Order, const enum HBLAS_TRANSPOSE TransA
     assert_no_error(halide_dgemm(tA, tB, alpha, &buff_A, &buff_B, beta, &buff_C));
 }
 
+//////////////////
+// gemm_batched //
+//////////////////
+
+void hblas_sgemm_strided_batched(const enum HBLAS_ORDER Order, const enum HBLAS_TRANSPOSE TransA,
+                                 const enum HBLAS_TRANSPOSE TransB, const int M, const int N,
+                                 const int K, const float alpha, const float *A,
+                                 const int lda, const int strideA, const float *B,
+                                 const int ldb, const int strideB, const float beta,
+                                 float *C, const int ldc, const int strideC,
+                                 const int batch_count) {
+    bool tA = false, tB = false;
+    switch (TransA) {
+    case HblasNoTrans:
+        tA = false; break;
+    case HblasConjTrans:
+    case HblasTrans:
+        tA = true; break;
+    };
+
+    switch (TransB) {
+    case HblasNoTrans:
+        tB = false; break;
+    case HblasConjTrans:
+    case HblasTrans:
+        tB = true; break;
+    };
+
+    buffer_t buff_A, buff_B, buff_C;
+    if (!tA) {
+        init_batched_matrix_buffer(M, K, batch_count, A, lda, strideA, &buff_A);
+    } else {
+        init_batched_matrix_buffer(K, M, batch_count, A, lda, strideA, &buff_A);
+    }
+
+    if (!tB) {
+        init_batched_matrix_buffer(K, N, batch_count, B, ldb, strideB, &buff_B);
+    } else {
+        init_batched_matrix_buffer(N, K, batch_count, B, ldb, strideB, &buff_B);
+    }
+
+    init_batched_matrix_buffer(M, N, batch_count, C, ldc, strideC, &buff_C);
+
+    assert_no_error(halide_sgemm_batched(tA, tB, alpha, &buff_A, &buff_B, beta, &buff_C));
+}
+
+void hblas_sgemm_batched(const enum HBLAS_ORDER Order, const enum HBLAS_TRANSPOSE TransA,
+                         const enum HBLAS_TRANSPOSE TransB, const int M, const int N,
+                         const int K, const float alpha, const float *const *A,
+                         const int lda, const float *const *B, const int ldb,
+                         const float beta, float *const *C, const int ldc,
+                         const int batch_count) {
+    for_each_strided_run(A, B, C, batch_count,
+                         [&](int first, int count, int strideA, int strideB, int strideC) {
+        hblas_sgemm_strided_batched(Order, TransA, TransB, M, N, K,
+                                    alpha, A[first], lda, strideA, B[first], ldb, strideB,
+                                    beta, C[first], ldc, strideC, count);
+    });
+}
+
+void hblas_dgemm_strided_batched(const enum HBLAS_ORDER Order, const enum HBLAS_TRANSPOSE TransA,
+                                 const enum HBLAS_TRANSPOSE TransB, const int M, const int N,
+                                 const int K, const double alpha, const double *A,
+                                 const int lda, const int strideA, const double *B,
+                                 const int ldb, const int strideB, const double beta,
+                                 double *C, const int ldc, const int strideC,
+                                 const int batch_count) {
+    bool tA = false, tB = false;
+    switch (TransA) {
+    case HblasNoTrans:
+        tA = false; break;
+    case HblasConjTrans:
+    case HblasTrans:
+        tA = true; break;
+    };
+
+    switch (TransB) {
+    case HblasNoTrans:
+        tB = false; break;
+    case HblasConjTrans:
+    case HblasTrans:
+        tB = true; break;
+    };
+
+    buffer_t buff_A, buff_B, buff_C;
+    if (!tA) {
+        init_batched_matrix_buffer(M, K, batch_count, A, lda, strideA, &buff_A);
+    } else {
+        init_batched_matrix_buffer(K, M, batch_count, A, lda, strideA, &buff_A);
+    }
+
+    if (!tB) {
+        init_batched_matrix_buffer(K, N, batch_count, B, ldb, strideB, &buff_B);
+    } else {
+        init_batched_matrix_buffer(N, K, batch_count, B, ldb, strideB, &buff_B);
+    }
+
+    init_batched_matrix_buffer(M, N, batch_count, C, ldc, strideC, &buff_C);
+
+    assert_no_error(halide_dgemm_batched(tA, tB, alpha, &buff_A, &buff_B, beta, &buff_C));
+}
+
+void hblas_dgemm_batched(const enum HBLAS_ORDER Order, const enum HBLAS_TRANSPOSE TransA,
+                         const enum HBLAS_TRANSPOSE TransB, const int M, const int N,
+                         const int K, const double alpha, const double *const *A,
+                         const int lda, const double *const *B, const int ldb,
+                         const double beta, double *const *C, const int ldc,
+                         const int batch_count) {
+    for_each_strided_run(A, B, C, batch_count,
+                         [&](int first, int count, int strideA, int strideB, int strideC) {
+        hblas_dgemm_strided_batched(Order, TransA, TransB, M, N, K,
+                                    alpha, A[first], lda, strideA, B[first], ldb, strideB,
+                                    beta, C[first], ldc, strideC, count);
+    });
+}
+
 
 #ifdef __cplusplus
 }
@@ -28,6 +28,18 @@
 #include "halide_dgemm_transB.h"
 #include "halide_sgemm_transAB.h"
 #include "halide_dgemm_transAB.h"
+#include "halide_sgemv_batched_notrans.h"
+#include "halide_dgemv_batched_notrans.h"
+#include "halide_sgemv_batched_trans.h"
+#include "halide_dgemv_batched_trans.h"
+#include "halide_sgemm_batched_notrans.h"
+#include "halide_dgemm_batched_notrans.h"
+#include "halide_sgemm_batched_transA.h"
+#include "halide_dgemm_batched_transA.h"
+#include "halide_sgemm_batched_transB.h"
+#include "halide_dgemm_batched_transB.h"
+#include "halide_sgemm_batched_transAB.h"
+#include "halide_dgemm_batched_transAB.h"
 
 inline int halide_scopy(buffer_t *x, buffer_t *y) {
     return halide_scopy_impl(0, x, nullptr, y);
@@ -103,6 +115,46 @@ inline int halide_dgemm(bool transA, bool transB, double a, buffer_t *A, buffer_
     return -1;
 }
 
+inline int halide_sgemv_batched(bool trans, float a, buffer_t *A, buffer_t *x, float b, buffer_t *y) {
+    if (trans) {
+        return halide_sgemv_batched_trans(a, A, x, b, y, y);
+    } else {
+        return halide_sgemv_batched_notrans(a, A, x, b, y, y);
+    }
+}
+
+inline int halide_dgemv_batched(bool trans, double a, buffer_t *A, buffer_t *x, double b, buffer_t *y) {
+    if (trans) {
+        return halide_dgemv_batched_trans(a, A, x, b, y, y);
+    } else {
+        return halide_dgemv_batched_notrans(a, A, x, b, y, y);
+    }
+}
+
+inline int halide_sgemm_batched(bool transA, bool transB, float a, buffer_t *A, buffer_t *B, float b, buffer_t *C) {
+    if (transA && transB) {
+        return halide_sgemm_batched_transAB(a, A, B, b, C, C);
+    } else if (transA) {
+        return halide_sgemm_batched_transA(a, A, B, b, C, C);
+    } else if (transB) {
+        return halide_sgemm_batched_transB(a, A, B, b, C, C);
+    } else {
+        return halide_sgemm_batched_notrans(a, A, B, b, C, C);
+    }
+}
+
+inline int halide_dgemm_batched(bool transA, bool transB, double a, buffer_t *A, buffer_t *B, double b, buffer_t *C) {
+    if (transA && transB) {
+        return halide_dgemm_batched_transAB(a, A, B, b, C, C);
+    } else if (transA) {
+        return halide_dgemm_batched_transA(a, A, B, b, C, C);
+    } else if (transB) {
+        return halide_dgemm_batched_transB(a, A, B, b, C, C);
+    } else {
+        return halide_dgemm_batched_notrans(a, A, B, b, C, C);
+    }
+}
+
 enum HBLAS_ORDER {HblasRowMajor=101, HblasColMajor=102};
 enum HBLAS_TRANSPOSE {HblasNoTrans=111, HblasTrans=112, HblasConjTrans=113};
 enum HBLAS_UPLO {HblasUpper=121, HblasLower=122};
@@ -223,6 +275,25 @@ void hblas_dger(const enum HBLAS_ORDER order, const int M, const int N,
                 const double alpha, const double *X, const int incX,
                 const double *Y, const int incY, double *A, const int lda);
 
+/*
+ * Batched routines. The strided forms take batch_count problems whose
+ * operands are spaced a constant number of elements apart, and do them
+ * all in one call.
+ */
+void hblas_sgemv_strided_batched(const enum HBLAS_ORDER order,
+                                 const enum HBLAS_TRANSPOSE TransA, const int M, const int N,
+                                 const float alpha, const float *A, const int lda, const int strideA,
+                                 const float *X, const int incX, const int strideX,
+                                 const float beta, float *Y, const int incY, const int strideY,
+                                 const int batch_count);
+
+void hblas_dgemv_strided_batched(const enum HBLAS_ORDER order,
+                                 const enum HBLAS_TRANSPOSE TransA, const int M, const int N,
+                                 const double alpha, const double *A, const int lda, const int strideA,
+                                 const double *X, const int incX, const int strideX,
+                                 const double beta, double *Y, const int incY, const int strideY,
+                                 const int batch_count);
+
 /*
  * ===========================================================================
  * Prototypes for level 3 BLAS
@@ -244,6 +315,42 @@ void hblas_dgemm(const enum HBLAS_ORDER Order, const enum HBLAS_TRANSPOSE TransA
                  const int lda, const double *B, const int ldb,
                  const double beta, double *C, const int ldc);
 
+/*
+ * Batched routines. The strided forms take batch_count problems whose
+ * operands are spaced a constant number of elements apart. The other
+ * forms take arrays of pointers to the operands, and do each run of
+ * evenly spaced problems in one call.
+ */
+void hblas_sgemm_strided_batched(const enum HBLAS_ORDER Order, const enum HBLAS_TRANSPOSE TransA,
+                                 const enum HBLAS_TRANSPOSE TransB, const int M, const int N,
+                                 const int K, const float alpha, const float *A,
+                                 const int lda, const int strideA, const float *B,
+                                 const int ldb, const int strideB, const float beta,
+                                 float *C, const int ldc, const int strideC,
+                                 const int batch_count);
+
+void hblas_dgemm_strided_batched(const enum HBLAS_ORDER Order, const enum HBLAS_TRANSPOSE TransA,
+                                 const enum HBLAS_TRANSPOSE TransB, const int M, const int N,
+                                 const int K, const double alpha, const double *A,
+                                 const int lda, const int strideA, const double *B,
+                                 const int ldb, const int strideB, const double beta,
+                                 double *C, const int ldc, const int strideC,
+                                 const int batch_count);
+
+void hblas_sgemm_batched(const enum HBLAS_ORDER Order, const enum HBLAS_TRANSPOSE TransA,
+                         const enum HBLAS_TRANSPOSE TransB, const int M, const int N,
+                         const int K, const float alpha, const float *const *A,
+                         const int lda, const float *const *B, const int ldb,
+                         const float beta, float *const *C, const int ldc,
+                         const int batch_count);
+
+void hblas_dgemm_batched(const enum HBLAS_ORDER Order, const enum HBLAS_TRANSPOSE TransA,
+                         const enum HBLAS_TRANSPOSE TransB, const int M, const int N,
+                         const int K, const double alpha, const double *const *A,
+                         const int lda, const double *const *B, const int ldb,
+                         const double beta, double *const *C, const int ldc,
+                         const int batch_count);
+
 #ifdef __cplusplus
 }
 #endif
@@ -113,6 +113,70 @@
     }
 
 
+// Batched tests do N small problems of size n at once, and compare
+// against doing them one at a time. The operands of problem i are at
+// A + i*n*n, x + i*n, etc. For the forms that take arrays of
+// pointers, the second half of the batch is in reverse order.
+#define L2_BATCHED_TEST(method, n, cblas_code, hblas_code)      \
+    bool test_##method(int N) {                                 \
+        Scalar alpha = random_scalar();                         \
+        Scalar beta = random_scalar();                          \
+        Vector ex(random_vector(n * N));                        \
+        Vector ey(random_vector(n * N));                        \
+        Vector eA(random_vector(n * n * N));                    \
+        Vector ax(ex), ay(ey), aA(eA);                          \
+                                                                \
+        for (int i = 0; i < N; ++i) {                           \
+            Scalar *x = &(ex[0]);                               \
+            Scalar *y = &(ey[0]);                               \
+            Scalar *A = &(eA[0]);                               \
+            cblas_code;                                         \
+        }                                                       \
+                                                                \
+        {                                                       \
+            Scalar *x = &(ax[0]);                               \
+            Scalar *y = &(ay[0]);                               \
+            Scalar *A = &(aA[0]);                               \
+            hblas_code;                                         \
+        }                                                       \
+                                                                \
+        return compareVectors(n * N, ey, ay);                   \
+    }
+
+#define L3_BATCHED_TEST(method, n, cblas_code, hblas_code)      \
+    bool test_##method(int N) {                                 \
+        Scalar alpha = random_scalar();                         \
+        Scalar beta = random_scalar();                          \
+        Vector eA(random_vector(n * n * N));                    \
+        Vector eB(random_vector(n * n * N));                    \
+        Vector eC(random_vector(n * n * N));                    \
+        Vector aA(eA), aB(eB), aC(eC);                          \
+                                                                \
+        for (int i = 0; i < N; ++i) {                           \
+            Scalar *A = &(eA[0]);                               \
+            Scalar *B = &(eB[0]);                               \
+            Scalar *C = &(eC[0]);                               \
+            cblas_code;                                         \
+        }                                                       \
+                                                                \
+        {                                                       \
+            Scalar *A = &(aA[0]);                               \
+            Scalar *B = &(aB[0]);                               \
+            Scalar *C = &(aC[0]);                               \
+            std::vector<const Scalar *> pA(N), pB(N);           \
+            std::vector<Scalar *> pC(N);                        \
+            for (int i = 0; i < N; ++i) {                       \
+                int j = i < N/2 ? i : N - 1 - (i - N/2);        \
+                pA[i] = A + j * n * n;                          \
+                pB[i] = B + j * n * n;                          \
+                pC[i] = C + j * n * n;                          \
+            }                                                   \
+            hblas_code;                                         \
+        }                                                       \
+                                                                \
+        return compareVectors(n * n * N, eC, aC);               \
+    }
+
 template<class T>
 struct BLASTestBase {
     typedef T Scalar;
@@ -211,6 +275,11 @@ struct BLASFloatTests : public BLASTestBase<float> {
         RUN_TEST(sgemm_transA);
         RUN_TEST(sgemm_transB);
         RUN_TEST(sgemm_transAB);
+        RUN_TEST(sgemv_batched_notrans);
+        RUN_TEST(sgemv_batched_trans);
+        RUN_TEST(sgemm_batched_notrans);
+        RUN_TEST(sgemm_batched_transAB);
+        RUN_TEST(sgemm_batched);
     }
 
     L1_VECTOR_TEST(scopy, scopy(N, x, 1, y, 1))
@@ -242,6 +311,23 @@ struct BLASFloatTests : public BLASTestBase<float> {
     L3_TEST(sgemm_transAB,
             cblas_sgemm(CblasColMajor, CblasTrans, CblasTrans, N, N, N, alpha, A, N, B, N, beta, C, N),
             hblas_sgemm(HblasColMajor, HblasTrans, HblasTrans, N, N, N, alpha, A, N, B, N, beta, C, N));
+
+    L2_BATCHED_TEST(sgemv_batched_notrans, 8,
+            cblas_sgemv(CblasColMajor, CblasNoTrans, 8, 8, alpha, A + i*64, 8, x + i*8, 1, beta, y + i*8, 1),
+            hblas_sgemv_strided_batched(HblasColMajor, HblasNoTrans, 8, 8, alpha, A, 8, 64, x, 1, 8, beta, y, 1, 8, N));
+    L2_BATCHED_TEST(sgemv_batched_trans, 3,
+            cblas_sgemv(CblasColMajor, CblasTrans, 3, 3, alpha, A + i*9, 3, x + i*3, 1, beta, y + i*3, 1),
+            hblas_sgemv_strided_batched(HblasColMajor, HblasTrans, 3, 3, alpha, A, 3, 9, x, 1, 3, beta, y, 1, 3, N));
+
+    L3_BATCHED_TEST(sgemm_batched_notrans, 8,
+            cblas_sgemm(CblasColMajor, CblasNoTrans, CblasNoTrans, 8, 8, 8, alpha, A + i*64, 8, B + i*64, 8, beta, C + i*64, 8),
+            hblas_sgemm_strided_batched(HblasColMajor, HblasNoTrans, HblasNoTrans, 8, 8, 8, alpha, A, 8, 64, B, 8, 64, beta, C, 8, 64, N));
+    L3_BATCHED_TEST(sgemm_batched_transAB, 3,
+            cblas_sgemm(CblasColMajor, CblasTrans, CblasTrans, 3, 3, 3, alpha, A + i*9, 3, B + i*9, 3, beta, C + i*9, 3),
+            hblas_sgemm_strided_batched(HblasColMajor, HblasTrans, HblasTrans, 3, 3, 3, alpha, A, 3, 9, B, 3, 9, beta, C, 3, 9, N));
+    L3_BATCHED_TEST(sgemm_batched, 5,
+            cblas_sgemm(CblasColMajor, CblasNoTrans, CblasTrans, 5, 5, 5, alpha, A + i*25, 5, B + i*25, 5, beta, C + i*25, 5),
+            hblas_sgemm_batched(HblasColMajor, HblasNoTrans, HblasTrans, 5, 5, 5, alpha, &pA[0], 5, &pB[0], 5, beta, &pC[0], 5, N));
 };
 
 struct BLASDoubleTests : public BLASTestBase<double> {
@@ -258,6 +344,11 @@ struct BLASDoubleTests : public BLASTestBase<double> {
         RUN_TEST(dgemm_transA);
         RUN_TEST(dgemm_transB);
         RUN_TEST(dgemm_transAB);
+        RUN_TEST(dgemv_batched_notrans);
+        RUN_TEST(dgemv_batched_trans);
+        RUN_TEST(dgemm_batched_notrans);
+        RUN_TEST(dgemm_batched_transAB);
+        RUN_TEST(dgemm_batched);
     }
 
     L1_VECTOR_TEST(dcopy, dcopy(N, x, 1, y, 1))
@@ -289,6 +380,23 @@ struct BLASDoubleTests : public BLASTestBase<double> {
     L3_TEST(dgemm_transAB,
             cblas_dgemm(CblasColMajor, CblasTrans, CblasTrans, N, N, N, alpha, A, N, B, N, beta, C, N),
             hblas_dgemm(HblasColMajor, HblasTrans, HblasTrans, N, N, N, alpha, A, N, B, N, beta, C, N));
+
+    L2_BATCHED_TEST(dgemv_batched_notrans, 8,
+            cblas_dgemv(CblasColMajor, CblasNoTrans, 8, 8, alpha, A + i*64, 8, x + i*8, 1, beta, y + i*8, 1),
+            hblas_dgemv_strided_batched(HblasColMajor, HblasNoTrans, 8, 8, alpha, A, 8, 64, x, 1, 8, beta, y, 1, 8, N));
+    L2_BATCHED_TEST(dgemv_batched_trans, 3,
+            cblas_dgemv(CblasColMajor, CblasTrans, 3, 3, alpha, A + i*9, 3, x + i*3, 1, beta, y + i*3, 1),
+            hblas_dgemv_strided_batched(HblasColMajor, HblasTrans, 3, 3, alpha, A, 3, 9, x, 1, 3, beta, y, 1, 3, N));
+
+    L3_BATCHED_TEST(dgemm_batched_notrans, 8,
+            cblas_dgemm(CblasColMajor, CblasNoTrans, CblasNoTrans, 8, 8, 8, alpha, A + i*64, 8, B + i*64, 8, beta, C + i*64, 8),
+            hblas_dgemm_strided_batched(HblasColMajor, HblasNoTrans, HblasNoTrans, 8, 8, 8, alpha, A, 8, 64, B, 8, 64, beta, C, 8, 64, N));
+    L3_BATCHED_TEST(dgemm_batched_transAB, 3,
+            cblas_dgemm(CblasColMajor, CblasTrans, CblasTrans, 3, 3, 3, alpha, A + i*9, 3, B + i*9, 3, beta, C + i*9, 3),
+            hblas_dgemm_strided_batched(HblasColMajor, HblasTrans, HblasTrans, 3, 3, 3, alpha, A, 3, 9, B, 3, 9, beta, C, 3, 9, N));
+    L3_BATCHED_TEST(dgemm_batched, 5,
+            cblas_dgemm(CblasColMajor, CblasNoTrans, CblasTrans, 5, 5, 5, alpha, A + i*25, 5, B + i*25, 5, beta, C + i*25, 5),
+            hblas_dgemm_batched(HblasColMajor, HblasNoTrans, HblasTrans, 5, 5, 5, alpha, &pA[0], 5, &pB[0], 5, beta, &pC[0], 5, N));
 };
 
 int main(int argc, char *argv[]) {
@@ -58,6 +58,22 @@ public:
     }
 };
 
+void add_output_buffers(const vector<Function> &outputs, map<string, FindBuffers::Result> &bufs) {
+    for (Function f : outputs) {
+        for (size_t i = 0; i < f.values().size(); i++) {
+            FindBuffers::Result output_buffer;
+            output_buffer.type = f.values()[i].type();
+            output_buffer.param = f.output_buffers()[i];
+            output_buffer.dimensions = f.dimensions();
+            if (f.values().size() > 1) {
+                bufs[f.name() + '.' + std::to_string(i)] = output_buffer;
+            } else {
+                bufs[f.name()] = output_buffer;
+            }
+        }
+    }
+}
+
 Stmt add_image_checks(Stmt s,
                       const vector<Function> &outputs,
                       const Target &t,
@@ -81,19 +97,8 @@ Stmt add_image_checks(Stmt s,
             << "Output Func " << f.name()
             << " has " << f.dimensions()
             << " dimensions. Output buffers may not currently have more than four dimensions.\n";
-
-        for (size_t i = 0; i < f.values().size(); i++) {
-            FindBuffers::Result output_buffer;
-            output_buffer.type = f.values()[i].type();
-            output_buffer.param = f.output_buffers()[i];
-            output_buffer.dimensions = f.dimensions();
-            if (f.values().size() > 1) {
-                bufs[f.name() + '.' + std::to_string(i)] = output_buffer;
-            } else {
-                bufs[f.name()] = output_buffer;
-            }
-        }
     }
+    add_output_buffers(outputs, bufs);
 
     Scope<Interval> empty_scope;
     map<string, Box> boxes = boxes_touched(s, empty_scope, fb);
@@ -572,5 +577,72 @@ Stmt add_image_checks(Stmt s,
     return s;
 }
 
+Stmt specialize_image_shapes(Stmt s, const vector<Function> &outputs, const Target &t) {
+    bool no_bounds_query = t.has_feature(Target::NoBoundsQuery);
+
+    FindBuffers finder;
+    s.accept(&finder);
+    map<string, FindBuffers::Result> bufs = finder.buffers;
+    add_output_buffers(outputs, bufs);
+
+    // Collect the test for each specialized field, and the lets that
+    // define it as a constant in the specialized copy. The bounds
+    // query and elem_size checks of specialized buffers fold away
+    // too.
+    Expr specialized_condition = const_true();
+    vector<pair<string, Expr>> lets_specialized;
+    for (const pair<string, FindBuffers::Result> &buf : bufs) {
+        const string &name = buf.first;
+        const Parameter &param = buf.second.param;
+        if (!param.defined()) {
+            continue;
+        }
+
+        ReductionDomain rdom;
+        bool specialized = false;
+        for (int i = 0; i < param.dimensions(); i++) {
+            string dim = std::to_string(i);
+            pair<string, Expr> fields[] = {
+                {name + ".min." + dim, param.min_specialization(i)},
+                {name + ".extent." + dim, param.extent_specialization(i)},
+                {name + ".stride." + dim, param.stride_specialization(i)}
+            };
+            for (const pair<string, Expr> &field : fields) {
+                if (field.second.defined()) {
+                    Expr var = Variable::make(Int(32), field.first, BufferPtr(), param, rdom);
+                    specialized_condition = specialized_condition && (var == field.second);
+                    lets_specialized.push_back(field);
+                    specialized = true;
+                }
+            }
+        }
+
+        if (specialized) {
+            string elem_size_name = name + ".elem_size";
+            Expr elem_size = Variable::make(Int(32), elem_size_name, BufferPtr(), param, rdom);
+            Expr correct_size = buf.second.type.bytes();
+            specialized_condition = specialized_condition && (elem_size == correct_size);
+            lets_specialized.push_back(make_pair(elem_size_name, correct_size));
+
+            if (!no_bounds_query) {
+                string inference_mode_name = name + ".host_and_dev_are_null";
+                Expr inference_mode = Variable::make(UInt(1), inference_mode_name, BufferPtr(), param, rdom);
+                specialized_condition = specialized_condition && !inference_mode;
+                lets_specialized.push_back(make_pair(inference_mode_name, const_false()));
+            }
+        }
+    }
+
+    if (!lets_specialized.empty()) {
+        Stmt specialized = s;
+        for (size_t i = lets_specialized.size(); i > 0; i--) {
+            specialized = LetStmt::make(lets_specialized[i-1].first, lets_specialized[i-1].second, specialized);
+        }
+        s = IfThenElse::make(specialized_condition, specialized, s);
+    }
+
+    return s;
+}
+
 }
 }
@@ -29,6 +29,15 @@ Stmt add_image_checks(Stmt s,
                       const std::map<std::string, Function> &env,
                       const FuncValueBounds &fb);
 
+/** Make a copy of a statement in which buffers with specialized
+ * shapes (see Parameter::set_extent_specialization) have those
+ * shapes, guarded by a test that the buffers passed in match
+ * them. Must run after add_image_checks and bounds inference so
+ * that the checks and bounds expressions in the copy fold away. */
+Stmt specialize_image_shapes(Stmt s,
+                             const std::vector<Function> &outputs,
+                             const Target &t);
+
 
 }
 }
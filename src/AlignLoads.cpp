@@ -50,6 +50,13 @@ private:
             return;
         }
 
+        if (!is_one(op->predicate)) {
+            // Realigning a predicated load would touch lanes that
+            // are masked off.
+            IRMutator::visit(op);
+            return;
+        }
+
         if (op->image.defined()) {
             // We can't reason about the alignment of external images.
             IRMutator::visit(op);
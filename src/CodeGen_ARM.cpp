@@ -10,6 +10,8 @@
 #include "Util.h"
 #include "Simplify.h"
 #include "IRPrinter.h"
+#include "OptimizeShuffles.h"
+#include "FindIntrinsics.h"
 #include "LLVM_Headers.h"
 
 namespace Halide {
@@ -637,7 +639,8 @@ void CodeGen_ARM::visit(const Max *op) {
 }
 
 void CodeGen_ARM::visit(const Store *op) {
-    if (neon_intrinsics_disabled()) {
+    // Predicated stores are handled by the generic codegen
+    if (neon_intrinsics_disabled() || !is_one(op->predicate)) {
         CodeGen_Posix::visit(op);
         return;
     }
@@ -812,7 +815,8 @@ void CodeGen_ARM::visit(const Store *op) {
 }
 
 void CodeGen_ARM::visit(const Load *op) {
-    if (neon_intrinsics_disabled()) {
+    // Predicated loads are handled by the generic codegen
+    if (neon_intrinsics_disabled() || !is_one(op->predicate)) {
         CodeGen_Posix::visit(op);
         return;
     }
@@ -936,7 +940,193 @@ void CodeGen_ARM::visit(const Load *op) {
     CodeGen_Posix::visit(op);
 }
 
+void CodeGen_ARM::codegen_vector_reduce(const Call *op) {
+    Type t = op->args[0].type();
+    int bits = t.bits() * t.lanes();
+    if (neon_intrinsics_disabled() ||
+        !op->is_intrinsic(Call::vector_reduce_add) ||
+        !(t.is_int() || t.is_uint()) ||
+        t.bits() > 32 ||
+        (bits != 64 && bits != 128)) {
+        CodeGen_Posix::codegen_vector_reduce(op);
+        return;
+    }
+
+    Value *v = codegen(op->args[0]);
+    int lanes = t.lanes();
+    if (target.bits == 64) {
+        if (t.bits() == 32 && lanes == 2) {
+            // There's no addv for two lanes.
+            CodeGen_Posix::codegen_vector_reduce(op);
+            return;
+        }
+        // addv sums the whole vector into a 32-bit result.
+        ostringstream name;
+        name << "llvm.aarch64.neon." << (t.is_int() ? "saddv" : "uaddv")
+             << ".i32.v" << lanes << "i" << t.bits();
+        llvm::Function *fn = module->getFunction(name.str());
+        if (!fn) {
+            FunctionType *fn_t = FunctionType::get(i32_t, {v->getType()}, false);
+            fn = llvm::Function::Create(fn_t, llvm::Function::ExternalLinkage, name.str(), module.get());
+        }
+        value = builder->CreateCall(fn, {v});
+        value = builder->CreateIntCast(value, llvm_type_of(op->type), t.is_int());
+    } else {
+        // vpadd works on d registers, so add the halves of a q
+        // register first.
+        if (bits == 128) {
+            lanes /= 2;
+            v = builder->CreateAdd(slice_vector(v, 0, lanes), slice_vector(v, lanes, lanes));
+        }
+        ostringstream name;
+        name << "llvm.arm.neon.vpadd.v" << lanes << "i" << t.bits();
+        for (int l = lanes; l > 1; l /= 2) {
+            v = call_intrin(v->getType(), lanes, name.str(), {v, v});
+        }
+        value = builder->CreateExtractElement(v, ConstantInt::get(i32_t, 0));
+    }
+}
+
+void CodeGen_ARM::compile_func(const LoweredFunc &f,
+                               const string &simple_name, const string &extern_name) {
+    LoweredFunc func = f;
+    if (!neon_intrinsics_disabled()) {
+        debug(1) << "Optimizing shuffles...\n";
+        // tbl2 and vtbl4 look up tables of 32 bytes. We can't read
+        // past the end of the table, so there is no alignment slop.
+        func.body = optimize_shuffles(func.body, 0, 32, 8);
+        debug(2) << "Lowering after optimizing shuffles:\n" << func.body << "\n\n";
+    }
+
+    debug(1) << "Finding fixed-point intrinsics...\n";
+    func.body = find_intrinsics(func.body);
+    debug(2) << "Lowering after finding fixed-point intrinsics:\n" << func.body << "\n\n";
+
+    CodeGen_Posix::compile_func(func, simple_name, extern_name);
+}
+
+void CodeGen_ARM::codegen_dynamic_shuffle(const Call *op) {
+    internal_assert(op->args.size() == 4);
+    int lut_lanes = op->args[0].type().lanes();
+    if (neon_intrinsics_disabled() ||
+        op->type.bits() != 8 ||
+        lut_lanes > 32) {
+        CodeGen_Posix::codegen_dynamic_shuffle(op);
+        return;
+    }
+
+    // aarch64 tbl takes up to four q registers of table, and 32-bit
+    // arm vtbl takes up to four d registers. Indices are looked up a
+    // register at a time.
+    int table_lanes = target.bits == 64 ? 16 : 8;
+    int tables = (lut_lanes + table_lanes - 1) / table_lanes;
+    string name;
+    if (target.bits == 64) {
+        name = "llvm.aarch64.neon.tbl" + std::to_string(tables) + ".v16i8";
+    } else {
+        name = "llvm.arm.neon.vtbl" + std::to_string(tables);
+    }
+
+    Value *lut = codegen(op->args[0]);
+    Value *index = codegen(op->args[1]);
+    vector<Value *> args;
+    for (int i = 0; i < tables; i++) {
+        args.push_back(slice_vector(lut, i * table_lanes, table_lanes));
+    }
+
+    int lanes = op->type.lanes();
+    int padded_lanes = ((lanes + table_lanes - 1) / table_lanes) * table_lanes;
+    index = slice_vector(index, 0, padded_lanes);
+    llvm::Type *slice_t = llvm_type_of(op->type.with_lanes(table_lanes));
+
+    vector<Value *> slices;
+    for (int i = 0; i < padded_lanes; i += table_lanes) {
+        args.push_back(slice_vector(index, i, table_lanes));
+        slices.push_back(call_intrin(slice_t, table_lanes, name, args));
+        args.pop_back();
+    }
+    value = slice_vector(concat_vectors(slices), 0, lanes);
+}
+
+void CodeGen_ARM::codegen_fixed_point_intrinsic(const Call *op) {
+    Type t = op->type;
+    Type arg_t = op->args[0].type();
+    if (neon_intrinsics_disabled() || !t.is_vector()) {
+        CodeGen_Posix::visit(op);
+        return;
+    }
+
+    // Use the 64-bit form of an instruction when the args are exactly
+    // 64 bits wide, and the 128-bit form otherwise.
+    int intrin_lanes = arg_t.bits() * arg_t.lanes() == 64 ? 64 / arg_t.bits() : 128 / arg_t.bits();
+    string prefix = target.bits == 32 ? "llvm.arm.neon." : "llvm.aarch64.neon.";
+    string suffix = ".v" + std::to_string(intrin_lanes) + "i" + std::to_string(arg_t.bits());
+    bool is_signed = arg_t.is_int();
+
+    struct Mapping {
+        Call::ConstString intrin;
+        const char *arm32_signed, *arm32_unsigned, *arm64_signed, *arm64_unsigned;
+    };
+    static Mapping mappings[] = {
+        {Call::halving_add, "vhadds", "vhaddu", "shadd", "uhadd"},
+        {Call::rounding_halving_add, "vrhadds", "vrhaddu", "srhadd", "urhadd"},
+        {Call::saturating_add, "vqadds", "vqaddu", "sqadd", "uqadd"},
+        {Call::saturating_sub, "vqsubs", "vqsubu", "sqsub", "uqsub"},
+    };
+    for (const Mapping &m : mappings) {
+        if (op->is_intrinsic(m.intrin)) {
+            string name;
+            if (target.bits == 32) {
+                name = is_signed ? m.arm32_signed : m.arm32_unsigned;
+            } else {
+                name = is_signed ? m.arm64_signed : m.arm64_unsigned;
+            }
+            value = call_intrin(t, intrin_lanes, prefix + name + suffix, op->args);
+            return;
+        }
+    }
+
+    if (op->is_intrinsic(Call::rounding_shift_right)) {
+        // A rounding shift left by a negative amount.
+        const int64_t *shift = as_const_int(op->args[1]);
+        internal_assert(shift);
+        string name;
+        if (target.bits == 32) {
+            name = is_signed ? "vrshifts" : "vrshiftu";
+        } else {
+            name = is_signed ? "srshl" : "urshl";
+        }
+        Expr amount = make_const(arg_t.with_code(Type::Int), -*shift);
+        value = call_intrin(t, intrin_lanes, prefix + name + suffix, {op->args[0], amount});
+        return;
+    }
+
+    if (op->is_intrinsic(Call::saturating_narrow) &&
+        (is_signed || t.is_uint())) {
+        // The narrowing instructions produce 64-bit vectors.
+        int narrow_lanes = 64 / t.bits();
+        string name;
+        if (is_signed && t.is_int()) {
+            name = target.bits == 32 ? "vqmovns" : "sqxtn";
+        } else if (is_signed) {
+            name = target.bits == 32 ? "vqmovnsu" : "sqxtun";
+        } else {
+            name = target.bits == 32 ? "vqmovnu" : "uqxtn";
+        }
+        name += ".v" + std::to_string(narrow_lanes) + "i" + std::to_string(t.bits());
+        value = call_intrin(t, narrow_lanes, prefix + name, op->args);
+        return;
+    }
+
+    CodeGen_Posix::visit(op);
+}
+
 void CodeGen_ARM::visit(const Call *op) {
+    if (is_fixed_point_intrinsic(op)) {
+        codegen_fixed_point_intrinsic(op);
+        return;
+    }
+
     if (op->is_intrinsic(Call::abs) && op->type.is_uint()) {
         internal_assert(op->args.size() == 1);
         // If the arg is a subtract with narrowable args, we can use vabdl.
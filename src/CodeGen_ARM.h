@@ -37,6 +37,22 @@ protected:
     void visit(const Call *);
     // @}
 
+    /** Use addv on aarch64 and vpadd on 32-bit arm for horizontal
+     * sums. */
+    void codegen_vector_reduce(const Call *);
+
+    /** Replace loads from small byte lookup tables with tbl (vtbl on
+     * 32-bit arm) before generating code. */
+    void compile_func(const LoweredFunc &f,
+                      const std::string &simple_name, const std::string &extern_name);
+
+    /** Use tbl or vtbl for lookups in tables of up to 32 bytes. */
+    void codegen_dynamic_shuffle(const Call *);
+
+    /** Map the intrinsics found by find_intrinsics to neon
+     * instructions. */
+    void codegen_fixed_point_intrinsic(const Call *);
+
     /** Various patterns to peephole match against */
     struct Pattern {
         std::string intrin32; ///< Name of the intrinsic for 32-bit arm
@@ -65,9 +65,107 @@ const string globals =
     "int halide_start_clock(void *ctx);\n"
     "int64_t halide_current_time_ns(void *ctx);\n"
     "void halide_profiler_pipeline_end(void *, void *);\n"
+    "typedef int (*halide_task_t)(void *user_context, int task_number, uint8_t *closure);\n"
+    "int halide_do_par_for(void *ctx, halide_task_t task, int min, int size, uint8_t *closure);\n"
     "}\n"
     "\n"
 
+    // Parallel loop bodies are outlined into lambdas. This adapts a
+    // lambda to the task signature halide_do_par_for expects.
+    "template<typename F> int halide_par_for_task(void *ctx, int idx, uint8_t *closure) {\n"
+    " return (*(F *)closure)(idx);\n"
+    "}\n"
+    "\n"
+
+    // Code compiled to C is normally linked against a Halide runtime,
+    // which provides halide_do_par_for. For deployments with no
+    // runtime, defining HALIDE_C_THREAD_POOL when compiling this file
+    // provides a small pthreads thread pool instead. It's weak so that
+    // several such files (or a real runtime) can be linked together.
+    "#ifdef HALIDE_C_THREAD_POOL\n"
+    "#include <pthread.h>\n"
+    "#include <stdlib.h>\n"
+    "#include <unistd.h>\n"
+    "static pthread_mutex_t halide_c_pool_mutex = PTHREAD_MUTEX_INITIALIZER;\n"
+    "static pthread_cond_t halide_c_pool_wake = PTHREAD_COND_INITIALIZER;\n"
+    "static pthread_cond_t halide_c_pool_done = PTHREAD_COND_INITIALIZER;\n"
+    "static struct {\n"
+    " halide_task_t task;\n"
+    " void *ctx;\n"
+    " uint8_t *closure;\n"
+    " int next, end, running, result;\n"
+    " bool busy;\n"
+    " int threads;\n"
+    "} halide_c_pool;\n"
+    "// Claim and run tasks until none are left. Called with the mutex held.\n"
+    "static void halide_c_pool_work() {\n"
+    " while (halide_c_pool.next < halide_c_pool.end) {\n"
+    "  int idx = halide_c_pool.next++;\n"
+    "  halide_task_t task = halide_c_pool.task;\n"
+    "  void *ctx = halide_c_pool.ctx;\n"
+    "  uint8_t *closure = halide_c_pool.closure;\n"
+    "  halide_c_pool.running++;\n"
+    "  pthread_mutex_unlock(&halide_c_pool_mutex);\n"
+    "  int r = task(ctx, idx, closure);\n"
+    "  pthread_mutex_lock(&halide_c_pool_mutex);\n"
+    "  if (r) halide_c_pool.result = r;\n"
+    "  if (--halide_c_pool.running == 0) pthread_cond_broadcast(&halide_c_pool_done);\n"
+    " }\n"
+    "}\n"
+    "static void *halide_c_pool_worker(void *) {\n"
+    " pthread_mutex_lock(&halide_c_pool_mutex);\n"
+    " for (;;) {\n"
+    "  while (halide_c_pool.next >= halide_c_pool.end) {\n"
+    "   pthread_cond_wait(&halide_c_pool_wake, &halide_c_pool_mutex);\n"
+    "  }\n"
+    "  halide_c_pool_work();\n"
+    " }\n"
+    " return nullptr;\n"
+    "}\n"
+    "extern \"C\" __attribute__((weak))\n"
+    "int halide_do_par_for(void *ctx, halide_task_t task, int min, int size, uint8_t *closure) {\n"
+    " pthread_mutex_lock(&halide_c_pool_mutex);\n"
+    " if (halide_c_pool.busy) {\n"
+    "  // A nested parallel loop. The pool is occupied with the outer\n"
+    "  // loop, so run this one serially on the calling thread.\n"
+    "  pthread_mutex_unlock(&halide_c_pool_mutex);\n"
+    "  for (int i = min; i < min + size; i++) {\n"
+    "   int r = task(ctx, i, closure);\n"
+    "   if (r) return r;\n"
+    "  }\n"
+    "  return 0;\n"
+    " }\n"
+    " if (halide_c_pool.threads == 0) {\n"
+    "  const char *env = getenv(\"HL_NUM_THREADS\");\n"
+    "  int n = env ? atoi(env) : (int)sysconf(_SC_NPROCESSORS_ONLN);\n"
+    "  halide_c_pool.threads = n < 1 ? 1 : n;\n"
+    "  // The calling thread is one of the threads.\n"
+    "  for (int i = 1; i < halide_c_pool.threads; i++) {\n"
+    "   pthread_t thread;\n"
+    "   pthread_create(&thread, nullptr, halide_c_pool_worker, nullptr);\n"
+    "   pthread_detach(thread);\n"
+    "  }\n"
+    " }\n"
+    " halide_c_pool.busy = true;\n"
+    " halide_c_pool.task = task;\n"
+    " halide_c_pool.ctx = ctx;\n"
+    " halide_c_pool.closure = closure;\n"
+    " halide_c_pool.next = min;\n"
+    " halide_c_pool.end = min + size;\n"
+    " halide_c_pool.result = 0;\n"
+    " pthread_cond_broadcast(&halide_c_pool_wake);\n"
+    " halide_c_pool_work();\n"
+    " while (halide_c_pool.running > 0) {\n"
+    "  pthread_cond_wait(&halide_c_pool_done, &halide_c_pool_mutex);\n"
+    " }\n"
+    " int result = halide_c_pool.result;\n"
+    " halide_c_pool.busy = false;\n"
+    " pthread_mutex_unlock(&halide_c_pool_mutex);\n"
+    " return result;\n"
+    "}\n"
+    "#endif\n"
+    "\n"
+
     // TODO: this next chunk is copy-pasted from posix_math.cpp. A
     // better solution for the C runtime would be nice.
     "#ifdef _WIN32\n"
@@ -159,6 +257,58 @@ const string globals =
     " b->stride[3] = stride3;\n"
     " return true;\n"
     "}\n";
+
+// Vector types are declared with the GCC/Clang vector extensions, which
+// give us the arithmetic, bitwise, shift and comparison operators for
+// free. The rest is done a lane at a time in small helpers, which the
+// C++ compiler turns back into vector instructions where it can.
+// Vectors of booleans are vectors of int8_t masks, with every bit of a
+// true lane set, as produced by the vector comparison operators.
+const string vector_helpers =
+    "template<typename V, typename T> inline V halide_vec_broadcast(T x) {\n"
+    " V r;\n"
+    " for (size_t i = 0; i < sizeof(r) / sizeof(r[0]); i++) r[i] = x;\n"
+    " return r;\n"
+    "}\n"
+    "template<typename V, typename T> inline V halide_vec_ramp(T base, T stride) {\n"
+    " V r;\n"
+    " for (size_t i = 0; i < sizeof(r) / sizeof(r[0]); i++) r[i] = base + (T)i * stride;\n"
+    " return r;\n"
+    "}\n"
+    "template<typename V, typename T> inline V halide_vec_load(const T *p, int32_t i) {\n"
+    " V r;\n"
+    " memcpy(&r, p + i, sizeof(r));\n"
+    " return r;\n"
+    "}\n"
+    "template<typename V, typename T> inline void halide_vec_store(T *p, int32_t i, V v) {\n"
+    " memcpy(p + i, &v, sizeof(v));\n"
+    "}\n"
+    "template<typename V, typename T, typename I> inline V halide_vec_gather(const T *p, I idx) {\n"
+    " V r;\n"
+    " for (size_t i = 0; i < sizeof(r) / sizeof(r[0]); i++) r[i] = p[idx[i]];\n"
+    " return r;\n"
+    "}\n"
+    "template<typename V, typename T, typename I> inline void halide_vec_scatter(T *p, I idx, V v) {\n"
+    " for (size_t i = 0; i < sizeof(v) / sizeof(v[0]); i++) p[idx[i]] = v[i];\n"
+    "}\n"
+    "template<typename V, typename T, typename I, typename M> inline V halide_vec_masked_gather(const T *p, I idx, M m) {\n"
+    " V r = {0};\n"
+    " for (size_t i = 0; i < sizeof(r) / sizeof(r[0]); i++) if (m[i]) r[i] = p[idx[i]];\n"
+    " return r;\n"
+    "}\n"
+    "template<typename V, typename T, typename I, typename M> inline void halide_vec_masked_scatter(T *p, I idx, V v, M m) {\n"
+    " for (size_t i = 0; i < sizeof(v) / sizeof(v[0]); i++) if (m[i]) p[idx[i]] = v[i];\n"
+    "}\n"
+    "template<typename R, typename A> inline R halide_vec_convert(A a) {\n"
+    " R r;\n"
+    " for (size_t i = 0; i < sizeof(r) / sizeof(r[0]); i++) r[i] = a[i];\n"
+    " return r;\n"
+    "}\n"
+    "template<typename M, typename V> inline V halide_vec_select(M c, V t, V f) {\n"
+    " V r;\n"
+    " for (size_t i = 0; i < sizeof(r) / sizeof(r[0]); i++) r[i] = c[i] ? t[i] : f[i];\n"
+    " return r;\n"
+    "}\n";
 }
 
 CodeGen_C::CodeGen_C(ostream &s, OutputKind output_kind, const std::string &guard) : IRPrinter(s), id("$$ BAD ID $$"), output_kind(output_kind), extern_c_open(false) {
@@ -199,11 +349,34 @@ CodeGen_C::~CodeGen_C() {
 }
 
 namespace {
+// The name of the typedef for a vector type.
+string vector_type_name(Type type) {
+    internal_assert(type.is_vector());
+    user_assert(!type.is_handle()) << "Can't use vectors of handles when compiling to C\n";
+    user_assert((type.lanes() & (type.lanes() - 1)) == 0)
+        << "Can only use vector types with a power-of-two number of lanes when compiling to C. "
+        << "Got " << type << "\n";
+    ostringstream oss;
+    oss << "halide_";
+    if (type.is_bool()) {
+        oss << "bool";
+    } else if (type.is_float()) {
+        oss << "float" << type.bits();
+    } else if (type.is_uint()) {
+        oss << "uint" << type.bits();
+    } else {
+        oss << "int" << type.bits();
+    }
+    oss << "x" << type.lanes() << "_t";
+    return oss.str();
+}
+
 string type_to_c_type(Type type, bool include_space, bool c_plus_plus = true) {
     bool needs_space = true;
     ostringstream oss;
-    user_assert(type.lanes() == 1) << "Can't use vector types when compiling to C (yet)\n";
-    if (type.is_float()) {
+    if (type.is_vector()) {
+        oss << vector_type_name(type);
+    } else if (type.is_float()) {
         if (type.bits() == 32) {
             oss << "float";
         } else if (type.bits() == 64) {
@@ -358,7 +531,9 @@ class ExternCallPrototypes : public IRGraphVisitor {
     }
 
     void emit_function_decl(ostream &stream, const Call *op, const std::string &name) {
-        stream << type_to_c_type(op->type, true) << " " << name << "(";
+        // Vectorized calls to extern functions are made one lane at a
+        // time, so the prototype uses the scalar types.
+        stream << type_to_c_type(op->type.element_of(), true) << " " << name << "(";
         if (function_takes_user_context(name)) {
             stream << "void *";
             if (op->args.size()) {
@@ -372,7 +547,7 @@ class ExternCallPrototypes : public IRGraphVisitor {
             if (op->args[i].as<StringImm>()) {
                 stream << "const char *";
             } else {
-              stream << type_to_c_type(op->args[i].type(), true);
+              stream << type_to_c_type(op->args[i].type().element_of(), true);
             }
         }
         stream << ");\n";
@@ -438,6 +613,57 @@ public:
 };
 }
 
+namespace {
+// Find the vector types used by some code, along with the mask and
+// byte vector types its codegen may introduce.
+class FindVectorTypes : public IRGraphVisitor {
+    void add(Type t) {
+        types.insert({vector_type_name(t), t});
+    }
+
+public:
+    using IRGraphVisitor::include;
+    using IRGraphVisitor::visit;
+
+    void include(const Expr &e) {
+        Type t = e.type();
+        if (t.is_vector()) {
+            add(t);
+            add(Bool(t.lanes()));
+            add(UInt(8, t.lanes()));
+        }
+        IRGraphVisitor::include(e);
+    }
+
+    map<string, Type> types;
+};
+}
+
+void CodeGen_C::emit_vector_declarations(Stmt body) {
+    FindVectorTypes find;
+    body.accept(&find);
+    if (find.types.empty()) {
+        return;
+    }
+
+    // Templates can't have C linkage.
+    switch_to_c_or_c_plus_plus(COrCPlusPlus::Default);
+
+    if (!emitted.count("halide_vec_helpers")) {
+        emitted.insert("halide_vec_helpers");
+        stream << "\n" << vector_helpers;
+    }
+
+    for (const auto &i : find.types) {
+        if (emitted.count(i.first)) continue;
+        emitted.insert(i.first);
+        Type t = i.second;
+        Type elem = t.is_bool() ? Int(8) : t.element_of();
+        stream << "typedef " << type_to_c_type(elem, true) << i.first
+               << " __attribute__((vector_size(" << elem.bytes() * t.lanes() << ")));\n";
+    }
+}
+
 void CodeGen_C::compile(const Module &input) {
     for (const auto &b : input.buffers()) {
         compile(b);
@@ -496,6 +722,10 @@ void CodeGen_C::compile(const LoweredFunc &f) {
 
     // Emit prototypes for any extern calls used.
     if (!is_header()) {
+        if (use_vector_extensions()) {
+            emit_vector_declarations(f.body);
+        }
+
         stream << "\n";
         ExternCallPrototypes e(emitted, is_c_plus_plus_interface());
         f.body.accept(&e);
@@ -770,13 +1000,56 @@ void CodeGen_C::visit(const Variable *op) {
 }
 
 void CodeGen_C::visit(const Cast *op) {
+    if (op->type.is_vector() && use_vector_extensions()) {
+        Type from = op->value.type();
+        if (op->type.is_bool()) {
+            print_expr(op->value != make_zero(from));
+        } else if (from.is_bool()) {
+            // Masks are 0 or -1.
+            string mask = print_expr(op->value);
+            print_assignment(op->type, "halide_vec_convert<" + print_type(op->type) + ">(-" + mask + ")");
+        } else {
+            string value = print_expr(op->value);
+            print_assignment(op->type, "halide_vec_convert<" + print_type(op->type) + ">(" + value + ")");
+        }
+        return;
+    }
     print_assignment(op->type, "(" + print_type(op->type) + ")(" + print_expr(op->value) + ")");
 }
 
+void CodeGen_C::visit(const Ramp *op) {
+    if (!use_vector_extensions()) {
+        IRPrinter::visit(op);
+        return;
+    }
+    string base = print_expr(op->base);
+    string stride = print_expr(op->stride);
+    print_assignment(op->type, "halide_vec_ramp<" + print_type(op->type) + ", " +
+                     print_type(op->base.type()) + ">(" + base + ", " + stride + ")");
+}
+
+void CodeGen_C::visit(const Broadcast *op) {
+    if (!use_vector_extensions()) {
+        IRPrinter::visit(op);
+        return;
+    }
+    string value = print_expr(op->value);
+    if (op->type.is_bool()) {
+        value = "(int8_t)((" + value + ") ? -1 : 0)";
+    }
+    print_assignment(op->type, "halide_vec_broadcast<" + print_type(op->type) + ">(" + value + ")");
+}
+
 void CodeGen_C::visit_binop(Type t, Expr a, Expr b, const char * op) {
     string sa = print_expr(a);
     string sb = print_expr(b);
-    print_assignment(t, sa + " " + op + " " + sb);
+    if (t.is_vector() && t.is_bool() && !a.type().is_bool() && use_vector_extensions()) {
+        // Vector comparisons produce masks with lanes the width of
+        // the operands. Narrow them to our mask type.
+        print_assignment(t, "halide_vec_convert<" + print_type(t) + ">(" + sa + " " + op + " " + sb + ")");
+    } else {
+        print_assignment(t, sa + " " + op + " " + sb);
+    }
 }
 
 void CodeGen_C::visit(const Add *op) {
@@ -818,10 +1091,18 @@ void CodeGen_C::visit(const Mod *op) {
 }
 
 void CodeGen_C::visit(const Max *op) {
+    if (op->type.is_vector() && use_vector_extensions()) {
+        print_expr(Select::make(op->a > op->b, op->a, op->b));
+        return;
+    }
     print_expr(Call::make(op->type, "max", {op->a, op->b}, Call::Extern));
 }
 
 void CodeGen_C::visit(const Min *op) {
+    if (op->type.is_vector() && use_vector_extensions()) {
+        print_expr(Select::make(op->a < op->b, op->a, op->b));
+        return;
+    }
     print_expr(Call::make(op->type, "min", {op->a, op->b}, Call::Extern));
 }
 
@@ -850,14 +1131,20 @@ void CodeGen_C::visit(const GE *op) {
 }
 
 void CodeGen_C::visit(const Or *op) {
-    visit_binop(op->type, op->a, op->b, "||");
+    bool vec = op->type.is_vector() && use_vector_extensions();
+    visit_binop(op->type, op->a, op->b, vec ? "|" : "||");
 }
 
 void CodeGen_C::visit(const And *op) {
-    visit_binop(op->type, op->a, op->b, "&&");
+    bool vec = op->type.is_vector() && use_vector_extensions();
+    visit_binop(op->type, op->a, op->b, vec ? "&" : "&&");
 }
 
 void CodeGen_C::visit(const Not *op) {
+    if (op->type.is_vector() && use_vector_extensions()) {
+        print_assignment(op->type, "~(" + print_expr(op->a) + ")");
+        return;
+    }
     print_assignment(op->type, "!(" + print_expr(op->a) + ")");
 }
 
@@ -927,6 +1214,99 @@ void CodeGen_C::visit(const Call *op) {
 
     ostringstream rhs;
 
+    if (op->type.is_vector() && use_vector_extensions()) {
+        // Intrinsics that move lanes around are built one lane at a
+        // time. Each entry is an (argument, lane) pair.
+        vector<std::pair<int, int>> lanes;
+        if (op->is_intrinsic(Call::shuffle_vector)) {
+            internal_assert((int)op->args.size() == 1 + op->type.lanes());
+            for (size_t i = 1; i < op->args.size(); i++) {
+                const IntImm *idx = op->args[i].as<IntImm>();
+                internal_assert(idx);
+                // An index one past the end means the lane is undefined.
+                lanes.push_back({0, idx->value < op->args[0].type().lanes() ? (int)idx->value : 0});
+            }
+        } else if (op->is_intrinsic(Call::slice_vector)) {
+            internal_assert(op->args.size() == 4);
+            const int64_t *start = as_const_int(op->args[1]);
+            const int64_t *stride = as_const_int(op->args[2]);
+            internal_assert(start && stride) << "argument to slice_vector must be a constant.\n";
+            for (int i = 0; i < op->type.lanes(); i++) {
+                lanes.push_back({0, (int)(*start + *stride * i)});
+            }
+        } else if (op->is_intrinsic(Call::concat_vectors)) {
+            for (size_t i = 0; i < op->args.size(); i++) {
+                for (int j = 0; j < op->args[i].type().lanes(); j++) {
+                    lanes.push_back({(int)i, j});
+                }
+            }
+        } else if (op->is_intrinsic(Call::interleave_vectors)) {
+            int arg_lanes = op->args[0].type().lanes();
+            for (int j = 0; j < arg_lanes; j++) {
+                for (size_t i = 0; i < op->args.size(); i++) {
+                    lanes.push_back({(int)i, j});
+                }
+            }
+        }
+
+        bool scalarize = (op->call_type == Call::Extern ||
+                          op->call_type == Call::ExternCPlusPlus ||
+                          op->call_type == Call::PureExtern);
+
+        if (!lanes.empty() || scalarize) {
+            vector<string> args(op->args.size());
+            for (size_t i = 0; i < op->args.size(); i++) {
+                // The remaining args of slice_vector and shuffle_vector are constants.
+                if (!lanes.empty() && i > 0 &&
+                    (op->is_intrinsic(Call::shuffle_vector) || op->is_intrinsic(Call::slice_vector))) {
+                    break;
+                }
+                args[i] = print_expr(op->args[i]);
+            }
+
+            string result_id = unique_name('_');
+            do_indent();
+            stream << print_type(op->type, AppendSpace) << result_id << ";\n";
+
+            if (!lanes.empty()) {
+                internal_assert((int)lanes.size() == op->type.lanes());
+                for (size_t i = 0; i < lanes.size(); i++) {
+                    const string &arg = args[lanes[i].first];
+                    do_indent();
+                    if (op->args[lanes[i].first].type().is_vector()) {
+                        stream << result_id << "[" << i << "] = " << arg << "[" << lanes[i].second << "];\n";
+                    } else {
+                        stream << result_id << "[" << i << "] = " << arg << ";\n";
+                    }
+                }
+            } else {
+                // Call the extern function on each lane in turn.
+                string lane = unique_name('i');
+                do_indent();
+                stream << "for (int " << lane << " = 0; " << lane << " < " << op->type.lanes() << "; "
+                       << lane << "++)\n";
+                open_scope();
+                do_indent();
+                stream << result_id << "[" << lane << "] = " << op->name << "(";
+                if (function_takes_user_context(op->name)) {
+                    stream << (have_user_context ? "__user_context_" : "nullptr");
+                    if (!op->args.empty()) stream << ", ";
+                }
+                for (size_t i = 0; i < op->args.size(); i++) {
+                    if (i > 0) stream << ", ";
+                    stream << args[i];
+                    if (op->args[i].type().is_vector()) {
+                        stream << "[" << lane << "]";
+                    }
+                }
+                stream << ");\n";
+                close_scope("");
+            }
+            id = result_id;
+            return;
+        }
+    }
+
     // Handle intrinsics first
     if (op->is_intrinsic(Call::debug_to_file)) {
         internal_assert(op->args.size() == 3);
@@ -941,6 +1321,15 @@ void CodeGen_C::visit(const Call *op) {
         rhs << ", \"" + filename + "\", " + typecode;
         rhs << ", (struct buffer_t *)" << buffer;
         rhs << ")";
+    } else if (is_vector_reduce(op)) {
+        rhs << print_expr(lower_vector_reduce(op));
+    } else if ((op->is_intrinsic(Call::slice_vector) ||
+                op->is_intrinsic(Call::shuffle_vector)) &&
+               op->type.is_scalar()) {
+        // Extract a single lane.
+        const int64_t *lane = as_const_int(op->args[1]);
+        internal_assert(lane);
+        rhs << print_expr(op->args[0]) << "[" << *lane << "]";
     } else if (op->is_intrinsic(Call::bitwise_and)) {
         internal_assert(op->args.size() == 2);
         string a0 = print_expr(op->args[0]);
@@ -1009,12 +1398,17 @@ void CodeGen_C::visit(const Call *op) {
     } else if (op->is_intrinsic(Call::address_of)) {
         const Load *l = op->args[0].as<Load>();
         internal_assert(op->args.size() == 1 && l);
+        Expr index = l->index;
+        if (const Ramp *r = index.as<Ramp>()) {
+            // The address of a vector load is the address of its first lane.
+            index = r->base;
+        }
         rhs << "(("
             << print_type(l->type.element_of()) // index is in elements, not vectors.
             << " *)"
             << print_name(l->name)
             << " + "
-            << print_expr(l->index)
+            << print_expr(index)
             << ")";
     } else if (op->is_intrinsic(Call::return_second)) {
         internal_assert(op->args.size() == 2);
@@ -1023,6 +1417,8 @@ void CodeGen_C::visit(const Call *op) {
         rhs << "(" << arg0 << ", " << arg1 << ")";
     } else if (op->is_intrinsic(Call::if_then_else)) {
         internal_assert(op->args.size() == 3);
+        user_assert(op->args[0].type().is_scalar())
+            << "Can't compile an if_then_else with a vector condition to C\n";
 
         string result_id = unique_name('_');
 
@@ -1246,6 +1642,36 @@ void CodeGen_C::visit(const Call *op) {
 void CodeGen_C::visit(const Load *op) {
 
     Type t = op->type;
+
+    if (t.is_vector() && use_vector_extensions()) {
+        if (t.is_bool()) {
+            // Bools are stored as bytes.
+            Expr bytes = Load::make(UInt(8, t.lanes()), op->name, op->index, op->image, op->param, op->predicate);
+            print_expr(bytes != make_zero(bytes.type()));
+            return;
+        }
+        string ptr = print_name(op->name);
+        if (!allocations.contains(op->name) ||
+            allocations.get(op->name).type != t.element_of()) {
+            ptr = "((const " + print_type(t.element_of()) + " *)" + ptr + ")";
+        }
+        const Ramp *r = op->index.as<Ramp>();
+        if (!is_one(op->predicate)) {
+            // Masked-off lanes must not be touched, so predicated
+            // loads are always done a lane at a time.
+            string index = print_expr(op->index);
+            string mask = print_expr(op->predicate);
+            print_assignment(t, "halide_vec_masked_gather<" + print_type(t) + ">(" + ptr + ", " + index + ", " + mask + ")");
+        } else if (r && is_one(r->stride)) {
+            string base = print_expr(r->base);
+            print_assignment(t, "halide_vec_load<" + print_type(t) + ">(" + ptr + ", " + base + ")");
+        } else {
+            string index = print_expr(op->index);
+            print_assignment(t, "halide_vec_gather<" + print_type(t) + ">(" + ptr + ", " + index + ")");
+        }
+        return;
+    }
+
     bool type_cast_needed =
         !allocations.contains(op->name) ||
         allocations.get(op->name).type != t;
@@ -1264,6 +1690,12 @@ void CodeGen_C::visit(const Load *op) {
         << print_expr(op->index)
         << "]";
 
+    if (!is_one(op->predicate)) {
+        string pred = print_expr(op->predicate);
+        print_assignment(op->type, "(" + pred + " ? " + rhs.str() + " : " + print_type(op->type) + "(0))");
+        return;
+    }
+
     print_assignment(op->type, rhs.str());
 }
 
@@ -1271,6 +1703,41 @@ void CodeGen_C::visit(const Store *op) {
 
     Type t = op->value.type();
 
+    if (t.is_vector() && use_vector_extensions()) {
+        Expr value = op->value;
+        if (t.is_bool()) {
+            // Bools are stored as bytes.
+            value = Cast::make(UInt(8, t.lanes()), value);
+            t = value.type();
+        }
+        string ptr = print_name(op->name);
+        if (!allocations.contains(op->name) ||
+            allocations.get(op->name).type != t.element_of()) {
+            ptr = "((" + print_type(t.element_of()) + " *)" + ptr + ")";
+        }
+        const Ramp *r = op->index.as<Ramp>();
+        if (!is_one(op->predicate)) {
+            string id_index = print_expr(op->index);
+            string id_value = print_expr(value);
+            string id_mask = print_expr(op->predicate);
+            do_indent();
+            stream << "halide_vec_masked_scatter(" << ptr << ", " << id_index << ", "
+                   << id_value << ", " << id_mask << ");\n";
+        } else if (r && is_one(r->stride)) {
+            string base = print_expr(r->base);
+            string id_value = print_expr(value);
+            do_indent();
+            stream << "halide_vec_store(" << ptr << ", " << base << ", " << id_value << ");\n";
+        } else {
+            string id_index = print_expr(op->index);
+            string id_value = print_expr(value);
+            do_indent();
+            stream << "halide_vec_scatter(" << ptr << ", " << id_index << ", " << id_value << ");\n";
+        }
+        cache.clear();
+        return;
+    }
+
     bool type_cast_needed =
         t.is_handle() ||
         !allocations.contains(op->name) ||
@@ -1278,6 +1745,12 @@ void CodeGen_C::visit(const Store *op) {
 
     string id_index = print_expr(op->index);
     string id_value = print_expr(op->value);
+    if (!is_one(op->predicate)) {
+        string id_pred = print_expr(op->predicate);
+        do_indent();
+        stream << "if (" << id_pred << ")\n";
+        indent += 2;
+    }
     do_indent();
 
     if (type_cast_needed) {
@@ -1294,6 +1767,9 @@ void CodeGen_C::visit(const Store *op) {
            << "] = "
            << id_value
            << ";\n";
+    if (!is_one(op->predicate)) {
+        indent -= 2;
+    }
 
     cache.clear();
 }
@@ -1310,6 +1786,11 @@ void CodeGen_C::visit(const Select *op) {
     string true_val = print_expr(op->true_value);
     string false_val = print_expr(op->false_value);
     string cond = print_expr(op->condition);
+    if (op->condition.type().is_vector() && use_vector_extensions()) {
+        rhs << "halide_vec_select(" << cond << ", " << true_val << ", " << false_val << ")";
+        print_assignment(op->type, rhs.str());
+        return;
+    }
     rhs << "(" << print_type(op->type) << ")"
         << "(" << cond
         << " ? " << true_val
@@ -1353,16 +1834,37 @@ void CodeGen_C::visit(const ProducerConsumer *op) {
 }
 
 void CodeGen_C::visit(const For *op) {
+    string id_min = print_expr(op->min);
+    string id_extent = print_expr(op->extent);
+
     if (op->for_type == ForType::Parallel) {
+        // Outline the body into a lambda that captures everything
+        // by reference, and hand it to the thread pool. Errors in the
+        // body return from the lambda, and then from the function.
+        string closure = unique_name('c');
+        string result = unique_name('r');
         do_indent();
-        stream << "#pragma omp parallel for\n";
-    } else {
-        internal_assert(op->for_type == ForType::Serial)
-            << "Can only emit serial or parallel for loops to C\n";
+        stream << "auto " << closure << " = [&](int " << print_name(op->name) << ") -> int\n";
+        open_scope();
+        op->body.accept(this);
+        do_indent();
+        stream << "return 0;\n";
+        indent--;
+        do_indent();
+        stream << "};\n";
+        cache.clear();
+        do_indent();
+        stream << "int " << result << " = halide_do_par_for("
+               << (have_user_context ? "__user_context_" : "nullptr")
+               << ", halide_par_for_task<decltype(" << closure << ")>, "
+               << id_min << ", " << id_extent << ", (uint8_t *)&" << closure << ");\n";
+        do_indent();
+        stream << "if (" << result << ") return " << result << ";\n";
+        return;
     }
 
-    string id_min = print_expr(op->min);
-    string id_extent = print_expr(op->extent);
+    internal_assert(op->for_type == ForType::Serial)
+        << "Can only emit serial or parallel for loops to C\n";
 
     do_indent();
     stream << "for (int "
@@ -139,6 +139,15 @@ protected:
 
     void switch_to_c_or_c_plus_plus(COrCPlusPlus mode);
 
+    /** Whether vector types are emitted as GCC/Clang vector
+     * extensions. Subclasses that target languages with their own
+     * vector types (e.g. OpenCL C) turn this off. */
+    virtual bool use_vector_extensions() const { return true; }
+
+    /** Emit the typedefs and helper functions for the vector types
+     * used in a function body. */
+    void emit_vector_declarations(Stmt body);
+
     using IRPrinter::visit;
 
     void visit(const Variable *);
@@ -147,6 +156,8 @@ protected:
     void visit(const StringImm *);
     void visit(const FloatImm *);
     void visit(const Cast *);
+    void visit(const Ramp *);
+    void visit(const Broadcast *);
     void visit(const Add *);
     void visit(const Sub *);
     void visit(const Mul *);
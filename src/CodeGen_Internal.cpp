@@ -131,6 +131,7 @@ bool function_takes_user_context(const std::string &name) {
         "halide_error",
         "halide_free",
         "halide_malloc",
+        "halide_param_profile_record",
         "halide_print",
         "halide_profiler_memory_allocate",
         "halide_profiler_memory_free",
@@ -239,6 +240,65 @@ Expr lower_euclidean_mod(Expr a, Expr b) {
     }
 }
 
+bool is_vector_reduce(const Call *op) {
+    return (op->is_intrinsic(Call::vector_reduce_add) ||
+            op->is_intrinsic(Call::vector_reduce_mul) ||
+            op->is_intrinsic(Call::vector_reduce_min) ||
+            op->is_intrinsic(Call::vector_reduce_max) ||
+            op->is_intrinsic(Call::vector_reduce_and) ||
+            op->is_intrinsic(Call::vector_reduce_or));
+}
+
+Expr lower_vector_reduce(const Call *op) {
+    internal_assert(is_vector_reduce(op) && op->args.size() == 1);
+
+    auto combine = [&](Expr a, Expr b) {
+        if (op->is_intrinsic(Call::vector_reduce_add)) {
+            return a + b;
+        } else if (op->is_intrinsic(Call::vector_reduce_mul)) {
+            return a * b;
+        } else if (op->is_intrinsic(Call::vector_reduce_min)) {
+            return min(a, b);
+        } else if (op->is_intrinsic(Call::vector_reduce_max)) {
+            return max(a, b);
+        } else if (op->is_intrinsic(Call::vector_reduce_and)) {
+            return a && b;
+        } else {
+            return a || b;
+        }
+    };
+
+    auto slice = [](Expr v, int start, int lanes) {
+        return Call::make(v.type().with_lanes(lanes), Call::slice_vector,
+                          {v, start, 1, lanes}, Call::PureIntrinsic);
+    };
+
+    // Each vector is used twice, so bind them all to names.
+    vector<pair<string, Expr>> lets;
+    Expr v = op->args[0];
+    Expr leftover;
+    while (v.type().lanes() > 1) {
+        string name = unique_name('t');
+        lets.push_back({name, v});
+        Expr var = Variable::make(v.type(), name);
+        int lanes = v.type().lanes();
+        int half = lanes / 2;
+        if (lanes % 2) {
+            // Fold the odd lane out separately.
+            Expr last = slice(var, lanes - 1, 1);
+            leftover = leftover.defined() ? combine(leftover, last) : last;
+        }
+        v = combine(slice(var, 0, half), slice(var, half, half));
+    }
+    if (leftover.defined()) {
+        v = combine(v, leftover);
+    }
+    for (size_t i = lets.size(); i > 0; i--) {
+        v = Let::make(lets[i-1].first, lets[i-1].second, v);
+    }
+    return v;
+}
+
 bool get_md_bool(llvm::Metadata *value, bool &result) {
     if (!value) {
         return false;
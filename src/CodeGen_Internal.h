@@ -58,6 +58,15 @@ Expr lower_euclidean_div(Expr a, Expr b);
 Expr lower_euclidean_mod(Expr a, Expr b);
 ///@}
 
+/** Check if a call is to one of the vector_reduce intrinsics, which
+ * combine all the lanes of a vector into a scalar. */
+bool is_vector_reduce(const Call *op);
+
+/** Given a call to one of the vector_reduce intrinsics, define it in
+ * terms of slice_vector and the corresponding elementwise operation,
+ * by repeatedly combining the two halves of the vector. */
+Expr lower_vector_reduce(const Call *op);
+
 /** Given an llvm::Module, set llvm:TargetOptions, cpu and attr information */
 void get_target_options(const llvm::Module &module, llvm::TargetOptions &options, std::string &mcpu, std::string &mattrs);
 
@@ -18,6 +18,7 @@
 #include "MatlabWrapper.h"
 #include "IntegerDivisionTable.h"
 #include "CSE.h"
+#include "FindIntrinsics.h"
 
 #include "CodeGen_X86.h"
 #include "CodeGen_GPU_Host.h"
@@ -1736,7 +1737,13 @@ void CodeGen_LLVM::visit(const Load *op) {
 
     // If it's a Handle, load it as a uint64_t and then cast
     if (op->type.is_handle()) {
-        codegen(reinterpret(op->type, Load::make(UInt(64, op->type.lanes()), op->name, op->index, op->image, op->param)));
+        codegen(reinterpret(op->type, Load::make(UInt(64, op->type.lanes()), op->name, op->index,
+                                                 op->image, op->param, op->predicate)));
+        return;
+    }
+
+    if (!is_one(op->predicate)) {
+        codegen_predicated_load(op);
         return;
     }
 
@@ -1892,16 +1899,7 @@ void CodeGen_LLVM::visit(const Load *op) {
             value = vec;
         } else {
             // General gathers
-            Value *index = codegen(op->index);
-            Value *vec = UndefValue::get(llvm_type_of(op->type));
-            for (int i = 0; i < op->type.lanes(); i++) {
-                Value *idx = builder->CreateExtractElement(index, ConstantInt::get(i32_t, i));
-                Value *ptr = codegen_buffer_pointer(op->name, op->type.element_of(), idx);
-                LoadInst *val = builder->CreateLoad(ptr);
-                add_tbaa_metadata(val, op->name, op->index);
-                vec = builder->CreateInsertElement(vec, val, ConstantInt::get(i32_t, i));
-            }
-            value = vec;
+            codegen_gather(op);
         }
     }
 
@@ -2056,7 +2054,15 @@ void CodeGen_LLVM::visit(const Call *op) {
     // cue for llvm to generate particular ops. In general these are
     // handled in the standard library, but ones with e.g. varying
     // types are handled here.
-    if (op->is_intrinsic(Call::shuffle_vector)) {
+    if (is_vector_reduce(op)) {
+        codegen_vector_reduce(op);
+    } else if (op->is_intrinsic("dynamic_shuffle")) {
+        codegen_dynamic_shuffle(op);
+    } else if (is_fixed_point_intrinsic(op)) {
+        // Targets map the ones they have instructions for. The rest
+        // are lowered back to the arithmetic they came from.
+        value = codegen(lower_fixed_point_intrinsic(op));
+    } else if (op->is_intrinsic(Call::shuffle_vector)) {
         internal_assert((int) op->args.size() == 1 + op->type.lanes());
         vector<int> indices(op->type.lanes());
         for (size_t i = 0; i < indices.size(); i++) {
@@ -3271,7 +3277,12 @@ void CodeGen_LLVM::visit(const Store *op) {
     // memory, so convert stores of handles to stores of uint64_ts.
     if (op->value.type().is_handle()) {
         Expr v = reinterpret(UInt(64, op->value.type().lanes()), op->value);
-        codegen(Store::make(op->name, v, op->index, op->param));
+        codegen(Store::make(op->name, v, op->index, op->param, op->predicate));
+        return;
+    }
+
+    if (!is_one(op->predicate)) {
+        codegen_predicated_store(op);
         return;
     }
 
@@ -3284,7 +3295,7 @@ void CodeGen_LLVM::visit(const Store *op) {
         StoreInst *store = builder->CreateAlignedStore(val, ptr, value_type.bytes());
         add_tbaa_metadata(store, op->name, op->index);
     } else if (const Let *let = op->index.as<Let>()) {
-        Stmt s = Store::make(op->name, op->value, let->body, op->param);
+        Stmt s = Store::make(op->name, op->value, let->body, op->param, op->predicate);
         codegen(LetStmt::make(let->name, let->value, s));
     } else {
         int alignment = value_type.bytes();
@@ -3370,6 +3381,116 @@ void CodeGen_LLVM::visit(const Store *op) {
 }
 
 
+void CodeGen_LLVM::codegen_predicated_load(const Load *op) {
+    const Ramp *ramp = op->index.as<Ramp>();
+    if (ramp && is_one(ramp->stride)) {
+        Value *elt_ptr = codegen_buffer_pointer(op->name, op->type.element_of(), ramp->base);
+        Value *vec_ptr = builder->CreatePointerCast(elt_ptr, llvm_type_of(op->type)->getPointerTo());
+        Value *mask = codegen(op->predicate);
+        Instruction *load = builder->CreateMaskedLoad(vec_ptr, op->type.bytes(), mask);
+        add_tbaa_metadata(load, op->name, op->index);
+        value = load;
+        return;
+    }
+
+    int lanes = op->type.lanes();
+    Value *predicate = codegen(op->predicate);
+    Value *index = codegen(op->index);
+    Value *result = UndefValue::get(llvm_type_of(op->type));
+    for (int i = 0; i < lanes; i++) {
+        Value *lane = ConstantInt::get(i32_t, i);
+        Value *p = lanes > 1 ? builder->CreateExtractElement(predicate, lane) : predicate;
+
+        BasicBlock *before_bb = builder->GetInsertBlock();
+        BasicBlock *load_bb = BasicBlock::Create(*context, "predicated_load", function);
+        BasicBlock *after_bb = BasicBlock::Create(*context, "after_predicated_load", function);
+        builder->CreateCondBr(p, load_bb, after_bb);
+
+        builder->SetInsertPoint(load_bb);
+        Value *idx = lanes > 1 ? builder->CreateExtractElement(index, lane) : index;
+        Value *ptr = codegen_buffer_pointer(op->name, op->type.element_of(), idx);
+        LoadInst *val = builder->CreateLoad(ptr);
+        add_tbaa_metadata(val, op->name, op->index);
+        Value *loaded = lanes > 1 ? builder->CreateInsertElement(result, val, lane) : val;
+        load_bb = builder->GetInsertBlock();
+        builder->CreateBr(after_bb);
+
+        builder->SetInsertPoint(after_bb);
+        PHINode *phi = builder->CreatePHI(result->getType(), 2);
+        phi->addIncoming(loaded, load_bb);
+        phi->addIncoming(result, before_bb);
+        result = phi;
+    }
+    value = result;
+}
+
+void CodeGen_LLVM::codegen_predicated_store(const Store *op) {
+    Halide::Type value_type = op->value.type();
+    Value *val = codegen(op->value);
+    const Ramp *ramp = op->index.as<Ramp>();
+    if (ramp && is_one(ramp->stride)) {
+        Value *elt_ptr = codegen_buffer_pointer(op->name, value_type.element_of(), ramp->base);
+        Value *vec_ptr = builder->CreatePointerCast(elt_ptr, val->getType()->getPointerTo());
+        Value *mask = codegen(op->predicate);
+        Instruction *store = builder->CreateMaskedStore(val, vec_ptr, value_type.bytes(), mask);
+        add_tbaa_metadata(store, op->name, op->index);
+        return;
+    }
+
+    int lanes = value_type.lanes();
+    Value *predicate = codegen(op->predicate);
+    Value *index = codegen(op->index);
+    for (int i = 0; i < lanes; i++) {
+        Value *lane = ConstantInt::get(i32_t, i);
+        Value *p = lanes > 1 ? builder->CreateExtractElement(predicate, lane) : predicate;
+
+        BasicBlock *store_bb = BasicBlock::Create(*context, "predicated_store", function);
+        BasicBlock *after_bb = BasicBlock::Create(*context, "after_predicated_store", function);
+        builder->CreateCondBr(p, store_bb, after_bb);
+
+        builder->SetInsertPoint(store_bb);
+        Value *idx = lanes > 1 ? builder->CreateExtractElement(index, lane) : index;
+        Value *v = lanes > 1 ? builder->CreateExtractElement(val, lane) : val;
+        Value *ptr = codegen_buffer_pointer(op->name, value_type.element_of(), idx);
+        StoreInst *store = builder->CreateStore(v, ptr);
+        add_tbaa_metadata(store, op->name, op->index);
+        builder->CreateBr(after_bb);
+
+        builder->SetInsertPoint(after_bb);
+    }
+}
+
+void CodeGen_LLVM::codegen_vector_reduce(const Call *op) {
+    value = codegen(lower_vector_reduce(op));
+}
+
+void CodeGen_LLVM::codegen_gather(const Load *op) {
+    Value *index = codegen(op->index);
+    Value *vec = UndefValue::get(llvm_type_of(op->type));
+    for (int i = 0; i < op->type.lanes(); i++) {
+        Value *idx = builder->CreateExtractElement(index, ConstantInt::get(i32_t, i));
+        Value *ptr = codegen_buffer_pointer(op->name, op->type.element_of(), idx);
+        LoadInst *val = builder->CreateLoad(ptr);
+        add_tbaa_metadata(val, op->name, op->index);
+        vec = builder->CreateInsertElement(vec, val, ConstantInt::get(i32_t, i));
+    }
+    value = vec;
+}
+
+void CodeGen_LLVM::codegen_dynamic_shuffle(const Call *op) {
+    internal_assert(op->args.size() == 4);
+    Value *lut = codegen(op->args[0]);
+    Value *index = codegen(op->args[1]);
+    Value *vec = UndefValue::get(llvm_type_of(op->type));
+    for (int i = 0; i < op->type.lanes(); i++) {
+        Value *lane = ConstantInt::get(i32_t, i);
+        Value *idx = builder->CreateExtractElement(index, lane);
+        idx = builder->CreateZExt(idx, i32_t);
+        vec = builder->CreateInsertElement(vec, builder->CreateExtractElement(lut, idx), lane);
+    }
+    value = vec;
+}
+
 void CodeGen_LLVM::visit(const Block *op) {
     codegen(op->first);
     if (op->rest.defined()) codegen(op->rest);
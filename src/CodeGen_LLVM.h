@@ -309,6 +309,35 @@ protected:
      * different buffers */
     void add_tbaa_metadata(llvm::Instruction *inst, std::string buffer, Expr index);
 
+    /** Generate code for loads and stores with a predicate that isn't
+     * known to be true. Dense vectors use llvm's masked load and
+     * store intrinsics, which llvm lowers to the target's masked
+     * instructions where they exist (e.g. AVX2, AVX-512), and to
+     * blends or branches elsewhere. Everything else is done a lane
+     * at a time under a branch on that lane of the predicate. */
+    // @{
+    virtual void codegen_predicated_load(const Load *op);
+    virtual void codegen_predicated_store(const Store *op);
+    // @}
+
+    /** Generate code for a call to one of the vector_reduce
+     * intrinsics. By default this combines halves of the vector
+     * until one lane remains. Targets with horizontal instructions
+     * override it. */
+    virtual void codegen_vector_reduce(const Call *op);
+
+    /** Generate code for a vector load with an index that isn't a
+     * ramp, such as a lookup into a table. By default each lane is
+     * loaded separately and inserted into the vector. Targets with
+     * gather instructions override it. */
+    virtual void codegen_gather(const Load *op);
+
+    /** Generate code for a call to the dynamic_shuffle intrinsic,
+     * which looks up a vector of uint8 indices in a small table held
+     * in a vector. By default each lane is extracted
+     * separately. Targets with byte shuffles override it. */
+    virtual void codegen_dynamic_shuffle(const Call *op);
+
     /** Get a unique name for the actual block of memory that an
      * allocate node uses. Used so that alias analysis understands
      * when multiple Allocate nodes shared the same memory. */
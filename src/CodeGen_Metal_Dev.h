@@ -62,6 +62,7 @@ protected:
         std::string print_storage_type(Type type);
         std::string print_type_maybe_storage(Type type, bool storage, AppendSpaceIfNeeded space);
         std::string print_reinterpret(Type type, Expr e);
+        bool use_vector_extensions() const { return false; }
 
         std::string get_memory_space(const std::string &);
 
@@ -53,6 +53,7 @@ protected:
         using CodeGen_C::visit;
         std::string print_type(Type type, AppendSpaceIfNeeded append_space = DoNotAppendSpace);
         std::string print_reinterpret(Type type, Expr e);
+        bool use_vector_extensions() const { return false; }
 
         std::string get_memory_space(const std::string &);
 
@@ -59,6 +59,8 @@ public:
 
 protected:
     using CodeGen_C::visit;
+    bool use_vector_extensions() const { return false; }
+
     void visit(const Max *op);
     void visit(const Min *op);
     void visit(const Div *op);
@@ -11,6 +11,8 @@
 #include "Param.h"
 #include "LLVM_Headers.h"
 #include "IRMutator.h"
+#include "OptimizeShuffles.h"
+#include "FindIntrinsics.h"
 
 namespace Halide {
 namespace Internal {
@@ -43,20 +45,13 @@ bool should_use_pmaddwd(Expr a, Expr b, vector<Expr> &result) {
     Type t = a.type();
     internal_assert(b.type() == t);
 
-    const Mul *ma = a.as<Mul>();
-    const Mul *mb = b.as<Mul>();
-
-    if (!(ma && mb && t.is_int() && t.bits() == 32 && (t.lanes() >= 4))) {
+    if (!(t.is_int() && t.bits() == 32 && (t.lanes() >= 4))) {
         return false;
     }
 
-    Type narrow = t.with_bits(16);
-    vector<Expr> args = {lossless_cast(narrow, ma->a),
-                         lossless_cast(narrow, ma->b),
-                         lossless_cast(narrow, mb->a),
-                         lossless_cast(narrow, mb->b)};
-    if (!args[0].defined() || !args[1].defined() ||
-        !args[2].defined() || !args[3].defined()) {
+    vector<Expr> args(4);
+    if (!match_widening_mul(a, args[0], args[1]) ||
+        !match_widening_mul(b, args[2], args[3])) {
         return false;
     }
 
@@ -205,6 +200,31 @@ void CodeGen_X86::visit(const Select *op) {
 
 void CodeGen_X86::visit(const Cast *op) {
 
+    Type src = op->value.type().element_of(), dst = op->type.element_of();
+    if (target.has_feature(Target::F16C) &&
+        ((src == Float(16) && dst == Float(32)) ||
+         (src == Float(32) && dst == Float(16)))) {
+        // Use vcvtph2ps and vcvtps2ph, eight lanes at a time. Scalars
+        // are converted in the first lane of a vector.
+        Expr arg = op->value;
+        if (arg.type().is_scalar()) {
+            arg = Broadcast::make(arg, 8);
+        }
+        int lanes = arg.type().lanes();
+        if (src == Float(16)) {
+            value = call_intrin(Float(32, lanes), 8, "llvm.x86.vcvtph2ps.256",
+                                {reinterpret(UInt(16, lanes), arg)});
+        } else {
+            // An immediate of zero rounds to nearest, ties to even.
+            value = call_intrin(UInt(16, lanes), 8, "llvm.x86.vcvtps2ph.256", {arg, 0});
+            value = builder->CreateBitCast(value, llvm_type_of(Float(16, lanes)));
+        }
+        if (op->type.is_scalar()) {
+            value = builder->CreateExtractElement(value, ConstantInt::get(i32_t, 0));
+        }
+        return;
+    }
+
     if (!op->type.is_vector()) {
         // We only have peephole optimizations for vectors in here.
         CodeGen_Posix::visit(op);
@@ -386,13 +406,236 @@ void CodeGen_X86::visit(const Max *op) {
     }
 }
 
+void CodeGen_X86::codegen_vector_reduce(const Call *op) {
+    Expr arg = op->args[0];
+    int lanes = arg.type().lanes();
+    const Cast *cast = arg.as<Cast>();
+    if (op->is_intrinsic(Call::vector_reduce_add) &&
+        cast &&
+        cast->value.type().element_of() == UInt(8) &&
+        (op->type.is_int() || op->type.is_uint()) &&
+        op->type.bits() >= 16 &&
+        lanes % 16 == 0) {
+        // A sum of widened bytes. psadbw against zero sums each
+        // group of eight bytes into a 64-bit lane.
+        Value *bytes = codegen(cast->value);
+        Value *zero = Constant::getNullValue(llvm_type_of(UInt(8, 16)));
+        Value *sum = nullptr;
+        for (int i = 0; i < lanes; i += 16) {
+            Value *sad = call_intrin(llvm_type_of(UInt(64, 2)), 2, "llvm.x86.sse2.psad.bw",
+                                     {slice_vector(bytes, i, 16), zero});
+            sum = sum ? builder->CreateAdd(sum, sad) : sad;
+        }
+        sum = builder->CreateAdd(builder->CreateExtractElement(sum, ConstantInt::get(i32_t, 0)),
+                                 builder->CreateExtractElement(sum, ConstantInt::get(i32_t, 1)));
+        value = builder->CreateIntCast(sum, llvm_type_of(op->type), false);
+    } else if (op->is_intrinsic(Call::vector_reduce_add) &&
+               target.has_feature(Target::SSE41) &&
+               (op->type == Int(32) || op->type == UInt(32)) &&
+               lanes >= 4 &&
+               (lanes & (lanes - 1)) == 0) {
+        // Add halves down to a single sse vector, then finish with
+        // two phaddds.
+        Value *v = codegen(arg);
+        while (lanes > 4) {
+            lanes /= 2;
+            v = builder->CreateAdd(slice_vector(v, 0, lanes), slice_vector(v, lanes, lanes));
+        }
+        for (int i = 0; i < 2; i++) {
+            v = call_intrin(llvm_type_of(Int(32, 4)), 4, "llvm.x86.ssse3.phadd.d.128", {v, v});
+        }
+        value = builder->CreateExtractElement(v, ConstantInt::get(i32_t, 0));
+    } else {
+        CodeGen_Posix::codegen_vector_reduce(op);
+    }
+}
+
+void CodeGen_X86::compile_func(const LoweredFunc &f,
+                               const string &simple_name, const string &extern_name) {
+    LoweredFunc func = f;
+    if (target.has_feature(Target::SSE41)) {
+        debug(1) << "Optimizing shuffles...\n";
+        // pshufb looks up 16 bytes at a time, and two of them
+        // blended together cover 32. We can't read past the end of
+        // the table, so there is no alignment slop.
+        func.body = optimize_shuffles(func.body, 0, 32, 8);
+        debug(2) << "Lowering after optimizing shuffles:\n" << func.body << "\n\n";
+    }
+
+    debug(1) << "Finding fixed-point intrinsics...\n";
+    func.body = find_intrinsics(func.body);
+    debug(2) << "Lowering after finding fixed-point intrinsics:\n" << func.body << "\n\n";
+
+    CodeGen_Posix::compile_func(func, simple_name, extern_name);
+}
+
+void CodeGen_X86::codegen_gather(const Load *op) {
+    // vpgatherdd and friends only win over scalar loads when they
+    // fill a whole ymm register. Narrower gathers, and gathers of
+    // bytes and shorts, are left to the scalar loads.
+    Type t = op->type;
+    int intrin_lanes = 256 / std::max(t.bits(), 1);
+    if (!target.has_feature(Target::AVX2) ||
+        !(t.bits() == 32 || t.bits() == 64) ||
+        op->index.type().element_of() != Int(32) ||
+        t.lanes() % intrin_lanes != 0) {
+        CodeGen_Posix::codegen_gather(op);
+        return;
+    }
+
+    string name = "llvm.x86.avx2.gather.d.";
+    if (t.is_float()) {
+        name += t.bits() == 32 ? "ps" : "pd";
+    } else {
+        name += t.bits() == 32 ? "d" : "q";
+    }
+    name += ".256";
+
+    llvm::Type *slice_t = llvm_type_of(t.with_lanes(intrin_lanes));
+    llvm::Type *index_t = llvm_type_of(Int(32, intrin_lanes));
+    llvm::Type *ptr_t = i8_t->getPointerTo();
+    llvm::Function *fn = module->getFunction(name);
+    if (!fn) {
+        FunctionType *fn_t = FunctionType::get(slice_t, {slice_t, ptr_t, index_t, slice_t, i8_t}, false);
+        fn = llvm::Function::Create(fn_t, llvm::Function::ExternalLinkage, name, module.get());
+    }
+
+    Value *base = codegen_buffer_pointer(op->name, t.element_of(), make_zero(Int(32)));
+    base = builder->CreatePointerCast(base, ptr_t);
+    Value *index = codegen(op->index);
+    // Gather every lane, with the index scaled by the element size.
+    Value *src = UndefValue::get(slice_t);
+    Value *mask = Constant::getAllOnesValue(slice_t);
+    Value *scale = ConstantInt::get(i8_t, t.bytes());
+
+    vector<Value *> slices;
+    for (int i = 0; i < t.lanes(); i += intrin_lanes) {
+        Value *args[] = {src, base, slice_vector(index, i, intrin_lanes), mask, scale};
+        CallInst *gather = builder->CreateCall(fn, args);
+        gather->setOnlyReadsMemory();
+        gather->setDoesNotThrow();
+        slices.push_back(gather);
+    }
+    value = concat_vectors(slices);
+}
+
+void CodeGen_X86::codegen_dynamic_shuffle(const Call *op) {
+    internal_assert(op->args.size() == 4);
+    int lut_lanes = op->args[0].type().lanes();
+    if (!target.has_feature(Target::SSE41) ||
+        op->type.bits() != 8 ||
+        lut_lanes > 32) {
+        CodeGen_Posix::codegen_dynamic_shuffle(op);
+        return;
+    }
+
+    // pshufb uses the low four bits of each index, so the same
+    // indices can be used on both halves of a 32 byte table, and then
+    // the right result selected.
+    Value *lut = codegen(op->args[0]);
+    Value *index = codegen(op->args[1]);
+    Value *lo = slice_vector(lut, 0, 16);
+    Value *hi = lut_lanes > 16 ? slice_vector(lut, 16, 16) : nullptr;
+
+    int lanes = op->type.lanes();
+    int padded_lanes = ((lanes + 15) / 16) * 16;
+    index = slice_vector(index, 0, padded_lanes);
+    llvm::Type *slice_t = llvm_type_of(op->type.with_lanes(16));
+    Value *sixteen = ConstantVector::getSplat(16, ConstantInt::get(i8_t, 16));
+
+    vector<Value *> slices;
+    for (int i = 0; i < padded_lanes; i += 16) {
+        Value *idx = slice_vector(index, i, 16);
+        Value *result = call_intrin(slice_t, 16, "llvm.x86.ssse3.pshuf.b.128", {lo, idx});
+        if (hi) {
+            Value *from_hi = call_intrin(slice_t, 16, "llvm.x86.ssse3.pshuf.b.128", {hi, idx});
+            result = builder->CreateSelect(builder->CreateICmpULT(idx, sixteen), result, from_hi);
+        }
+        slices.push_back(result);
+    }
+    value = slice_vector(concat_vectors(slices), 0, lanes);
+}
+
+void CodeGen_X86::codegen_fixed_point_intrinsic(const Call *op) {
+    struct Mapping {
+        Call::ConstString intrin;
+        Target::Feature feature;
+        Type arg_type;
+        Type type;
+        int min_lanes;
+        string instr;
+    };
+
+    static Mapping mappings[] = {
+        {Call::rounding_halving_add, Target::FeatureEnd, UInt(8), UInt(8, 16), 0, "llvm.x86.sse2.pavg.b"},
+        {Call::rounding_halving_add, Target::FeatureEnd, UInt(16), UInt(16, 8), 0, "llvm.x86.sse2.pavg.w"},
+        {Call::saturating_add, Target::FeatureEnd, Int(8), Int(8, 16), 0, "llvm.x86.sse2.padds.b"},
+        {Call::saturating_add, Target::FeatureEnd, UInt(8), UInt(8, 16), 0, "llvm.x86.sse2.paddus.b"},
+        {Call::saturating_add, Target::FeatureEnd, Int(16), Int(16, 8), 0, "llvm.x86.sse2.padds.w"},
+        {Call::saturating_add, Target::FeatureEnd, UInt(16), UInt(16, 8), 0, "llvm.x86.sse2.paddus.w"},
+        {Call::saturating_sub, Target::FeatureEnd, Int(8), Int(8, 16), 0, "llvm.x86.sse2.psubs.b"},
+        {Call::saturating_sub, Target::FeatureEnd, UInt(8), UInt(8, 16), 0, "llvm.x86.sse2.psubus.b"},
+        {Call::saturating_sub, Target::FeatureEnd, Int(16), Int(16, 8), 0, "llvm.x86.sse2.psubs.w"},
+        {Call::saturating_sub, Target::FeatureEnd, UInt(16), UInt(16, 8), 0, "llvm.x86.sse2.psubus.w"},
+
+        // Only use the avx2 version if we have > 8 lanes
+        {Call::mul_shift_right, Target::AVX2, Int(16), Int(16, 16), 9, "llvm.x86.avx2.pmulh.w"},
+        {Call::mul_shift_right, Target::AVX2, UInt(16), UInt(16, 16), 9, "llvm.x86.avx2.pmulhu.w"},
+        {Call::mul_shift_right, Target::FeatureEnd, Int(16), Int(16, 8), 0, "llvm.x86.sse2.pmulh.w"},
+        {Call::mul_shift_right, Target::FeatureEnd, UInt(16), UInt(16, 8), 0, "llvm.x86.sse2.pmulhu.w"},
+
+        // The packs treat their input as signed.
+        {Call::saturating_narrow, Target::FeatureEnd, Int(32), Int(16, 8), 0, "packssdwx8"},
+        {Call::saturating_narrow, Target::FeatureEnd, Int(16), Int(8, 16), 0, "packsswbx16"},
+        {Call::saturating_narrow, Target::FeatureEnd, Int(16), UInt(8, 16), 0, "packuswbx16"},
+        {Call::saturating_narrow, Target::SSE41, Int(32), UInt(16, 8), 0, "packusdwx8"},
+    };
+
+    string intrin = op->name;
+    vector<Expr> args = op->args;
+    if (op->is_intrinsic(Call::mul_shift_right)) {
+        // pmulh keeps exactly the high half.
+        if (is_const(args[2], 16)) {
+            args.pop_back();
+        } else {
+            intrin.clear();
+        }
+    } else if (op->is_intrinsic(Call::rounding_shift_right)) {
+        // A rounding shift right by one is an average with zero.
+        if (is_one(args[1])) {
+            intrin = Call::rounding_halving_add;
+            args[1] = make_zero(args[0].type());
+        } else {
+            intrin.clear();
+        }
+    }
+
+    if (op->type.is_vector()) {
+        for (const Mapping &m : mappings) {
+            if (intrin != m.intrin ||
+                !target.has_feature(m.feature) ||
+                args[0].type().element_of() != m.arg_type ||
+                op->type.element_of() != m.type.element_of() ||
+                op->type.lanes() < m.min_lanes) {
+                continue;
+            }
+            value = call_intrin(op->type, m.type.lanes(), m.instr, args);
+            return;
+        }
+    }
+
+    CodeGen_Posix::visit(op);
+}
+
 void CodeGen_X86::visit(const Call *op) {
-    if (target.has_feature(Target::AVX2) &&
-        op->is_intrinsic(Call::shift_left) &&
-        op->type.is_vector() &&
-        op->type.is_int() &&
-        op->type.bits() < 32 &&
-        !is_positive_const(op->args[0])) {
+    if (is_fixed_point_intrinsic(op)) {
+        codegen_fixed_point_intrinsic(op);
+    } else if (target.has_feature(Target::AVX2) &&
+               op->is_intrinsic(Call::shift_left) &&
+               op->type.is_vector() &&
+               op->type.is_int() &&
+               op->type.bits() < 32 &&
+               !is_positive_const(op->args[0])) {
 
         // Left shift of negative integers is broken in some cases in
         // avx2: https://llvm.org/bugs/show_bug.cgi?id=27730
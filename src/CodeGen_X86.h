@@ -49,6 +49,25 @@ protected:
     void visit(const NE *);
     void visit(const Select *);
     // @}
+
+    /** Replace loads from small byte lookup tables with pshufb
+     * before generating code. */
+    void compile_func(const LoweredFunc &f,
+                      const std::string &simple_name, const std::string &extern_name);
+
+    /** Use psadbw and phaddd for horizontal sums. */
+    void codegen_vector_reduce(const Call *);
+
+    /** Use the avx2 gather instructions where they beat scalar
+     * loads. */
+    void codegen_gather(const Load *);
+
+    /** Use pshufb for lookups in tables of up to 32 bytes. */
+    void codegen_dynamic_shuffle(const Call *);
+
+    /** Map the intrinsics found by find_intrinsics to sse and avx
+     * instructions. */
+    void codegen_fixed_point_intrinsic(const Call *);
 };
 
 }}
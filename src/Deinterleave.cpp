@@ -1,4 +1,5 @@
 #include "Deinterleave.h"
+#include "CodeGen_GPU_Dev.h"
 #include "Debug.h"
 #include "IRMutator.h"
 #include "IROperator.h"
@@ -7,12 +8,16 @@
 #include "ModulusRemainder.h"
 #include "Scope.h"
 #include "Simplify.h"
+#include "Substitute.h"
 
 namespace Halide {
 namespace Internal {
 
 using std::pair;
 using std::make_pair;
+using std::map;
+using std::string;
+using std::vector;
 
 class StoreCollector : public IRMutator {
 public:
@@ -143,6 +148,16 @@ Stmt collect_strided_stores(Stmt stmt, const std::string& name, int stride, int
 }
 
 
+// The suffix of the name of the let holding the lanes of a vector let
+// congruent to starting_lane modulo lane_stride.
+std::string lanes_suffix(int starting_lane, int lane_stride) {
+    if (lane_stride == 2) {
+        return starting_lane == 0 ? ".even_lanes" : ".odd_lanes";
+    } else {
+        return ".lanes_" + std::to_string(starting_lane) + "_of_" + std::to_string(lane_stride);
+    }
+}
+
 class Deinterleaver : public IRMutator {
 public:
     int starting_lane;
@@ -172,7 +187,7 @@ private:
             expr = op;
         } else {
             Type t = op->type.with_lanes(new_lanes);
-            expr = Load::make(t, op->name, mutate(op->index), op->image, op->param);
+            expr = Load::make(t, op->name, mutate(op->index), op->image, op->param, mutate(op->predicate));
         }
     }
 
@@ -193,25 +208,11 @@ private:
             if (internal.contains(op->name)) {
                 expr = internal.get(op->name);
             } else if (external_lets.contains(op->name) &&
-                       starting_lane == 0 &&
-                       lane_stride == 2) {
-                expr = Variable::make(t, op->name + ".even_lanes", op->image, op->param, op->reduction_domain);
-            } else if (external_lets.contains(op->name) &&
-                       starting_lane == 1 &&
-                       lane_stride == 2) {
-                expr = Variable::make(t, op->name + ".odd_lanes", op->image, op->param, op->reduction_domain);
-            } else if (external_lets.contains(op->name) &&
-                       starting_lane == 0 &&
-                       lane_stride == 3) {
-                expr = Variable::make(t, op->name + ".lanes_0_of_3", op->image, op->param, op->reduction_domain);
-            } else if (external_lets.contains(op->name) &&
-                       starting_lane == 1 &&
-                       lane_stride == 3) {
-                expr = Variable::make(t, op->name + ".lanes_1_of_3", op->image, op->param, op->reduction_domain);
-            } else if (external_lets.contains(op->name) &&
-                       starting_lane == 2 &&
-                       lane_stride == 3) {
-                expr = Variable::make(t, op->name + ".lanes_2_of_3", op->image, op->param, op->reduction_domain);
+                       (lane_stride == 2 || lane_stride == 3)) {
+                // The Interleaver defines lets holding the lanes of
+                // each vector let mod 2 and mod 3.
+                expr = Variable::make(t, op->name + lanes_suffix(starting_lane, lane_stride),
+                                      op->image, op->param, op->reduction_domain);
             } else {
                 // Uh-oh, we don't know how to deinterleave this vector expression
                 // Make llvm do it
@@ -320,24 +321,23 @@ private:
     }
 };
 
-Expr extract_odd_lanes(Expr e, const Scope<int> &lets) {
-    internal_assert(e.type().lanes() % 2 == 0);
+Expr extract_strided_lanes(Expr e, int starting_lane, int lane_stride, const Scope<int> &lets) {
+    internal_assert(e.type().lanes() % lane_stride == 0);
+    internal_assert(starting_lane >= 0 && starting_lane < lane_stride);
     Deinterleaver d(lets);
-    d.starting_lane = 1;
-    d.lane_stride = 2;
-    d.new_lanes = e.type().lanes()/2;
+    d.starting_lane = starting_lane;
+    d.lane_stride = lane_stride;
+    d.new_lanes = e.type().lanes() / lane_stride;
     e = d.mutate(e);
     return simplify(e);
 }
 
+Expr extract_odd_lanes(Expr e, const Scope<int> &lets) {
+    return extract_strided_lanes(e, 1, 2, lets);
+}
+
 Expr extract_even_lanes(Expr e, const Scope<int> &lets) {
-    internal_assert(e.type().lanes() % 2 == 0);
-    Deinterleaver d(lets);
-    d.starting_lane = 0;
-    d.lane_stride = 2;
-    d.new_lanes = (e.type().lanes()+1)/2;
-    e = d.mutate(e);
-    return simplify(e);
+    return extract_strided_lanes(e, 0, 2, lets);
 }
 
 Expr extract_even_lanes(Expr e) {
@@ -352,14 +352,9 @@ Expr extract_odd_lanes(Expr e) {
     return extract_odd_lanes(e, lets);
 }
 
-Expr extract_mod3_lanes(Expr e, int lane, const Scope<int> &lets) {
-    internal_assert(e.type().lanes() % 3 == 0);
-    Deinterleaver d(lets);
-    d.starting_lane = lane;
-    d.lane_stride = 3;
-    d.new_lanes = (e.type().lanes()+2)/3;
-    e = d.mutate(e);
-    return simplify(e);
+Expr extract_strided_lanes(Expr e, int starting_lane, int lane_stride) {
+    Scope<int> lets;
+    return extract_strided_lanes(e, starting_lane, lane_stride, lets);
 }
 
 Expr extract_lane(Expr e, int lane) {
@@ -373,6 +368,10 @@ Expr extract_lane(Expr e, int lane) {
 }
 
 class Interleaver : public IRMutator {
+    // The largest factor by which we'll split vectors indexed by
+    // ramp % factor or ramp / factor.
+    static const int max_deinterleave_factor = 8;
+
     Scope<ModulusRemainder> alignment_info;
 
     Scope<int> vector_lets;
@@ -382,33 +381,38 @@ class Interleaver : public IRMutator {
     bool should_deinterleave;
     int num_lanes;
 
+    // Split a vector into n vectors, the kth of which holds the lanes
+    // congruent to k mod n. Even factors are split into even and odd
+    // lanes first, which most targets can do with a single shuffle.
+    std::vector<Expr> deinterleave_parts(Expr e, int n) {
+        std::vector<Expr> parts(n);
+        if (n == 1) {
+            parts[0] = e;
+        } else if (n % 2 == 0) {
+            std::vector<Expr> even = deinterleave_parts(extract_even_lanes(e, vector_lets), n/2);
+            std::vector<Expr> odd = deinterleave_parts(extract_odd_lanes(e, vector_lets), n/2);
+            for (int k = 0; k < n/2; k++) {
+                parts[2*k] = even[k];
+                parts[2*k + 1] = odd[k];
+            }
+        } else {
+            for (int k = 0; k < n; k++) {
+                parts[k] = extract_strided_lanes(e, k, n, vector_lets);
+            }
+        }
+        return parts;
+    }
+
     Expr deinterleave_expr(Expr e) {
         if (e.type().lanes() <= num_lanes) {
             // Just scalarize
             return e;
-        } else if (num_lanes == 2) {
-            Expr a = extract_even_lanes(e, vector_lets);
-            Expr b = extract_odd_lanes(e, vector_lets);
-            return Call::make(e.type(), Call::interleave_vectors,
-                              {a, b}, Call::PureIntrinsic);
-        } else if (num_lanes == 3) {
-            Expr a = extract_mod3_lanes(e, 0, vector_lets);
-            Expr b = extract_mod3_lanes(e, 1, vector_lets);
-            Expr c = extract_mod3_lanes(e, 2, vector_lets);
-            return Call::make(e.type(), Call::interleave_vectors,
-                              {a, b, c}, Call::PureIntrinsic);
-        } else if (num_lanes == 4) {
-            Expr a = extract_even_lanes(e, vector_lets);
-            Expr b = extract_odd_lanes(e, vector_lets);
-            Expr aa = extract_even_lanes(a, vector_lets);
-            Expr ab = extract_odd_lanes(a, vector_lets);
-            Expr ba = extract_even_lanes(b, vector_lets);
-            Expr bb = extract_odd_lanes(b, vector_lets);
-            return Call::make(e.type(), Call::interleave_vectors,
-                              {aa, ba, ab, bb}, Call::PureIntrinsic);
-        } else {
-            // Give up and don't do anything clever for >4
+        } else if (e.type().lanes() % num_lanes != 0) {
+            // The lanes don't split evenly. Leave it alone.
             return e;
+        } else {
+            return Call::make(e.type(), Call::interleave_vectors,
+                              deinterleave_parts(e, num_lanes), Call::PureIntrinsic);
         }
     }
 
@@ -444,9 +448,9 @@ class Interleaver : public IRMutator {
                 result = T::make(op->name + ".odd_lanes", extract_odd_lanes(value, vector_lets), result);
             }
             if (value.type().lanes() % 3 == 0) {
-                result = T::make(op->name + ".lanes_0_of_3", extract_mod3_lanes(value, 0, vector_lets), result);
-                result = T::make(op->name + ".lanes_1_of_3", extract_mod3_lanes(value, 1, vector_lets), result);
-                result = T::make(op->name + ".lanes_2_of_3", extract_mod3_lanes(value, 2, vector_lets), result);
+                for (int i = 0; i < 3; i++) {
+                    result = T::make(op->name + lanes_suffix(i, 3), extract_strided_lanes(value, i, 3, vector_lets), result);
+                }
             }
         }
 
@@ -463,7 +467,7 @@ class Interleaver : public IRMutator {
 
     void visit(const Mod *op) {
         const Ramp *r = op->a.as<Ramp>();
-        for (int i = 2; i <= 4; ++i) {
+        for (int i = 2; i <= max_deinterleave_factor; ++i) {
             if (r &&
                 is_const(op->b, i) &&
                 (r->type.lanes() % i) == 0) {
@@ -477,7 +481,7 @@ class Interleaver : public IRMutator {
 
     void visit(const Div *op) {
         const Ramp *r = op->a.as<Ramp>();
-        for (int i = 2; i <= 4; ++i) {
+        for (int i = 2; i <= max_deinterleave_factor; ++i) {
             if (r && is_const(op->b, i)) {
                 should_deinterleave = true;
                 num_lanes = i;
@@ -493,7 +497,8 @@ class Interleaver : public IRMutator {
 
         should_deinterleave = false;
         Expr idx = mutate(op->index);
-        expr = Load::make(op->type, op->name, idx, op->image, op->param);
+        Expr predicate = mutate(op->predicate);
+        expr = Load::make(op->type, op->name, idx, op->image, op->param, predicate);
         if (should_deinterleave) {
             expr = deinterleave_expr(expr);
         }
@@ -518,7 +523,13 @@ class Interleaver : public IRMutator {
             value = deinterleave_expr(value);
         }
 
-        stmt = Store::make(op->name, value, idx, op->param);
+        should_deinterleave = false;
+        Expr predicate = mutate(op->predicate);
+        if (should_deinterleave) {
+            predicate = deinterleave_expr(predicate);
+        }
+
+        stmt = Store::make(op->name, value, idx, op->param, predicate);
 
         should_deinterleave = old_should_deinterleave;
         num_lanes = old_num_lanes;
@@ -549,6 +560,9 @@ class Interleaver : public IRMutator {
             // It's not a store of a ramp index.
             if (!r0) goto fail;
 
+            // It's a predicated store.
+            if (!is_one(store->predicate)) goto fail;
+
             const int64_t *stride_ptr = as_const_int(r0->stride);
 
             // The stride isn't a constant or is <= 0
@@ -589,6 +603,9 @@ class Interleaver : public IRMutator {
                 // Mismatched store vector laness.
                 if (ri->lanes != lanes) goto fail;
 
+                // Predicated stores can't be merged.
+                if (!is_one(stores[i].as<Store>()->predicate)) goto fail;
+
                 Expr diff = simplify(ri->base - r0->base);
                 const int64_t *offs = as_const_int(diff);
 
@@ -607,7 +624,7 @@ class Interleaver : public IRMutator {
                     // This case only triggers if we have an immediate load of the correct stride on the RHS.
                     // TODO: Could we consider mutating the RHS so that we can handle more complex Expr's than just loads?
                     const Load *load = stores[i].as<Store>()->value.as<Load>();
-                    if (!load) goto fail;
+                    if (!load || !is_one(load->predicate)) goto fail;
 
                     const Ramp *ramp = load->index.as<Ramp>();
                     if (!ramp) goto fail;
@@ -682,10 +699,413 @@ class Interleaver : public IRMutator {
     Interleaver() : should_deinterleave(false) {}
 };
 
+namespace {
+
+// Vector loads and stores with an index built from ramp / n and
+// ramp % n, as produced by fusing nested vectorized loops, are
+// gathers and scatters as written. Their lanes congruent mod n are
+// often dense or strided though, in which case we split them into n
+// strided accesses and interleave the results.
+class SplitInterleavedAccesses : public IRMutator {
+    using IRMutator::visit;
+
+    // The values of the vector lets in scope, with any vector lets
+    // they refer to substituted in.
+    map<string, Expr> vector_lets;
+
+    // Don't touch device code.
+    bool in_device_loop = false;
+
+    // Find the smallest lane stride for which each set of lanes of
+    // the index congruent mod the stride forms a ramp or a
+    // broadcast. Returns zero if there isn't one.
+    int find_lane_stride(Expr index, vector<Expr> &pieces) {
+        int lanes = index.type().lanes();
+        if (in_device_loop || lanes == 1 ||
+            index.as<Ramp>() || index.as<Broadcast>()) {
+            return 0;
+        }
+        index = substitute(vector_lets, index);
+        for (int stride = 2; stride < lanes; stride++) {
+            if (lanes % stride) continue;
+            pieces.clear();
+            for (int i = 0; i < stride; i++) {
+                Expr piece = extract_strided_lanes(index, i, stride);
+                if (!piece.as<Ramp>() && !piece.as<Broadcast>()) {
+                    break;
+                }
+                pieces.push_back(piece);
+            }
+            if ((int)pieces.size() == stride) {
+                return stride;
+            }
+        }
+        return 0;
+    }
+
+    void visit(const Load *op) {
+        IRMutator::visit(op);
+        op = expr.as<Load>();
+        vector<Expr> pieces;
+        if (!op || !is_one(op->predicate) || !find_lane_stride(op->index, pieces)) {
+            return;
+        }
+        Type t = op->type.with_lanes(op->type.lanes() / (int)pieces.size());
+        vector<Expr> loads;
+        for (Expr piece : pieces) {
+            loads.push_back(Load::make(t, op->name, piece, op->image, op->param));
+        }
+        expr = Call::make(op->type, Call::interleave_vectors, loads, Call::PureIntrinsic);
+    }
+
+    void visit(const Store *op) {
+        IRMutator::visit(op);
+        op = stmt.as<Store>();
+        vector<Expr> pieces;
+        if (!op || !is_one(op->predicate) || !find_lane_stride(op->index, pieces)) {
+            return;
+        }
+        int stride = (int)pieces.size();
+        vector<Stmt> stores;
+        for (int i = 0; i < stride; i++) {
+            Expr value = extract_strided_lanes(op->value, i, stride);
+            stores.push_back(Store::make(op->name, value, pieces[i], op->param));
+        }
+        stmt = Block::make(stores);
+    }
+
+    template<typename LetOrLetStmt>
+    void visit_let(const LetOrLetStmt *op) {
+        if (op->value.type().is_vector()) {
+            Expr old_value;
+            auto it = vector_lets.find(op->name);
+            if (it != vector_lets.end()) {
+                old_value = it->second;
+            }
+            vector_lets[op->name] = substitute(vector_lets, op->value);
+            IRMutator::visit(op);
+            if (old_value.defined()) {
+                vector_lets[op->name] = old_value;
+            } else {
+                vector_lets.erase(op->name);
+            }
+        } else {
+            IRMutator::visit(op);
+        }
+    }
+
+    void visit(const Let *op) {
+        visit_let(op);
+    }
+
+    void visit(const LetStmt *op) {
+        visit_let(op);
+    }
+
+    void visit(const For *op) {
+        bool old_in_device_loop = in_device_loop;
+        if (op->device_api != DeviceAPI::None &&
+            op->device_api != DeviceAPI::Host) {
+            in_device_loop = true;
+        }
+        IRMutator::visit(op);
+        in_device_loop = old_in_device_loop;
+    }
+};
+
+}
+
 Stmt rewrite_interleavings(Stmt s) {
+    s = SplitInterleavedAccesses().mutate(s);
     return Interleaver().mutate(s);
 }
 
+namespace {
+
+// Find the vector loads of ramps with a stride other than one in an
+// expression, which could be evaluated before the statement that
+// contains the expression. Only loads the expression always evaluates
+// are found, as moving a guarded load ahead of its guard could read
+// out of bounds.
+class FindStridedLoads : public IRVisitor {
+    using IRVisitor::visit;
+
+    void visit(const Let *op) {
+        // Loads in the body may depend on the let.
+        op->value.accept(this);
+    }
+
+    void visit(const Select *op) {
+        op->condition.accept(this);
+    }
+
+    void visit(const Call *op) {
+        if (op->is_intrinsic(Call::if_then_else)) {
+            op->args[0].accept(this);
+        } else {
+            IRVisitor::visit(op);
+        }
+    }
+
+    void visit(const Load *op) {
+        IRVisitor::visit(op);
+        const Ramp *r = op->index.as<Ramp>();
+        if (r && !is_one(r->stride) && is_one(op->predicate) && !contains_load(op->index)) {
+            loads.push_back(op);
+        }
+    }
+
+    class ContainsLoad : public IRVisitor {
+        using IRVisitor::visit;
+        void visit(const Load *op) {
+            result = true;
+        }
+    public:
+        bool result = false;
+    };
+
+    bool contains_load(Expr e) {
+        ContainsLoad c;
+        e.accept(&c);
+        return c.result;
+    }
+
+public:
+    std::vector<const Load *> loads;
+};
+
+// Replace some loads with other expressions.
+class ReplaceLoads : public IRMutator {
+    using IRMutator::visit;
+
+    const std::vector<pair<Expr, Expr>> &replacements;
+
+    void visit(const Load *op) {
+        for (const auto &r : replacements) {
+            if (equal(r.first, op)) {
+                expr = r.second;
+                return;
+            }
+        }
+        IRMutator::visit(op);
+    }
+
+public:
+    ReplaceLoads(const std::vector<pair<Expr, Expr>> &r) : replacements(r) {}
+};
+
+// A set of strided vector loads from the same buffer with the same
+// stride, whose bases are consecutive.
+struct StridedLoadGroup {
+    const Load *first;
+    Expr stride;
+    // The loads, indexed by the offset of their base from the base of
+    // the first load.
+    std::map<int64_t, Expr> loads;
+};
+
+class RewriteTransposes : public IRMutator {
+    using IRMutator::visit;
+
+    // The largest block of vectors we'll rearrange with shuffles.
+    static const int max_block_size = 16;
+
+    std::vector<pair<std::string, Expr>> lets;
+    std::vector<pair<Expr, Expr>> replacements;
+
+    Expr make_let(Expr value) {
+        std::string name = unique_name('t');
+        lets.push_back(make_pair(name, value));
+        return Variable::make(value.type(), name);
+    }
+
+    Expr slice(Expr v, int start, int stride, int lanes) {
+        return Call::make(v.type().with_lanes(lanes), Call::slice_vector,
+                          {v, start, stride, lanes}, Call::PureIntrinsic);
+    }
+
+    // The loads in the group read lanes j, j + s, j + 2s, ... of a
+    // dense vector of s*n lanes, where s is the number of loads and
+    // also the stride. Do one dense load and slice it up.
+    void deinterleave_group(const StridedLoadGroup &g, Expr base, int64_t min_offset) {
+        Type t = g.first->type;
+        int n = t.lanes();
+        int s = (int)g.loads.size();
+        Expr dense = Load::make(t.with_lanes(s*n), g.first->name,
+                                Ramp::make(base, 1, s*n), g.first->image, g.first->param);
+        dense = make_let(dense);
+        for (const auto &l : g.loads) {
+            replacements.push_back(make_pair(l.second, slice(dense, (int)(l.first - min_offset), s, n)));
+        }
+    }
+
+    // The n loads in the group each read one column of an n x n block
+    // whose rows are dense. Load the rows and transpose the block.
+    void transpose_group(const StridedLoadGroup &g, Expr base, int64_t min_offset) {
+        Type t = g.first->type;
+        int n = t.lanes();
+        std::vector<Expr> rows(n);
+        for (int k = 0; k < n; k++) {
+            Expr row_base = simplify(base + k * g.stride);
+            rows[k] = make_let(Load::make(t, g.first->name, Ramp::make(row_base, 1, n),
+                                          g.first->image, g.first->param));
+        }
+
+        std::vector<Expr> columns(n);
+        if ((n & (n - 1)) == 0) {
+            // Each step interleaves rows k and k + n/2, and splits
+            // the result into halves. After log2(n) steps, the rows
+            // are the columns.
+            for (int step = 1; step < n; step *= 2) {
+                std::vector<Expr> new_rows(n);
+                for (int k = 0; k < n/2; k++) {
+                    Expr both = Call::make(t.with_lanes(2*n), Call::interleave_vectors,
+                                           {rows[k], rows[k + n/2]}, Call::PureIntrinsic);
+                    both = make_let(both);
+                    new_rows[2*k] = make_let(slice(both, 0, 1, n));
+                    new_rows[2*k + 1] = make_let(slice(both, n, 1, n));
+                }
+                rows.swap(new_rows);
+            }
+            columns = rows;
+        } else {
+            Expr block = Call::make(t.with_lanes(n*n), Call::concat_vectors, rows, Call::PureIntrinsic);
+            block = make_let(block);
+            for (int j = 0; j < n; j++) {
+                columns[j] = slice(block, j, n, n);
+            }
+        }
+
+        for (const auto &l : g.loads) {
+            replacements.push_back(make_pair(l.second, columns[l.first - min_offset]));
+        }
+    }
+
+    // Rewrite the strided loads in a run of consecutive stores.
+    Stmt rewrite_stores(const std::vector<Stmt> &stores) {
+        std::set<std::string> stored;
+        FindStridedLoads finder;
+        for (Stmt s : stores) {
+            const Store *store = s.as<Store>();
+            stored.insert(store->name);
+            store->value.accept(&finder);
+        }
+
+        std::vector<StridedLoadGroup> groups;
+        for (const Load *load : finder.loads) {
+            // Loads from a buffer written to by one of the stores
+            // can't be moved ahead of the stores.
+            if (stored.count(load->name)) continue;
+
+            const Ramp *r = load->index.as<Ramp>();
+            bool found = false;
+            for (StridedLoadGroup &g : groups) {
+                const Ramp *r0 = g.first->index.as<Ramp>();
+                if (g.first->name != load->name ||
+                    g.first->type != load->type ||
+                    !equal(g.stride, r->stride)) {
+                    continue;
+                }
+                const int64_t *offset = as_const_int(simplify(r->base - r0->base));
+                if (offset) {
+                    g.loads[*offset] = load;
+                    found = true;
+                    break;
+                }
+            }
+            if (!found) {
+                StridedLoadGroup g;
+                g.first = load;
+                g.stride = r->stride;
+                g.loads[0] = load;
+                groups.push_back(g);
+            }
+        }
+
+        lets.clear();
+        replacements.clear();
+        for (const StridedLoadGroup &g : groups) {
+            int64_t min_offset = g.loads.begin()->first;
+            int64_t max_offset = g.loads.rbegin()->first;
+            int64_t size = (int64_t)g.loads.size();
+            int lanes = g.first->type.lanes();
+            const int64_t *stride = as_const_int(g.stride);
+
+            // The bases must be consecutive.
+            if (size < 2 || size > max_block_size || max_offset - min_offset != size - 1) continue;
+
+            Expr base = simplify(g.first->index.as<Ramp>()->base + (int)min_offset);
+            if (stride && *stride == size) {
+                debug(3) << "Deinterleaving " << size << " strided loads from " << g.first->name << "\n";
+                deinterleave_group(g, base, min_offset);
+            } else if (size == lanes && !(stride && *stride >= -1 && *stride <= 1)) {
+                debug(3) << "Transposing a " << size << "x" << size << " block of " << g.first->name << "\n";
+                transpose_group(g, base, min_offset);
+            }
+        }
+
+        if (replacements.empty()) {
+            return Block::make(stores);
+        }
+
+        ReplaceLoads replacer(replacements);
+        std::vector<Stmt> new_stores;
+        for (Stmt s : stores) {
+            new_stores.push_back(replacer.mutate(s));
+        }
+        Stmt result = Block::make(new_stores);
+        for (size_t i = lets.size(); i > 0; i--) {
+            result = LetStmt::make(lets[i-1].first, lets[i-1].second, result);
+        }
+        return result;
+    }
+
+    void visit(const Block *op) {
+        std::vector<Stmt> stmts;
+        Stmt s = op;
+        while (const Block *b = s.as<Block>()) {
+            stmts.push_back(b->first);
+            s = b->rest;
+        }
+        stmts.push_back(s);
+
+        std::vector<Stmt> result;
+        for (size_t i = 0; i < stmts.size(); ) {
+            if (!stmts[i].as<Store>()) {
+                result.push_back(mutate(stmts[i]));
+                i++;
+                continue;
+            }
+            size_t j = i;
+            while (j < stmts.size() && stmts[j].as<Store>()) {
+                j++;
+            }
+            result.push_back(rewrite_stores(std::vector<Stmt>(stmts.begin() + i, stmts.begin() + j)));
+            i = j;
+        }
+        stmt = Block::make(result);
+    }
+
+    void visit(const Store *op) {
+        stmt = rewrite_stores({op});
+    }
+
+    void visit(const For *op) {
+        if (CodeGen_GPU_Dev::is_gpu_var(op->name)) {
+            // GPU backends don't all handle arbitrary shuffles.
+            stmt = op;
+        } else {
+            IRMutator::visit(op);
+        }
+    }
+};
+
+}
+
+Stmt rewrite_transposes(Stmt s) {
+    return RewriteTransposes().mutate(s);
+}
+
 namespace {
 void check(Expr a, Expr even, Expr odd) {
     a = simplify(a);
@@ -717,6 +1137,11 @@ void deinterleave_vector_test() {
           Load::make(ramp_a.type(), "buf", ramp_a, BufferPtr(), Parameter()),
           Load::make(ramp_b.type(), "buf", ramp_b, BufferPtr(), Parameter()));
 
+    Expr ramp_lanes_1_of_3 = extract_strided_lanes(Ramp::make(x + 4, 3, 9), 1, 3);
+    if (!equal(ramp_lanes_1_of_3, Ramp::make(x + 7, 9, 3))) {
+        internal_error << ramp_lanes_1_of_3 << " != " << Ramp::make(x + 7, 9, 3) << "\n";
+    }
+
     std::cout << "deinterleave_vector test passed" << std::endl;
 }
 
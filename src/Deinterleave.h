@@ -19,6 +19,11 @@ EXPORT Expr extract_odd_lanes(Expr a);
 /** Extract the even-numbered lanes in a vector */
 EXPORT Expr extract_even_lanes(Expr a);
 
+/** Extract the lanes of a vector whose index is congruent to
+ * starting_lane modulo lane_stride. The number of lanes must be a
+ * multiple of lane_stride. */
+EXPORT Expr extract_strided_lanes(Expr a, int starting_lane, int lane_stride);
+
 /** Extract the nth lane of a vector */
 EXPORT Expr extract_lane(Expr vec, int lane);
 
@@ -27,6 +32,14 @@ EXPORT Expr extract_lane(Expr vec, int lane);
  * intrinsic */
 Stmt rewrite_interleavings(Stmt s);
 
+/** Look through runs of consecutive stores for groups of strided
+ * vector loads that together cover a dense region of a buffer, such
+ * as the columns of a small block (a transpose) or the channels of a
+ * packed image (a deinterleave). Replace each group with dense vector
+ * loads followed by shuffles. Loads the stores only evaluate
+ * conditionally are left alone. */
+EXPORT Stmt rewrite_transposes(Stmt s);
+
 EXPORT void deinterleave_vector_test();
 
 }
@@ -0,0 +1,115 @@
+#include "DivideByInvariant.h"
+#include "IRMutator.h"
+#include "IROperator.h"
+
+namespace Halide {
+namespace Internal {
+
+namespace {
+
+// Unsigned division of a vector by a scalar, using the method from
+// "Division by Invariant Integers using Multiplication" (Granlund
+// and Montgomery), in the form that needs no branches on the
+// divisor. d may not be zero.
+Expr unsigned_divide(Expr n, Expr d) {
+    Type t = d.type();
+    internal_assert(t.is_uint() && t.is_scalar() && t.bits() <= 32);
+    int bits = t.bits();
+    int lanes = n.type().lanes();
+
+    // The number of bits needed to represent d - 1, i.e. ceil(log2(d)).
+    Expr l = make_const(t, bits) - count_leading_zeros(d - make_one(t));
+
+    // m = floor(2^bits * (2^l - d) / d) + 1, which fits in the
+    // narrow type because 2^l - d < d.
+    Expr d_wide = cast(UInt(64), d);
+    Expr m = (((make_one(UInt(64)) << cast(UInt(64), l)) - d_wide) << make_const(UInt(64), bits)) / d_wide;
+    m = cast(t, m + make_one(UInt(64)));
+
+    // Shift by one less than l in two steps, so that neither shift
+    // is negative when l is zero.
+    Expr shift1 = min(l, make_one(t));
+    Expr shift2 = max(l, make_one(t)) - make_one(t);
+
+    // Multiply-keep-high-half.
+    Type wide = n.type().with_bits(bits * 2);
+    Expr q = cast(wide, Broadcast::make(m, lanes)) * cast(wide, n);
+    q = cast(n.type(), q >> make_const(wide, bits));
+
+    // Add half the difference between the numerator and the
+    // estimate so far. This can't overflow, because q <= n.
+    q = q + ((n - q) >> Broadcast::make(shift1, lanes));
+    return q >> Broadcast::make(shift2, lanes);
+}
+
+class OptimizeInvariantDivisions : public IRMutator {
+    using IRMutator::visit;
+
+    template<typename T>
+    void visit_div_mod(const T *op, bool is_div) {
+        Type t = op->type;
+        const Broadcast *b = op->b.template as<Broadcast>();
+        if (!t.is_vector() || !(t.is_int() || t.is_uint()) || t.bits() > 32 ||
+            !b || is_const(b->value)) {
+            // Division by constants is already lowered to multiplies
+            // and shifts by the backends.
+            IRMutator::visit(op);
+            return;
+        }
+
+        Expr a = mutate(op->a);
+        Expr d = mutate(b->value);
+        int lanes = t.lanes();
+        int bits = t.bits();
+
+        Expr q;
+        if (t.is_uint()) {
+            q = unsigned_divide(a, d);
+        } else {
+            // The Euclidean quotient is sign(d) * floor(a / |d|). The
+            // floor of a negative numerator is ~(~a / |d|), so flip
+            // the bits of negative numerators before and after an
+            // unsigned division.
+            Type ut = t.with_code(Type::UInt);
+            Expr a_sign = a >> make_const(t, bits - 1);
+            Expr n = cast(ut, a ^ a_sign);
+            Expr floor_q = cast(t, unsigned_divide(n, abs(d))) ^ a_sign;
+            Expr d_sign = Broadcast::make(d >> make_const(d.type(), bits - 1), lanes);
+            q = (floor_q ^ d_sign) - d_sign;
+        }
+
+        if (is_div) {
+            expr = q;
+        } else {
+            // The Euclidean remainder is non-negative.
+            expr = a - q * Broadcast::make(d, lanes);
+        }
+    }
+
+    void visit(const Div *op) {
+        visit_div_mod(op, true);
+    }
+
+    void visit(const Mod *op) {
+        visit_div_mod(op, false);
+    }
+
+    void visit(const For *op) {
+        if (op->device_api != DeviceAPI::None &&
+            op->device_api != DeviceAPI::Host) {
+            // GPUs have their own fast division.
+            stmt = op;
+        } else {
+            IRMutator::visit(op);
+        }
+    }
+};
+
+}  // namespace
+
+Stmt optimize_invariant_divisions(Stmt s) {
+    return OptimizeInvariantDivisions().mutate(s);
+}
+
+}
+}
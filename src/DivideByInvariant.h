@@ -0,0 +1,27 @@
+#ifndef HALIDE_DIVIDE_BY_INVARIANT_H
+#define HALIDE_DIVIDE_BY_INVARIANT_H
+
+/** \file
+ * Defines a lowering pass that replaces vector integer division by a
+ * value that isn't known at compile time, but is the same in every
+ * lane, with a multiply and shifts.
+ */
+
+#include "IR.h"
+
+namespace Halide {
+namespace Internal {
+
+/** Rewrite vector integer divisions and mods of 8, 16, and 32 bit
+ * values by a broadcast scalar into a multiply-keep-high-half by a
+ * magic number, followed by shifts. The magic number and shifts are
+ * computed from the scalar divisor, so if the divisor is loop
+ * invariant, loop_invariant_code_motion can move that computation
+ * out of the loop. The results match Halide's Euclidean division
+ * and mod. Loops that run on a device are left alone. */
+EXPORT Stmt optimize_invariant_divisions(Stmt s);
+
+}
+}
+
+#endif
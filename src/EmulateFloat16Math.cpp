@@ -0,0 +1,420 @@
+#include "EmulateFloat16Math.h"
+#include "CodeGen_GPU_Dev.h"
+#include "Float16.h"
+#include "IRMutator.h"
+#include "IROperator.h"
+#include "Scope.h"
+#include "Substitute.h"
+
+namespace Halide {
+namespace Internal {
+
+using std::map;
+using std::string;
+using std::vector;
+
+Expr float16_bits_to_float32(Expr bits) {
+    internal_assert(bits.type().element_of() == UInt(16));
+    Type u32 = UInt(32, bits.type().lanes());
+    Type f32 = Float(32, bits.type().lanes());
+    auto k = [&](int64_t c) {return make_const(u32, c);};
+
+    string b_name = unique_name('b');
+    Expr b = Variable::make(u32, b_name);
+
+    Expr sign = (b & k(0x8000)) << k(16);
+    Expr exponent = (b >> k(10)) & k(0x1f);
+    Expr mantissa = b & k(0x3ff);
+
+    // Rebias the exponent from 15 to 127.
+    Expr normal = sign | ((exponent + k(112)) << k(23)) | (mantissa << k(13));
+    Expr inf_or_nan = sign | k(0x7f800000) | (mantissa << k(13));
+    // Subnormals are the mantissa times 2^-24, which is exact in float32.
+    Expr subnormal = cast(f32, mantissa) * make_const(f32, 1.0 / (1 << 24));
+    subnormal = sign | reinterpret(u32, subnormal);
+
+    Expr result = select(exponent == k(0), subnormal,
+                         exponent == k(31), inf_or_nan,
+                         normal);
+    result = reinterpret(f32, result);
+    return Let::make(b_name, cast(u32, bits), result);
+}
+
+Expr float32_to_float16_bits(Expr value, RoundingMode rounding_mode) {
+    internal_assert(value.type().element_of() == Float(32));
+    Type u32 = UInt(32, value.type().lanes());
+    auto k = [&](int64_t c) {return make_const(u32, c);};
+
+    string x_name = unique_name('x');
+    Expr x = Variable::make(u32, x_name);
+
+    Expr sign = x >> k(31);
+    Expr a = x & k(0x7fffffff);
+    Expr exponent = a >> k(23);
+    Expr mantissa = a & k(0x7fffff);
+
+    // Results with an exponent of at least -14 are normal halves, and
+    // are the top bits of the float with the exponent rebiased. The
+    // bottom 13 bits are rounded away.
+    Expr normal = (a >> k(13)) - k(112 << 10);
+
+    // Smaller results are subnormal, and are the full significand
+    // shifted right by enough to make the quantum 2^-24.
+    Expr is_subnormal = exponent < k(113);
+    Expr significand = select(exponent == k(0), mantissa, mantissa | k(0x800000));
+    Expr shift = min(k(126) - exponent, k(31));
+    Expr subnormal = significand >> shift;
+
+    shift = select(is_subnormal, shift, k(13));
+    Expr truncated = select(is_subnormal, subnormal, normal);
+    Expr remainder = select(is_subnormal, significand, a) & ((k(1) << shift) - k(1));
+    Expr halfway = k(1) << (shift - k(1));
+
+    Expr round_up;
+    switch (rounding_mode) {
+    case RoundingMode::TowardZero:
+        round_up = const_false(value.type().lanes());
+        break;
+    case RoundingMode::ToNearestTiesToEven:
+        round_up = (remainder > halfway ||
+                    (remainder == halfway && (truncated & k(1)) == k(1)));
+        break;
+    case RoundingMode::ToNearestTiesToAway:
+        round_up = remainder >= halfway;
+        break;
+    case RoundingMode::TowardPositiveInfinity:
+        round_up = remainder != k(0) && sign == k(0);
+        break;
+    case RoundingMode::TowardNegativeInfinity:
+        round_up = remainder != k(0) && sign == k(1);
+        break;
+    }
+    Expr rounded = truncated + select(round_up, k(1), k(0));
+
+    // Results too large for a half become infinity or the largest
+    // finite half, depending on which way we're rounding.
+    Expr inf = k(0x7c00), max_finite = k(0x7bff);
+    Expr overflow;
+    switch (rounding_mode) {
+    case RoundingMode::TowardZero:
+        overflow = max_finite;
+        break;
+    case RoundingMode::ToNearestTiesToEven:
+    case RoundingMode::ToNearestTiesToAway:
+        overflow = inf;
+        break;
+    case RoundingMode::TowardPositiveInfinity:
+        overflow = select(sign == k(0), inf, max_finite);
+        break;
+    case RoundingMode::TowardNegativeInfinity:
+        overflow = select(sign == k(0), max_finite, inf);
+        break;
+    }
+
+    // Infinities stay infinite, and NaNs stay quiet NaNs.
+    Expr inf_or_nan = select(a == k(0x7f800000), inf, k(0x7e00) | (mantissa >> k(13)));
+
+    Expr magnitude = select(a >= k(0x7f800000), inf_or_nan,
+                            rounded >= inf, overflow,
+                            rounded);
+    Expr result = cast(UInt(16, value.type().lanes()), (sign << k(15)) | magnitude);
+    return Let::make(x_name, reinterpret(u32, value), result);
+}
+
+namespace {
+
+// Round a float64 to float32, rounding inexact results to the
+// neighbour with an odd significand. A float32 has more than two bits
+// more precision than a half, so rounding the result on to a half
+// gives the same answer as rounding the float64 directly, where
+// rounding to nearest twice might not.
+Expr float64_to_float32_round_to_odd(Expr value) {
+    Type u32 = UInt(32, value.type().lanes());
+    Type f32 = Float(32, value.type().lanes());
+    Type f64 = value.type();
+
+    string d_name = unique_name('d');
+    Expr d = Variable::make(f64, d_name);
+    string f_name = unique_name('f');
+    Expr f = Variable::make(f32, f_name);
+
+    // Undo rounding away from zero by stepping the magnitude down one
+    // ulp, then mark the result inexact by setting the low bit.
+    // NaNs are left alone.
+    Expr bits = reinterpret(u32, f);
+    Expr away = abs(Cast::make(f64, f)) > abs(d);
+    Expr inexact = Cast::make(f64, f) != d && d == d;
+    bits = select(away, bits - make_const(u32, 1), bits);
+    bits = select(inexact, bits | make_const(u32, 1), bits);
+
+    Expr result = reinterpret(f32, bits);
+    result = Let::make(f_name, Cast::make(f32, d), result);
+    return Let::make(d_name, value, result);
+}
+
+class EmulateFloat16Math : public IRMutator {
+    // Whether the target converts between half and float in
+    // hardware. If not, half values are represented by their bits.
+    bool native;
+
+    // Lets whose values had their type changed from Float(16) to
+    // UInt(16), and their number of lanes.
+    Scope<int> bits_lets;
+
+    bool is_f16(Type t) {
+        return t.is_float() && t.bits() == 16;
+    }
+
+    // The type used to represent values of type t.
+    Type rep(Type t) {
+        return (is_f16(t) && !native) ? UInt(16, t.lanes()) : t;
+    }
+
+    // Convert an already-mutated half value to float.
+    Expr widen(Expr e) {
+        if (native) {
+            return Cast::make(Float(32, e.type().lanes()), e);
+        } else {
+            return float16_bits_to_float32(e);
+        }
+    }
+
+    // Round a float value to a half value.
+    Expr narrow(Expr e) {
+        if (native) {
+            return Cast::make(Float(16, e.type().lanes()), e);
+        } else {
+            return float32_to_float16_bits(e, RoundingMode::ToNearestTiesToEven);
+        }
+    }
+
+    template<typename T>
+    void visit_arith(const T *op) {
+        if (is_f16(op->type)) {
+            expr = narrow(T::make(widen(mutate(op->a)), widen(mutate(op->b))));
+        } else {
+            IRMutator::visit(op);
+        }
+    }
+
+    template<typename T>
+    void visit_cmp(const T *op) {
+        if (is_f16(op->a.type())) {
+            expr = T::make(widen(mutate(op->a)), widen(mutate(op->b)));
+        } else {
+            IRMutator::visit(op);
+        }
+    }
+
+    using IRMutator::visit;
+
+    void visit(const Add *op) {visit_arith(op);}
+    void visit(const Sub *op) {visit_arith(op);}
+    void visit(const Mul *op) {visit_arith(op);}
+    void visit(const Div *op) {visit_arith(op);}
+    void visit(const Mod *op) {visit_arith(op);}
+    void visit(const Min *op) {visit_arith(op);}
+    void visit(const Max *op) {visit_arith(op);}
+    void visit(const EQ *op) {visit_cmp(op);}
+    void visit(const NE *op) {visit_cmp(op);}
+    void visit(const LT *op) {visit_cmp(op);}
+    void visit(const LE *op) {visit_cmp(op);}
+    void visit(const GT *op) {visit_cmp(op);}
+    void visit(const GE *op) {visit_cmp(op);}
+
+    void visit(const FloatImm *op) {
+        if (is_f16(op->type) && !native) {
+            expr = make_const(UInt(16), float16_t(op->value).to_bits());
+        } else {
+            expr = op;
+        }
+    }
+
+    void visit(const Cast *op) {
+        Type from = op->value.type();
+        if (is_f16(from) && is_f16(op->type)) {
+            expr = mutate(op->value);
+        } else if (is_f16(from)) {
+            // Go via float, which holds every half exactly.
+            Expr f = widen(mutate(op->value));
+            expr = (op->type == f.type()) ? f : Cast::make(op->type, f);
+        } else if (is_f16(op->type)) {
+            Expr value = mutate(op->value);
+            if (value.type().is_float() && value.type().bits() == 64) {
+                value = float64_to_float32_round_to_odd(value);
+            } else if (!value.type().is_float() || value.type().bits() != 32) {
+                // Integers in the range of a half are exact in float32,
+                // and larger ones overflow either way.
+                value = Cast::make(Float(32, value.type().lanes()), value);
+            }
+            expr = narrow(value);
+        } else {
+            IRMutator::visit(op);
+        }
+    }
+
+    void visit(const Ramp *op) {
+        if (is_f16(op->type)) {
+            expr = narrow(Ramp::make(widen(mutate(op->base)), widen(mutate(op->stride)), op->lanes));
+        } else {
+            IRMutator::visit(op);
+        }
+    }
+
+    void visit(const Variable *op) {
+        if (is_f16(op->type) && !native) {
+            if (bits_lets.contains(op->name)) {
+                expr = Variable::make(rep(op->type), op->name);
+            } else {
+                // A scalar parameter.
+                expr = reinterpret(rep(op->type), op);
+            }
+        } else {
+            expr = op;
+        }
+    }
+
+    void visit(const Load *op) {
+        if (is_f16(op->type) && !native) {
+            expr = Load::make(rep(op->type), op->name, mutate(op->index), op->image, op->param, mutate(op->predicate));
+        } else {
+            IRMutator::visit(op);
+        }
+    }
+
+    template<typename LetOrLetStmt, typename StmtOrExpr>
+    StmtOrExpr visit_let(const LetOrLetStmt *op) {
+        Expr value = mutate(op->value);
+        bool changed_type = value.type() != op->value.type();
+        if (changed_type) {
+            bits_lets.push(op->name, value.type().lanes());
+        }
+        StmtOrExpr body = mutate(op->body);
+        if (changed_type) {
+            bits_lets.pop(op->name);
+        }
+        if (value.same_as(op->value) && body.same_as(op->body)) {
+            return op;
+        }
+        return LetOrLetStmt::make(op->name, value, body);
+    }
+
+    void visit(const Let *op) {
+        expr = visit_let<Let, Expr>(op);
+    }
+
+    void visit(const LetStmt *op) {
+        stmt = visit_let<LetStmt, Stmt>(op);
+    }
+
+    void visit(const Call *op) {
+        bool any_f16_args = false;
+        for (Expr e : op->args) {
+            any_f16_args |= is_f16(e.type());
+        }
+        if (!is_f16(op->type) && !any_f16_args) {
+            IRMutator::visit(op);
+            return;
+        }
+
+        if (op->is_intrinsic(Call::reinterpret)) {
+            Expr arg = mutate(op->args[0]);
+            Type t = rep(op->type);
+            expr = (arg.type() == t) ? arg : reinterpret(t, arg);
+            return;
+        }
+
+        if (op->is_intrinsic(Call::abs) && !native) {
+            // Clear the sign bit.
+            Expr arg = mutate(op->args[0]);
+            expr = arg & make_const(arg.type(), 0x7fff);
+            return;
+        }
+
+        vector<Expr> args(op->args.size());
+        for (size_t i = 0; i < op->args.size(); i++) {
+            args[i] = mutate(op->args[i]);
+        }
+
+        bool moves_bits = (op->is_intrinsic(Call::if_then_else) ||
+                           op->is_intrinsic(Call::likely) ||
+                           op->is_intrinsic(Call::likely_if_innermost) ||
+                           op->is_intrinsic(Call::return_second) ||
+                           op->is_intrinsic(Call::shuffle_vector) ||
+                           op->is_intrinsic(Call::interleave_vectors) ||
+                           op->is_intrinsic(Call::concat_vectors) ||
+                           op->is_intrinsic(Call::slice_vector) ||
+                           op->is_intrinsic(Call::memoize_expr) ||
+                           op->is_intrinsic(Call::undef));
+
+        bool is_math = (op->call_type == Call::Extern || op->call_type == Call::PureExtern) &&
+            ends_with(op->name, "_f16");
+
+        if (is_math || (!moves_bits && is_f16(op->type) &&
+                        (op->call_type == Call::Intrinsic ||
+                         op->call_type == Call::PureIntrinsic))) {
+            // Compute it in float. The float versions of the math
+            // library functions share the name but for the suffix.
+            string name = op->name;
+            if (is_math) {
+                name = name.substr(0, name.size() - 4) + "_f32";
+            }
+            for (size_t i = 0; i < args.size(); i++) {
+                if (is_f16(op->args[i].type())) {
+                    args[i] = widen(args[i]);
+                }
+            }
+            if (is_f16(op->type)) {
+                Type t = Float(32, op->type.lanes());
+                expr = narrow(Call::make(t, name, args, op->call_type));
+            } else {
+                expr = Call::make(op->type, name, args, op->call_type);
+            }
+            return;
+        }
+
+        expr = Call::make(rep(op->type), op->name, args, op->call_type,
+                          op->func, op->value_index, op->image, op->param);
+    }
+
+    void visit(const For *op) {
+        if (op->device_api == DeviceAPI::Hexagon && native) {
+            // The host converts in hardware, but Hexagon doesn't.
+            Stmt body = EmulateFloat16Math(false).mutate(op->body);
+            stmt = For::make(op->name, op->min, op->extent, op->for_type, op->device_api, body);
+        } else if (CodeGen_GPU_Dev::is_gpu_var(op->name) ||
+                   (op->device_api != DeviceAPI::None &&
+                    op->device_api != DeviceAPI::Host &&
+                    op->device_api != DeviceAPI::Hexagon)) {
+            // GPU languages have their own half type. Leave the
+            // kernel alone, but give it back any halves we've turned
+            // into bits.
+            if (native) {
+                stmt = op;
+            } else {
+                map<string, Expr> replacements;
+                for (auto iter = bits_lets.cbegin(); iter != bits_lets.cend(); ++iter) {
+                    Expr bits = Variable::make(UInt(16, iter.value()), iter.name());
+                    replacements[iter.name()] = reinterpret(Float(16, iter.value()), bits);
+                }
+                stmt = substitute(replacements, Stmt(op));
+            }
+        } else {
+            IRMutator::visit(op);
+        }
+    }
+
+public:
+    EmulateFloat16Math(bool n) : native(n) {}
+};
+
+}
+
+Stmt emulate_float16_math(Stmt s, const Target &t) {
+    bool native = ((t.arch == Target::X86 && t.has_feature(Target::F16C)) ||
+                   (t.arch == Target::ARM && t.bits == 64));
+    return EmulateFloat16Math(native).mutate(s);
+}
+
+}
+}
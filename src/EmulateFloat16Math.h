@@ -0,0 +1,44 @@
+#ifndef HALIDE_EMULATE_FLOAT16_MATH_H
+#define HALIDE_EMULATE_FLOAT16_MATH_H
+
+/** \file
+ * Defines the lowering pass that implements half-precision float math
+ * in terms of single-precision float math.
+ */
+
+#include "IR.h"
+#include "RoundingMode.h"
+#include "Target.h"
+
+namespace Halide {
+namespace Internal {
+
+/** Convert the bits of a half-precision float (as a uint16, or a
+ * vector of them) to a float32, using only integer and float32
+ * operations. The result is exact for all inputs, including
+ * subnormals, infinities and NaNs. */
+Expr float16_bits_to_float32(Expr bits);
+
+/** Round a float32 (or a vector of them) to half precision using the
+ * given rounding mode, and return the bits of the result as a
+ * uint16. Uses only integer operations, so it vectorizes well. */
+Expr float32_to_float16_bits(Expr value, RoundingMode rounding_mode);
+
+/** Rewrite all arithmetic on Float(16) values outside of GPU kernels
+ * to widen the operands to Float(32), compute, and round the result
+ * back to Float(16) to nearest, ties to even. Widening is exact, and a
+ * float32 has enough precision that rounding the float32 result of a
+ * single add, subtract, multiply, divide or square root gives the
+ * correctly rounded half result. Doubles are narrowed via a float32
+ * rounded to odd, so they are also only rounded once.
+ *
+ * If the target can convert between half and single precision in
+ * hardware (x86 with F16C, 64-bit ARM), the conversions are left as
+ * casts for the backend. Otherwise Float(16) values are carried
+ * around as their uint16 bits and converted in software. */
+Stmt emulate_float16_math(Stmt s, const Target &t);
+
+}
+}
+
+#endif
@@ -0,0 +1,312 @@
+#include "FindIntrinsics.h"
+#include "IREquality.h"
+#include "IRMatch.h"
+#include "IRMutator.h"
+#include "IROperator.h"
+
+namespace Halide {
+namespace Internal {
+
+using std::vector;
+
+namespace {
+
+// The integer types the intrinsics operate on.
+bool is_narrow_int_vector(Type t) {
+    return t.is_vector() && (t.is_int() || t.is_uint()) &&
+        (t.bits() == 8 || t.bits() == 16 || t.bits() == 32);
+}
+
+Type widen(Type t) {
+    return t.with_bits(t.bits() * 2);
+}
+
+// Narrow a pair of operands to the given type, if that can be done
+// without losing information.
+bool narrow_operands(Type t, Expr &a, Expr &b) {
+    a = lossless_cast(t, a);
+    b = lossless_cast(t, b);
+    return a.defined() && b.defined();
+}
+
+class FindIntrinsics : public IRMutator {
+    using IRMutator::visit;
+
+    Expr make_call(Type t, Call::ConstString intrin, vector<Expr> args) {
+        for (Expr &arg : args) {
+            arg = mutate(arg);
+        }
+        return Call::make(t, intrin, args, Call::PureIntrinsic);
+    }
+
+    // An absd written out. The absd intrinsic always returns an
+    // unsigned type, so we cast back to the original type, which
+    // wraps in the same way the original subtractions did.
+    Expr make_absd(Type t, Expr a, Expr b) {
+        Expr absd = make_call(t.with_code(Type::UInt), Call::absd, {a, b});
+        return t.is_uint() ? absd : Cast::make(t, absd);
+    }
+
+    void visit(const Cast *op) {
+        Type t = op->type;
+        Type wide = op->value.type();
+        if (!is_narrow_int_vector(t) ||
+            !(wide.is_int() || wide.is_uint()) ||
+            wide.bits() != t.bits() * 2) {
+            IRMutator::visit(op);
+            return;
+        }
+
+        Expr x = Variable::make(wide, "*");
+        Expr one = make_one(wide), two = make_const(wide, 2);
+        vector<Expr> matches;
+
+        // Rounding halving add, with the rounding term in any position.
+        const Expr rounding_halving_adds[] = {
+            Cast::make(t, Div::make(Add::make(Add::make(x, x), one), two)),
+            Cast::make(t, Div::make(Add::make(x, Add::make(x, one)), two)),
+            Cast::make(t, Div::make(Add::make(Add::make(x, one), x), two)),
+        };
+        for (const Expr &p : rounding_halving_adds) {
+            if (expr_match(p, op, matches) &&
+                narrow_operands(t, matches[0], matches[1])) {
+                expr = make_call(t, Call::rounding_halving_add, {matches[0], matches[1]});
+                return;
+            }
+        }
+
+        // Add a constant and divide by a power of two: a rounding
+        // shift if the constant is half the divisor, otherwise a
+        // halving add.
+        if (expr_match(Cast::make(t, Div::make(Add::make(x, x), x)), op, matches)) {
+            int shift = 0;
+            Expr a = lossless_cast(t, matches[0]);
+            if (a.defined() &&
+                is_const_power_of_two_integer(matches[2], &shift) &&
+                shift > 0 && shift < t.bits() &&
+                is_const(matches[1], (int64_t)1 << (shift - 1))) {
+                expr = make_call(t, Call::rounding_shift_right, {a, shift});
+                return;
+            }
+            if (is_const(matches[2], 2) &&
+                narrow_operands(t, matches[0], matches[1])) {
+                expr = make_call(t, Call::halving_add, {matches[0], matches[1]});
+                return;
+            }
+        }
+
+        // Keep the high half (or more) of a widening multiply.
+        if (expr_match(Cast::make(t, Div::make(Mul::make(x, x), x)), op, matches)) {
+            int shift = 0;
+            if (is_const_power_of_two_integer(matches[2], &shift) &&
+                shift >= t.bits() && shift < wide.bits() &&
+                narrow_operands(t, matches[0], matches[1])) {
+                expr = make_call(t, Call::mul_shift_right, {matches[0], matches[1], shift});
+                return;
+            }
+        }
+
+        // Saturating add.
+        if (expr_match(saturating_cast(t, Add::make(x, x)), op, matches) &&
+            narrow_operands(t, matches[0], matches[1])) {
+            expr = make_call(t, Call::saturating_add, {matches[0], matches[1]});
+            return;
+        }
+
+        // Saturating subtract. This needs a signed wide type for the
+        // difference not to wrap. If the result is unsigned, the upper
+        // bound of the saturation is unnecessary and is often omitted.
+        if (wide.is_int() &&
+            (expr_match(saturating_cast(t, Sub::make(x, x)), op, matches) ||
+             (t.is_uint() &&
+              expr_match(Cast::make(t, Max::make(Sub::make(x, x), make_zero(wide))), op, matches))) &&
+            narrow_operands(t, matches[0], matches[1])) {
+            expr = make_call(t, Call::saturating_sub, {matches[0], matches[1]});
+            return;
+        }
+
+        // The absolute value of a widened difference.
+        if (t.is_uint()) {
+            const Call *abs = op->value.as<Call>();
+            const Sub *sub = abs && abs->is_intrinsic(Call::abs) ? abs->args[0].as<Sub>() : nullptr;
+            // The operands may narrow to either signedness.
+            for (Type narrow : {t, t.with_code(Type::Int)}) {
+                Expr a = sub ? sub->a : Expr(), b = sub ? sub->b : Expr();
+                if (sub && narrow_operands(narrow, a, b)) {
+                    expr = make_call(t, Call::absd, {a, b});
+                    return;
+                }
+            }
+        }
+
+        // Any other saturating narrowing.
+        if (expr_match(saturating_cast(t, x), op, matches)) {
+            expr = make_call(t, Call::saturating_narrow, {matches[0]});
+            return;
+        }
+
+        IRMutator::visit(op);
+    }
+
+    void visit(const Select *op) {
+        // select(a < b, b - a, a - b), and its variants.
+        Type t = op->type;
+        const Sub *sub_a = op->true_value.as<Sub>();
+        const Sub *sub_b = op->false_value.as<Sub>();
+        if (is_narrow_int_vector(t) && sub_a && sub_b &&
+            equal(sub_a->a, sub_b->b) && equal(sub_a->b, sub_b->a)) {
+            Expr a, b;
+            if (const LT *lt = op->condition.as<LT>()) {
+                a = lt->a;
+                b = lt->b;
+            } else if (const LE *le = op->condition.as<LE>()) {
+                a = le->a;
+                b = le->b;
+            } else if (const GT *gt = op->condition.as<GT>()) {
+                a = gt->b;
+                b = gt->a;
+            } else if (const GE *ge = op->condition.as<GE>()) {
+                a = ge->b;
+                b = ge->a;
+            }
+            // Now the condition is a < b (or a <= b), so the true
+            // value should be b - a.
+            if (a.defined() && equal(sub_a->a, b) && equal(sub_a->b, a)) {
+                expr = make_absd(t, a, b);
+                return;
+            }
+        }
+        IRMutator::visit(op);
+    }
+
+    void visit(const Sub *op) {
+        // max(a, b) - min(a, b)
+        const Max *max = op->a.as<Max>();
+        const Min *min = op->b.as<Min>();
+        if (is_narrow_int_vector(op->type) && max && min &&
+            ((equal(max->a, min->a) && equal(max->b, min->b)) ||
+             (equal(max->a, min->b) && equal(max->b, min->a)))) {
+            expr = make_absd(op->type, max->a, max->b);
+            return;
+        }
+        IRMutator::visit(op);
+    }
+
+    void visit(const For *op) {
+        if (op->device_api != DeviceAPI::None &&
+            op->device_api != DeviceAPI::Host) {
+            // Device code doesn't know about these intrinsics.
+            stmt = op;
+        } else {
+            IRMutator::visit(op);
+        }
+    }
+};
+
+// Lower all of the fixed point intrinsics in an expression.
+class LowerFixedPointIntrinsics : public IRMutator {
+    using IRMutator::visit;
+
+    void visit(const Call *op) {
+        if (is_fixed_point_intrinsic(op)) {
+            expr = lower_fixed_point_intrinsic(op);
+        } else {
+            IRMutator::visit(op);
+        }
+    }
+};
+
+}  // namespace
+
+Stmt find_intrinsics(Stmt s) {
+    return FindIntrinsics().mutate(s);
+}
+
+bool is_fixed_point_intrinsic(const Call *op) {
+    return (op->is_intrinsic(Call::halving_add) ||
+            op->is_intrinsic(Call::rounding_halving_add) ||
+            op->is_intrinsic(Call::saturating_add) ||
+            op->is_intrinsic(Call::saturating_sub) ||
+            op->is_intrinsic(Call::saturating_narrow) ||
+            op->is_intrinsic(Call::rounding_shift_right) ||
+            op->is_intrinsic(Call::mul_shift_right));
+}
+
+Expr lower_fixed_point_intrinsic(const Call *op) {
+    internal_assert(is_fixed_point_intrinsic(op));
+
+    vector<Expr> args;
+    for (Expr arg : op->args) {
+        args.push_back(LowerFixedPointIntrinsics().mutate(arg));
+    }
+
+    Type t = op->type;
+    if (op->is_intrinsic(Call::saturating_narrow)) {
+        internal_assert(args.size() == 1);
+        return saturating_cast(t, args[0]);
+    }
+
+    internal_assert(args.size() >= 2);
+    Type wide = widen(t);
+    Expr a = Cast::make(wide, args[0]);
+
+    if (op->is_intrinsic(Call::rounding_shift_right)) {
+        const int64_t *shift = as_const_int(args[1]);
+        internal_assert(shift);
+        Expr round = make_const(wide, (int64_t)1 << (*shift - 1));
+        Expr divisor = make_const(wide, (int64_t)1 << *shift);
+        return Cast::make(t, Div::make(Add::make(a, round), divisor));
+    }
+
+    Expr b = Cast::make(wide, args[1]);
+    if (op->is_intrinsic(Call::halving_add)) {
+        return Cast::make(t, Div::make(Add::make(a, b), make_const(wide, 2)));
+    } else if (op->is_intrinsic(Call::rounding_halving_add)) {
+        return Cast::make(t, Div::make(Add::make(Add::make(a, b), make_one(wide)), make_const(wide, 2)));
+    } else if (op->is_intrinsic(Call::saturating_add)) {
+        return saturating_cast(t, Add::make(a, b));
+    } else if (op->is_intrinsic(Call::saturating_sub)) {
+        // The difference must be taken in a signed type.
+        Type signed_wide = wide.with_code(Type::Int);
+        a = Cast::make(signed_wide, args[0]);
+        b = Cast::make(signed_wide, args[1]);
+        if (t.is_uint()) {
+            return Cast::make(t, Max::make(Sub::make(a, b), make_zero(signed_wide)));
+        } else {
+            return saturating_cast(t, Sub::make(a, b));
+        }
+    } else {
+        internal_assert(op->is_intrinsic(Call::mul_shift_right) && args.size() == 3);
+        const int64_t *shift = as_const_int(args[2]);
+        internal_assert(shift);
+        Expr divisor = make_const(wide, (int64_t)1 << *shift);
+        return Cast::make(t, Div::make(Mul::make(a, b), divisor));
+    }
+}
+
+namespace {
+
+bool match_widening(Expr e, Expr ea, Expr eb, Expr &a, Expr &b) {
+    Type t = e.type();
+    if (!(t.is_int() || t.is_uint()) || t.bits() < 16) {
+        return false;
+    }
+    a = ea;
+    b = eb;
+    return narrow_operands(t.with_bits(t.bits() / 2), a, b);
+}
+
+}  // namespace
+
+bool match_widening_mul(Expr e, Expr &a, Expr &b) {
+    const Mul *mul = e.as<Mul>();
+    return mul && match_widening(e, mul->a, mul->b, a, b);
+}
+
+bool match_widening_add(Expr e, Expr &a, Expr &b) {
+    const Add *add = e.as<Add>();
+    return add && match_widening(e, add->a, add->b, a, b);
+}
+
+}  // namespace Internal
+}  // namespace Halide
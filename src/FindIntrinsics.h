@@ -0,0 +1,58 @@
+#ifndef HALIDE_FIND_INTRINSICS_H
+#define HALIDE_FIND_INTRINSICS_H
+
+/** \file
+ * Defines a lowering pass that recognizes the widening and narrowing
+ * fixed-point arithmetic idioms that SIMD instruction sets implement
+ * directly, and the intrinsics it rewrites them to.
+ */
+
+#include "IR.h"
+
+namespace Halide {
+namespace Internal {
+
+/** Rewrite vector integer arithmetic that is computed in a wider
+ * type and then narrowed into intrinsics on the narrow
+ * operands. Recognized idioms are:
+ *
+ * halving_add(a, b): narrow((widen(a) + widen(b)) / 2)
+ * rounding_halving_add(a, b): narrow((widen(a) + widen(b) + 1) / 2)
+ * saturating_add(a, b): saturating_cast(widen(a) + widen(b))
+ * saturating_sub(a, b): saturating_cast(widen(a) - widen(b))
+ * saturating_narrow(x): saturating_cast(x)
+ * rounding_shift_right(a, n): narrow((widen(a) + 2^(n-1)) / 2^n)
+ * mul_shift_right(a, b, n): narrow((widen(a) * widen(b)) / 2^n), for n
+ * at least the width of a
+ *
+ * It also finds the absolute difference written as a select, as
+ * max(a, b) - min(a, b), or as narrow(abs(widen(a) - widen(b))), and
+ * rewrites it to the absd intrinsic. Loops that run on a device are
+ * left alone. */
+EXPORT Stmt find_intrinsics(Stmt s);
+
+/** Check if a call is to one of the intrinsics introduced by
+ * find_intrinsics (other than absd). */
+bool is_fixed_point_intrinsic(const Call *op);
+
+/** Rewrite a call to one of the intrinsics introduced by
+ * find_intrinsics (other than absd) back into the arithmetic it came
+ * from, including any such calls in its arguments. The result is in
+ * the form that the backends' peephole patterns expect, so targets
+ * without a better instruction get the same code as they would
+ * have without find_intrinsics. */
+Expr lower_fixed_point_intrinsic(const Call *op);
+
+/** Match a multiply or add in a type that both operands can be
+ * losslessly narrowed to half the width of, with the same
+ * signedness. On success, a and b are set to the narrowed
+ * operands. */
+// @{
+bool match_widening_mul(Expr e, Expr &a, Expr &b);
+bool match_widening_add(Expr e, Expr &a, Expr &b);
+// @}
+
+}  // namespace Internal
+}  // namespace Halide
+
+#endif
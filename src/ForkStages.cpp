@@ -0,0 +1,238 @@
+#include <algorithm>
+
+#include "ForkStages.h"
+#include "IRMutator.h"
+#include "IROperator.h"
+#include "Debug.h"
+#include "ExprUsesVar.h"
+
+namespace Halide {
+namespace Internal {
+
+using std::string;
+using std::vector;
+
+namespace {
+
+// Does some IR refer to a buffer (or any of its metadata) with one of
+// the given names?
+class UsesBuffers : public IRVisitor {
+    const vector<string> &names;
+
+    void check(const string &n) {
+        for (const string &b : names) {
+            if (n == b || starts_with(n, b + ".")) {
+                result = true;
+                return;
+            }
+        }
+    }
+
+    using IRVisitor::visit;
+
+    void visit(const Variable *op) {
+        check(op->name);
+    }
+
+    void visit(const Load *op) {
+        check(op->name);
+        IRVisitor::visit(op);
+    }
+
+    void visit(const Store *op) {
+        check(op->name);
+        IRVisitor::visit(op);
+    }
+
+    void visit(const Call *op) {
+        check(op->name);
+        IRVisitor::visit(op);
+    }
+
+    void visit(const Allocate *op) {
+        check(op->name);
+        IRVisitor::visit(op);
+    }
+
+    void visit(const Free *op) {
+        check(op->name);
+    }
+
+    void visit(const ProducerConsumer *op) {
+        check(op->name);
+        IRVisitor::visit(op);
+    }
+
+public:
+    bool result;
+    UsesBuffers(const vector<string> &n) : names(n), result(false) {}
+};
+
+template<typename StmtOrExpr>
+bool uses_buffers(StmtOrExpr s, const vector<string> &names) {
+    if (!s.defined()) return false;
+    UsesBuffers uses(names);
+    s.accept(&uses);
+    return uses.result;
+}
+
+// Stages that launch device code or offload are left alone. Their
+// runtimes serialize on the device anyway.
+class HasDeviceLoop : public IRVisitor {
+    using IRVisitor::visit;
+
+    void visit(const For *op) {
+        if (op->device_api != DeviceAPI::Host &&
+            op->device_api != DeviceAPI::None) {
+            result = true;
+        } else {
+            IRVisitor::visit(op);
+        }
+    }
+
+public:
+    bool result;
+    HasDeviceLoop() : result(false) {}
+};
+
+bool has_device_loop(Stmt s) {
+    HasDeviceLoop h;
+    s.accept(&h);
+    return h.result;
+}
+
+// Matches Block(produce f, consume f), which is the shape
+// build_pipeline in ScheduleFunctions emits for every stage.
+bool is_stage(Stmt s, const ProducerConsumer **produce, const ProducerConsumer **consume) {
+    const Block *b = s.as<Block>();
+    if (!b) return false;
+    const ProducerConsumer *p = b->first.as<ProducerConsumer>();
+    const ProducerConsumer *c = b->rest.as<ProducerConsumer>();
+    if (p && c && p->is_producer && !c->is_producer && p->name == c->name) {
+        *produce = p;
+        *consume = c;
+        return true;
+    }
+    return false;
+}
+
+class ForkStages : public IRMutator {
+    using IRMutator::visit;
+
+    void visit(const Block *op) {
+        const ProducerConsumer *produce = nullptr, *consume = nullptr;
+        if (!is_stage(op, &produce, &consume) ||
+            has_device_loop(produce)) {
+            IRMutator::visit(op);
+            return;
+        }
+
+        vector<Stmt> producers = {produce->body};
+        vector<string> names = {produce->name};
+
+        // Extend the run one stage at a time, stopping at the first
+        // stage that touches the buffers of one already in it. Later
+        // stages that would have been independent are left for the
+        // next run.
+
+        // The LetStmts and Allocates found between one stage and the
+        // next. Those up to the last accepted producer get hoisted
+        // outside the fork; the rest stay where they are.
+        vector<Stmt> wrappers;
+        size_t hoisted = 0;
+        Stmt body = consume->body, rest = body;
+
+        while (true) {
+            if (const LetStmt *let = body.as<LetStmt>()) {
+                if (uses_buffers(let->value, names) ||
+                    std::any_of(producers.begin(), producers.end(),
+                                [&](Stmt p) { return stmt_uses_var(p, let->name); })) {
+                    break;
+                }
+                wrappers.push_back(let);
+                body = let->body;
+            } else if (const Allocate *alloc = body.as<Allocate>()) {
+                bool ok = !uses_buffers(alloc->condition, names) &&
+                    !uses_buffers(alloc->new_expr, names);
+                for (Expr e : alloc->extents) {
+                    ok = ok && !uses_buffers(e, names);
+                }
+                vector<string> alloc_name = {alloc->name};
+                for (Stmt p : producers) {
+                    ok = ok && !uses_buffers(p, alloc_name);
+                }
+                if (!ok) break;
+                wrappers.push_back(alloc);
+                body = alloc->body;
+            } else if (is_stage(body, &produce, &consume) &&
+                       !has_device_loop(produce) &&
+                       !uses_buffers(Stmt(produce), names)) {
+                vector<string> this_name = {produce->name};
+                bool ok = true;
+                for (Stmt p : producers) {
+                    ok = ok && !uses_buffers(p, this_name);
+                }
+                if (!ok) break;
+                producers.push_back(produce->body);
+                names.push_back(produce->name);
+                hoisted = wrappers.size();
+                body = consume->body;
+                rest = body;
+            } else {
+                break;
+            }
+        }
+
+        if (producers.size() < 2) {
+            IRMutator::visit(op);
+            return;
+        }
+
+        debug(3) << "Running " << producers.size() << " stages concurrently, starting with "
+                 << names[0] << "\n";
+
+        // Run each producer as one task of a parallel loop.
+        string task_name = unique_name("fork_" + names[0]);
+        Expr task = Variable::make(Int(32), task_name);
+        Stmt tasks;
+        for (size_t i = producers.size(); i > 0; i--) {
+            Stmt p = ProducerConsumer::make(names[i-1], true, mutate(producers[i-1]));
+            if (!tasks.defined()) {
+                tasks = p;
+            } else {
+                tasks = IfThenElse::make(task == (int)(i-1), p, tasks);
+            }
+        }
+        Stmt fork = For::make(task_name, 0, (int)producers.size(),
+                              ForType::Parallel, DeviceAPI::None, tasks);
+
+        // The innermost consumer keeps any wrappers we didn't hoist.
+        Stmt consumers = mutate(rest);
+        for (size_t i = names.size(); i > 0; i--) {
+            consumers = ProducerConsumer::make(names[i-1], false, consumers);
+        }
+
+        Stmt result = Block::make(fork, consumers);
+        for (size_t i = hoisted; i > 0; i--) {
+            if (const LetStmt *let = wrappers[i-1].as<LetStmt>()) {
+                result = LetStmt::make(let->name, let->value, result);
+            } else {
+                const Allocate *alloc = wrappers[i-1].as<Allocate>();
+                internal_assert(alloc);
+                result = Allocate::make(alloc->name, alloc->type, alloc->extents,
+                                        alloc->condition, result,
+                                        alloc->new_expr, alloc->free_function);
+            }
+        }
+        stmt = result;
+    }
+};
+
+}  // namespace
+
+Stmt fork_independent_stages(Stmt s) {
+    return ForkStages().mutate(s);
+}
+
+}
+}
@@ -0,0 +1,30 @@
+#ifndef HALIDE_FORK_STAGES_H
+#define HALIDE_FORK_STAGES_H
+
+/** \file
+ * Defines the lowering pass that runs independent sibling stages
+ * concurrently.
+ */
+
+#include "IR.h"
+
+namespace Halide {
+namespace Internal {
+
+/** The realization order is a strict total order, so stages that do
+ * not depend on each other are still produced one after the
+ * other. This pass finds runs of consecutive producers at the same
+ * loop level where no producer reads or writes the buffers of
+ * another, hoists the allocations between them, and wraps the
+ * producers in a single parallel loop over the stages, so that they
+ * execute concurrently on the thread pool. Only stages that are
+ * adjacent in the realization order are forked together; stages are
+ * never reordered, so two independent stages with a stage between
+ * them that depends on the first still run one after the other. Must
+ * be run after storage flattening. */
+Stmt fork_independent_stages(Stmt s);
+
+}
+}
+
+#endif
@@ -265,6 +265,26 @@ bool var_name_match(string candidate, string var) {
     if (candidate == var) return true;
     return Internal::ends_with(candidate, "." + var);
 }
+
+// Check if an update is an associative update of a location that
+// doesn't depend on the reduction domain, such as a sum. Vectorizing
+// these along the reduction domain is done with horizontal
+// reductions, or one lane at a time where those aren't available
+// (e.g. Hexagon and GPU loops), so there's no race.
+bool is_horizontal_reduction(const Definition &def, const string &stage_name) {
+    if (def.values().size() != 1) {
+        return false;
+    }
+    for (const ReductionVariable &rv : def.schedule().rvars()) {
+        for (Expr arg : def.args()) {
+            if (expr_uses_var(arg, rv.var)) {
+                return false;
+            }
+        }
+    }
+    string func_name = stage_name.substr(0, stage_name.find(".update("));
+    return prove_associativity(func_name, def.args(), def.values()).first;
+}
 }
 
 const std::string &Stage::name() const {
@@ -282,7 +302,9 @@ void Stage::set_dim_type(VarOrRVar var, ForType t) {
             // If it's an rvar and the for type is parallel, we need to
             // validate that this doesn't introduce a race condition.
             if (!dims[i].is_pure() && var.is_rvar && (t == ForType::Vectorized || t == ForType::Parallel)) {
-                user_assert(definition.schedule().allow_race_conditions())
+                bool horizontal_reduction =
+                    t == ForType::Vectorized && is_horizontal_reduction(definition, stage_name);
+                user_assert(definition.schedule().allow_race_conditions() || horizontal_reduction)
                     << "In schedule for " << stage_name
                     << ", marking var " << var.name()
                     << " as parallel or vectorized may introduce a race"
@@ -295,12 +317,6 @@ void Stage::set_dim_type(VarOrRVar var, ForType t) {
                     << " the output, or you can prove that there are actually"
                     << " no race conditions, and that Halide is being too cautious.\n";
             }
-
-        } else if (t == ForType::Vectorized) {
-            user_assert(dims[i].for_type != ForType::Vectorized)
-                << "In schedule for " << stage_name
-                << ", can't vectorize across " << var.name()
-                << " because Func is already vectorized across " << dims[i].var << "\n";
         }
     }
 
@@ -1230,6 +1246,16 @@ Stage &Stage::tile(VarOrRVar x, VarOrRVar y,
     return *this;
 }
 
+Stage &Stage::transpose_tile(VarOrRVar x, VarOrRVar y, int n, TailStrategy tail) {
+    user_assert(n >= 2) << "The tile size passed to transpose_tile must be at least two.\n";
+    VarOrRVar xi = x.is_rvar ? VarOrRVar(RVar()) : VarOrRVar(Var());
+    VarOrRVar yi = y.is_rvar ? VarOrRVar(RVar()) : VarOrRVar(Var());
+    tile(x, y, xi, yi, n, n, tail);
+    vectorize(xi);
+    unroll(yi);
+    return *this;
+}
+
 namespace {
 // An helper function for reordering vars in a schedule.
 void reorder_vars(vector<Dim> &dims_old, const VarOrRVar *vars, size_t size, const Stage &stage) {
@@ -1713,6 +1739,12 @@ Func &Func::tile(VarOrRVar x, VarOrRVar y,
     return *this;
 }
 
+Func &Func::transpose_tile(VarOrRVar x, VarOrRVar y, int n, TailStrategy tail) {
+    invalidate_cache();
+    Stage(func.definition(), name(), args(), func.schedule().storage_dims()).transpose_tile(x, y, n, tail);
+    return *this;
+}
+
 Func &Func::reorder(const std::vector<VarOrRVar> &vars) {
     invalidate_cache();
     Stage(func.definition(), name(), args(), func.schedule().storage_dims()).reorder(vars);
@@ -1914,6 +1946,26 @@ Func &Func::fold_storage(Var dim, Expr factor, bool fold_forward) {
     return *this;
 }
 
+Func &Func::fold_storage(const std::vector<Var> &dims,
+                         const std::vector<Expr> &extents,
+                         bool fold_forward) {
+    user_assert(dims.size() == extents.size())
+        << "fold_storage was given " << dims.size() << " dimensions but "
+        << extents.size() << " extents.\n";
+    for (size_t i = 0; i < dims.size(); i++) {
+        fold_storage(dims[i], extents[i], fold_forward);
+    }
+    return *this;
+}
+
+Func &Func::sliding_strip(Expr size) {
+    invalidate_cache();
+    user_assert(size.defined() && (size.type().is_int() || size.type().is_uint()))
+        << "The strip size passed to sliding_strip must be an integer.\n";
+    func.schedule().sliding_strip() = cast<int>(size);
+    return *this;
+}
+
 Func &Func::compute_at(LoopLevel loop_level) {
     invalidate_cache();
     func.schedule().compute_level() = loop_level;
@@ -1957,6 +2009,26 @@ Func &Func::compute_inline() {
     return compute_at(LoopLevel());
 }
 
+Func &Func::fuse_group(const std::vector<Func> &stages,
+                       VarOrRVar x, VarOrRVar y,
+                       VarOrRVar xo, VarOrRVar yo,
+                       VarOrRVar xi, VarOrRVar yi,
+                       Expr xfactor, Expr yfactor) {
+    invalidate_cache();
+    tile(x, y, xo, yo, xi, yi, xfactor, yfactor);
+    LoopLevel tile_level(*this, xo);
+    for (Func f : stages) {
+        user_assert(f.name() != name())
+            << "Func " << name() << " cannot be a member of its own fuse group.\n";
+        user_assert(!f.function().schedule().memoized())
+            << "Func " << f.name() << " is memoized, so it cannot be part of the fuse group of "
+            << name() << ".\n";
+        f.compute_at(tile_level).store_at(tile_level);
+        f.function().schedule().fuse_group() = name();
+    }
+    return *this;
+}
+
 Func &Func::trace_loads() {
     invalidate_cache();
     func.trace_loads();
@@ -186,6 +186,8 @@ public:
                        VarOrRVar xi, VarOrRVar yi,
                        Expr xfactor, Expr yfactor,
                        TailStrategy tail = TailStrategy::Auto);
+    EXPORT Stage &transpose_tile(VarOrRVar x, VarOrRVar y, int n,
+                                 TailStrategy tail = TailStrategy::Auto);
     EXPORT Stage &reorder(const std::vector<VarOrRVar> &vars);
 
     template <typename... Args>
@@ -1084,7 +1086,9 @@ public:
      * e.g. because it is the inner dimension following a split by a
      * constant factor. For most uses of vectorize you want the two
      * argument form. The variable to be vectorized should be the
-     * innermost one. */
+     * innermost one. Two vectorized dimensions that are adjacent in
+     * the loop nest are fused into a single vector, with the lanes
+     * of the inner one varying fastest. */
     EXPORT Func &vectorize(VarOrRVar var);
 
     /** Mark a dimension to be completely unrolled. The dimension
@@ -1150,6 +1154,28 @@ public:
                       Expr xfactor, Expr yfactor,
                       TailStrategy tail = TailStrategy::Auto);
 
+    /** Split x and y into n x n tiles, vectorize across each row of a
+     * tile and unroll across the rows. After this call, x and y refer
+     * to the outer dimensions of the splits. If the definition reads
+     * a transposed input, e.g. f(x, y) = g(y, x), each row of the tile
+     * reads a column of a block of g. The lowering recognizes such
+     * blocks, loads their rows as dense vectors, and transposes them
+     * in registers with vector shuffles. n should be a power of two
+     * or a small odd number no larger than the native vector width,
+     * for example:
+     *
+     \code
+     Func f;
+     f(x, y) = g(y, x);
+     f.transpose_tile(x, y, 8);
+     \endcode
+     *
+     * The same lowering turns the strided loads of a packed to planar
+     * conversion (unroll the channels and vectorize x) into dense
+     * loads and shuffles, so that case needs no directive. */
+    EXPORT Func &transpose_tile(VarOrRVar x, VarOrRVar y, int n,
+                                TailStrategy tail = TailStrategy::Auto);
+
     /** Reorder variables to have the given nesting order, from
      * innermost out */
     EXPORT Func &reorder(const std::vector<VarOrRVar> &vars);
@@ -1497,8 +1523,9 @@ public:
     EXPORT Func &align_storage(Var dim, Expr alignment);
 
     /** Store realizations of this function in a circular buffer of a
-     * given extent. This is more efficient when the extent of the
-     * circular buffer is a power of 2. If the fold factor is too
+     * given extent. Any extent works; indexing is cheapest when the
+     * extent of the circular buffer is a power of 2, at the cost of
+     * a larger buffer. If the fold factor is too
      * small, or the dimension is not accessed monotonically, the
      * pipeline will generate an error at runtime.
      *
@@ -1528,6 +1555,43 @@ public:
      */
     EXPORT Func &fold_storage(Var dim, Expr extent, bool fold_forward = true);
 
+    /** Store realizations of this function in a buffer that is
+     * circular in several dimensions at once. The i'th dimension is
+     * folded by the i'th extent. This is useful when a producer is
+     * computed at a loop over which its footprint slides in more
+     * than one dimension, e.g. along a diagonal, or over a fused
+     * loop of tiles. Each folded dimension must be accessed
+     * monotonically over the same loop. */
+    EXPORT Func &fold_storage(const std::vector<Var> &dims,
+                              const std::vector<Expr> &extents,
+                              bool fold_forward = true);
+
+    /** Control how a parallel loop between the store and compute
+     * levels of this function is split so that this function can be
+     * slid over it. Sliding window optimization requires that the
+     * iterations it slides over run in order, so a parallel loop is
+     * split into strips of the given number of iterations. The
+     * strips run in parallel, each with its own storage, and the
+     * first iteration of each strip computes the entire window of
+     * this function required before the rest slide. Larger strips
+     * recompute less at strip boundaries, but expose less
+     * parallelism. If no strip size is given, one is chosen based
+     * on the extent of the loop. A strip size of 1 turns this off.
+     *
+     * For example, in the pipeline:
+     \code
+     Func f, g;
+     Var x, y;
+     g(x, y) = x*y;
+     f(x, y) = g(x, y-1) + g(x, y) + g(x, y+1);
+     f.parallel(y);
+     g.store_root().compute_at(f, y).sliding_strip(32);
+     \endcode
+     *
+     * each thread computes 32 rows of f at a time, computing 34 rows
+     * of g for them instead of 96. */
+    EXPORT Func &sliding_strip(Expr size);
+
     /** Compute this function as needed for each unique value of the
      * given var for the given calling function f.
      *
@@ -1788,6 +1852,34 @@ public:
      */
     EXPORT Func &compute_inline();
 
+    /** Fuse a chain of stencils into the tiles of this Func. This
+     * Func is tiled by the given factors, and every Func in stages is
+     * computed and stored within each tile (overlapped tiling). Bounds
+     * inference sizes the halo each stage needs from the stencil
+     * footprints of its consumers, so each tile recomputes only the
+     * overlap it requires. The intermediates of the group are then
+     * packed into one scratch allocation per tile, with stages whose
+     * lifetimes don't overlap sharing the same memory, so the working
+     * set of a deep chain stays close to that of two stages.
+     *
+     * For example, for a chain of blurs:
+     \code
+     Func b0, b1, b2, out;
+     b0(x, y) = (in(x-1, y) + in(x, y) + in(x+1, y)) / 3;
+     b1(x, y) = (b0(x, y-1) + b0(x, y) + b0(x, y+1)) / 3;
+     b2(x, y) = (b1(x-1, y) + b1(x, y) + b1(x+1, y)) / 3;
+     out(x, y) = (b2(x, y-1) + b2(x, y) + b2(x, y+1)) / 3;
+     out.fuse_group({b0, b1, b2}, x, y, xo, yo, xi, yi, 64, 32);
+     \endcode
+     *
+     * b0 and b2 are never live at the same time within a tile, so
+     * they occupy the same region of the tile's scratch buffer. */
+    EXPORT Func &fuse_group(const std::vector<Func> &stages,
+                            VarOrRVar x, VarOrRVar y,
+                            VarOrRVar xo, VarOrRVar yo,
+                            VarOrRVar xi, VarOrRVar yi,
+                            Expr xfactor, Expr yfactor);
+
     /** Get a handle on an update step for the purposes of scheduling
      * it. */
     EXPORT Stage update(int idx = 0);
@@ -116,11 +116,14 @@ const std::map<std::string, Halide::Type> &get_halide_type_enum_map() {
 
 int generate_filter_main(int argc, char **argv, std::ostream &cerr) {
     const char kUsage[] = "gengen [-g GENERATOR_NAME] [-f FUNCTION_NAME] [-o OUTPUT_DIR] [-r RUNTIME_NAME] [-e EMIT_OPTIONS] [-x EXTENSION_OPTIONS] [-n FILE_BASE_NAME] "
-                          "target=target-string[,target-string...] [generator_arg=value [...]]\n\n"
+                          "[-p PARAM_PROFILE [-k TOP_K]] target=target-string[,target-string...] [generator_arg=value [...]]\n\n"
                           "  -e  A comma separated list of files to emit. Accepted values are "
                           "[assembly, bitcode, cpp, h, html, o, static_library, stmt]. If omitted, default value is [static_library, h].\n"
                           "  -x  A comma separated list of file extension (or file-suffix) pairs to substitute during file naming, "
-                          "in the form [.old=.new[,.old2=.new2]]\n";
+                          "in the form [.old=.new[,.old2=.new2]]\n"
+                          "  -p  A parameter profile recorded by pipelines compiled with the profile_params target feature. "
+                          "The output is specialized on the most common values of each parameter.\n"
+                          "  -k  The number of values of each parameter to specialize on. If omitted, default value is 2.\n";
 
     std::map<std::string, std::string> flags_info = { { "-f", "" },
                                                       { "-g", "" },
@@ -128,7 +131,9 @@ int generate_filter_main(int argc, char **argv, std::ostream &cerr) {
                                                       { "-e", "" },
                                                       { "-n", "" },
                                                       { "-x", "" },
-                                                      { "-r", "" }};
+                                                      { "-r", "" },
+                                                      { "-p", "" },
+                                                      { "-k", "" }};
     std::map<std::string, std::string> generator_args;
 
     for (int i = 1; i < argc; ++i) {
@@ -245,6 +250,21 @@ int generate_filter_main(int argc, char **argv, std::ostream &cerr) {
         emit_options.substitutions[subst_pair[0]] = subst_pair[1];
     }
 
+    ParamProfile param_profile;
+    int param_profile_top_k = 0;
+    if (!flags_info["-p"].empty()) {
+        param_profile.load(flags_info["-p"]);
+        param_profile_top_k = 2;
+        if (!flags_info["-k"].empty()) {
+            std::istringstream top_k(flags_info["-k"]);
+            if (!(top_k >> param_profile_top_k) || param_profile_top_k < 0) {
+                cerr << "Malformed -k option: " << flags_info["-k"] << "\n";
+                cerr << kUsage;
+                return 1;
+            }
+        }
+    }
+
     const auto target_string = generator_args["target"];
     auto target_strings = split_string(target_string, ",");
     std::vector<Target> targets;
@@ -265,7 +285,7 @@ int generate_filter_main(int argc, char **argv, std::ostream &cerr) {
     if (!generator_name.empty()) {
         std::string base_path = compute_base_path(output_dir, function_name, file_base_name);
         Outputs output_files = compute_outputs(targets[0], base_path, emit_options);
-        auto module_producer = [&generator_name, &generator_args, &cerr]
+        auto module_producer = [&generator_name, &generator_args, &param_profile, param_profile_top_k, &cerr]
             (const std::string &name, const Target &target) -> Module {
                 auto sub_generator_args = generator_args;
                 sub_generator_args["target"] = target.to_string();
@@ -275,6 +295,9 @@ int generate_filter_main(int argc, char **argv, std::ostream &cerr) {
                     cerr << "Unknown generator: " << generator_name << "\n";
                     exit(1);
                 }
+                if (param_profile_top_k > 0) {
+                    gen->use_param_profile(param_profile, param_profile_top_k);
+                }
                 return gen->build_module(name);
             };
         if (targets.size() > 1 || !emit_options.substitutions.empty()) {
@@ -409,10 +432,22 @@ void GeneratorBase::set_generator_param_values(const std::map<std::string, std::
     generator_params_set = true;
 }
 
+void GeneratorBase::use_param_profile(const ParamProfile &profile, int top_k) {
+    param_profile = profile;
+    param_profile_top_k = top_k;
+}
+
 Module GeneratorBase::build_module(const std::string &function_name,
                                    const LoweredFunc::LinkageType linkage_type) {
     build_params();
     Pipeline pipeline = build_pipeline();
+    if (param_profile_top_k > 0) {
+        std::vector<Function> outputs;
+        for (Func f : pipeline.outputs()) {
+            outputs.push_back(f.function());
+        }
+        specialize_on_param_profile(outputs, function_name, param_profile, param_profile_top_k);
+    }
     // Building the pipeline may mutate the params and imageparams, so force a rebuild.
     build_params(true);
     return pipeline.compile_to_module(filter_arguments, function_name, target, linkage_type);
@@ -97,6 +97,7 @@
 #include "Func.h"
 #include "ObjectInstanceRegistry.h"
 #include "Introspection.h"
+#include "ParamProfiling.h"
 #include "Target.h"
 
 namespace Halide {
@@ -572,6 +573,11 @@ public:
         return get_target().natural_vector_size<data_t>();
     }
 
+    /** Specialize the pipeline on the top_k most common values of
+     * each of its parameters in a profile recorded with the
+     * profile_params target feature, when building the module. */
+    EXPORT void use_param_profile(const ParamProfile &profile, int top_k);
+
     // Call build() and produce a Module for the result.
     // If function_name is empty, generator_name() will be used for the function.
     EXPORT Module build_module(const std::string &function_name = "",
@@ -589,6 +595,8 @@ private:
     std::vector<Argument> filter_arguments;
     bool params_built{false};
     bool generator_params_set{false};
+    ParamProfile param_profile;
+    int param_profile_top_k{0};
 
     EXPORT void build_params(bool force = false);
 
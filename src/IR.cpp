@@ -229,9 +229,22 @@ Expr Select::make(Expr condition, Expr true_value, Expr false_value) {
     return node;
 }
 
-Expr Load::make(Type type, std::string name, Expr index, BufferPtr image, Parameter param) {
+namespace {
+// The predicate of an unpredicated load or store.
+Expr all_lanes_true(int lanes) {
+    Expr t = UIntImm::make(Bool(), 1);
+    return lanes > 1 ? Broadcast::make(t, lanes) : t;
+}
+}
+
+Expr Load::make(Type type, std::string name, Expr index, BufferPtr image, Parameter param, Expr predicate) {
     internal_assert(index.defined()) << "Load of undefined\n";
     internal_assert(type.lanes() == index.type().lanes()) << "Vector lanes of Load must match vector lanes of index\n";
+    if (!predicate.defined()) {
+        predicate = all_lanes_true(type.lanes());
+    }
+    internal_assert(predicate.type() == Bool(type.lanes()))
+        << "Predicate of Load must be a boolean with the same vector lanes as the Load\n";
 
     Load *node = new Load;
     node->type = type;
@@ -239,6 +252,7 @@ Expr Load::make(Type type, std::string name, Expr index, BufferPtr image, Parame
     node->index = index;
     node->image = image;
     node->param = param;
+    node->predicate = predicate;
     return node;
 }
 
@@ -330,15 +344,21 @@ Stmt For::make(std::string name, Expr min, Expr extent, ForType for_type, Device
     return node;
 }
 
-Stmt Store::make(std::string name, Expr value, Expr index, Parameter param) {
+Stmt Store::make(std::string name, Expr value, Expr index, Parameter param, Expr predicate) {
     internal_assert(value.defined()) << "Store of undefined\n";
     internal_assert(index.defined()) << "Store of undefined\n";
+    if (!predicate.defined()) {
+        predicate = all_lanes_true(value.type().lanes());
+    }
+    internal_assert(predicate.type() == Bool(value.type().lanes()))
+        << "Predicate of Store must be a boolean with the same vector lanes as the value\n";
 
     Store *node = new Store;
     node->name = name;
     node->value = value;
     node->index = index;
     node->param = param;
+    node->predicate = predicate;
     return node;
 }
 
@@ -630,5 +650,18 @@ Call::ConstString Call::indeterminate_expression = "indeterminate_expression";
 Call::ConstString Call::bool_to_mask = "bool_to_mask";
 Call::ConstString Call::cast_mask = "cast_mask";
 Call::ConstString Call::select_mask = "select_mask";
+Call::ConstString Call::vector_reduce_add = "vector_reduce_add";
+Call::ConstString Call::vector_reduce_mul = "vector_reduce_mul";
+Call::ConstString Call::vector_reduce_min = "vector_reduce_min";
+Call::ConstString Call::vector_reduce_max = "vector_reduce_max";
+Call::ConstString Call::vector_reduce_and = "vector_reduce_and";
+Call::ConstString Call::vector_reduce_or = "vector_reduce_or";
+Call::ConstString Call::halving_add = "halving_add";
+Call::ConstString Call::rounding_halving_add = "rounding_halving_add";
+Call::ConstString Call::saturating_add = "saturating_add";
+Call::ConstString Call::saturating_sub = "saturating_sub";
+Call::ConstString Call::saturating_narrow = "saturating_narrow";
+Call::ConstString Call::rounding_shift_right = "rounding_shift_right";
+Call::ConstString Call::mul_shift_right = "mul_shift_right";
 }
 }
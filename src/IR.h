@@ -205,7 +205,14 @@ struct Load : public ExprNode<Load> {
     // If it's a load from an image parameter, this points to that
     Parameter param;
 
-    EXPORT static Expr make(Type type, std::string name, Expr index, BufferPtr image, Parameter param);
+    // The lanes of the load that are actually performed. The other
+    // lanes are undefined, and are not read from memory, so they may
+    // be out of bounds. A predicate of true (the default) means a
+    // regular load.
+    Expr predicate;
+
+    EXPORT static Expr make(Type type, std::string name, Expr index, BufferPtr image,
+                            Parameter param, Expr predicate = Expr());
 
     static const IRNodeType _type_info = IRNodeType::Load;
 };
@@ -301,8 +308,12 @@ struct Store : public StmtNode<Store> {
     Expr value, index;
     // If it's a store to an output buffer, then this parameter points to it.
     Parameter param;
+    // The lanes of the value that are actually written. A predicate
+    // of true (the default) means a regular store.
+    Expr predicate;
 
-    EXPORT static Stmt make(std::string name, Expr value, Expr index, Parameter param);
+    EXPORT static Stmt make(std::string name, Expr value, Expr index, Parameter param,
+                            Expr predicate = Expr());
 
     static const IRNodeType _type_info = IRNodeType::Store;
 };
@@ -509,7 +520,20 @@ struct Call : public ExprNode<Call> {
         indeterminate_expression,
         bool_to_mask,
         cast_mask,
-        select_mask;
+        select_mask,
+        vector_reduce_add,
+        vector_reduce_mul,
+        vector_reduce_min,
+        vector_reduce_max,
+        vector_reduce_and,
+        vector_reduce_or,
+        halving_add,
+        rounding_halving_add,
+        saturating_add,
+        saturating_sub,
+        saturating_narrow,
+        rounding_shift_right,
+        mul_shift_right;
 
     // If it's a call to another halide function, this call node holds
     // onto a pointer to that function for the purposes of reference
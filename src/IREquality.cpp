@@ -299,6 +299,7 @@ void IRComparer::visit(const Load *op) {
     const Load *e = expr.as<Load>();
     compare_names(op->name, e->name);
     compare_expr(e->index, op->index);
+    compare_expr(e->predicate, op->predicate);
 }
 
 void IRComparer::visit(const Ramp *op) {
@@ -370,6 +371,7 @@ void IRComparer::visit(const Store *op) {
 
     compare_expr(s->value, op->value);
     compare_expr(s->index, op->index);
+    compare_expr(s->predicate, op->predicate);
 }
 
 void IRComparer::visit(const Provide *op) {
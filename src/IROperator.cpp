@@ -2,6 +2,7 @@
 #include <sstream>
 #include <cmath>
 #include <algorithm>
+#include <limits>
 
 #include "IROperator.h"
 #include "IRPrinter.h"
@@ -573,6 +574,241 @@ Expr halide_erf(Expr x_full) {
     return result;
 }
 
+namespace {
+
+// A polynomial approximation, and the largest error in ULPs measured
+// for the function that uses it, over the range of inputs documented
+// with the corresponding fast_ function in IROperator.h. The
+// coefficients are in the order evaluate_polynomial expects.
+struct PolynomialApproximation {
+    int max_ulp_error;
+    std::vector<float> coeff;
+};
+
+// Pick the cheapest approximation in a table ordered from least to
+// most accurate that meets the requested bound, or the most accurate
+// one if none do.
+const PolynomialApproximation &choose_approximation(const std::vector<PolynomialApproximation> &table,
+                                                    int max_ulp_error) {
+    for (const PolynomialApproximation &a : table) {
+        if (a.max_ulp_error <= max_ulp_error) {
+            return a;
+        }
+    }
+    return table.back();
+}
+
+Expr evaluate_approximation(Expr x, const PolynomialApproximation &a) {
+    std::vector<float> coeff = a.coeff;
+    return evaluate_polynomial(x, coeff.data(), (int)coeff.size());
+}
+
+// ln(2) split into a part with few enough bits that multiplying it by
+// the exponent is exact, and the remainder.
+const float ln2_hi = 0.693145751953125f;
+const float ln2_lo = 1.428606765330187e-06f;
+
+Expr sin_or_cos(Expr x, int max_ulp_error, bool is_cos) {
+    Type type = x.type();
+    internal_assert(type.element_of() == Float(32));
+
+    static const std::vector<PolynomialApproximation> sin_table = {
+        {26, {0.00816328079f, -0.166633904f}},
+        {3, {-0.00019515281f, 0.0083321603f, -0.166666552f}}};
+    static const std::vector<PolynomialApproximation> cos_table = {
+        {26, {-0.00136487116f, 0.0416610725f}},
+        {3, {2.4433155e-05f, -0.00138873165f, 0.0416666456f}}};
+
+    // Reduce the argument to [-pi/4, pi/4] by subtracting a multiple
+    // k of pi/2. pi/2 is split into four parts, the first three of
+    // which have 12 bits, so the products with k are exact for |k| <
+    // 4096.
+    Expr k_real = floor(x * 0.636619772367581343f + 0.5f);
+    Expr k = cast(Int(32, type.lanes()), k_real);
+    Expr r = x - k_real * 1.57080078125f;
+    r -= k_real * -4.4535845518112183e-06f;
+    r -= k_real * -8.7061380327213556e-10f;
+    r -= k_real * 6.2233719696699885e-14f;
+
+    Expr u = r * r;
+    Expr s = r + r * u * evaluate_approximation(u, choose_approximation(sin_table, max_ulp_error));
+    Expr c = (1.0f - 0.5f * u) + u * u * evaluate_approximation(u, choose_approximation(cos_table, max_ulp_error));
+
+    // cos(x) = sin(x + pi/2). The quadrant picks between the sine
+    // and cosine of the reduced argument, and the sign.
+    Expr quadrant = is_cos ? k + 1 : k;
+    Expr result = select((quadrant & make_one(k.type())) == 0, s, c);
+    result = select((quadrant & make_two(k.type())) == 0, result, -result);
+
+    return common_subexpression_elimination(result);
+}
+
+}
+
+Expr polynomial_exp(Expr x_full, int max_ulp_error) {
+    Type type = x_full.type();
+    internal_assert(type.element_of() == Float(32));
+
+    static const std::vector<PolynomialApproximation> table = {
+        {1644, {0.166628197f, 0.503941774f, 1.0f, 1.0f}},
+        {71, {0.0412776768f, 0.16753529f, 0.5000512f, 1.0f, 1.0f}},
+        {4, {0.0083125243f, 0.0418901518f, 0.166671142f, 0.499992311f, 1.0f, 1.0f}},
+        {3, {0.00138146f, 0.00836871564f, 0.041668389f, 0.166665211f, 0.49999994f, 1.0f, 1.0f}}};
+
+    // Past these bounds the result is zero or infinity anyway, and
+    // within them both of the powers of two below are normal floats.
+    Expr x = clamp(x_full, -104.0f, 89.0f);
+
+    // Reduce the argument to [-ln(2)/2, ln(2)/2] by subtracting a
+    // multiple k of ln(2).
+    Expr k_real = floor(x * 1.44269504088896341f + 0.5f);
+    Expr k = cast(Int(32, type.lanes()), k_real);
+    Expr r = x - k_real * ln2_hi;
+    r -= k_real * ln2_lo;
+
+    Expr result = evaluate_approximation(r, choose_approximation(table, max_ulp_error));
+
+    // Multiply by 2^k in two steps, so that results which are
+    // denormal or overflow to infinity come out right.
+    Expr k1 = k >> 1;
+    Expr k2 = k - k1;
+    result *= reinterpret(type, (k1 + 127) << 23);
+    result *= reinterpret(type, (k2 + 127) << 23);
+
+    result = select(is_nan(x_full), x_full, result);
+
+    return common_subexpression_elimination(result);
+}
+
+Expr polynomial_log(Expr x_full, int max_ulp_error) {
+    Type type = x_full.type();
+    internal_assert(type.element_of() == Float(32));
+
+    static const std::vector<PolynomialApproximation> table = {
+        {910, {0.140148118f, -0.257172704f, 0.337448031f, -0.499980599f, 1.0f, 0.0f}},
+        {133, {-0.106547005f, 0.204929143f, -0.25588131f, 0.333499938f, -0.499889493f, 1.0f, 0.0f}},
+        {23, {0.0832438841f, -0.167648494f, 0.206263587f, -0.250593066f, 0.333187371f,
+              -0.499989152f, 1.0f, 0.0f}},
+        {6, {-0.0672031417f, 0.141535893f, -0.173371404f, 0.200953484f, -0.249792695f,
+             0.333307058f, -0.500001669f, 1.0f, 0.0f}},
+        {3, {-0.0449091829f, 0.104482986f, -0.131622359f, 0.14482069f, -0.16647768f,
+             0.199906066f, -0.250000536f, 0.333334535f, -0.5f, 1.0f, 0.0f}}};
+
+    Expr nan = Call::make(type, "nan_f32", {}, Call::PureExtern);
+    Expr neg_inf = Call::make(type, "neg_inf_f32", {}, Call::PureExtern);
+
+    // Scale denormals up by 2^24, so that range reduction finds their
+    // leading bit.
+    Expr denormal = x_full < std::numeric_limits<float>::min();
+    Expr x = select(denormal, x_full * 16777216.0f, x_full);
+
+    Expr reduced, exponent;
+    range_reduce_log(x, &reduced, &exponent);
+    exponent = select(denormal, exponent - 24, exponent);
+
+    Expr result = evaluate_approximation(reduced - 1.0f, choose_approximation(table, max_ulp_error));
+    Expr e = cast(type, exponent);
+    result = (result + e * ln2_lo) + e * ln2_hi;
+
+    // Inf and nan are the only inputs above the largest float.
+    result = select(x_full > std::numeric_limits<float>::max(), x_full, result);
+    result = select(x_full == 0.0f, neg_inf, result);
+    result = select(x_full < 0.0f || is_nan(x_full), nan, result);
+
+    return common_subexpression_elimination(result);
+}
+
+Expr polynomial_sin(Expr x, int max_ulp_error) {
+    return sin_or_cos(x, max_ulp_error, false);
+}
+
+Expr polynomial_cos(Expr x, int max_ulp_error) {
+    return sin_or_cos(x, max_ulp_error, true);
+}
+
+Expr polynomial_tanh(Expr x, int max_ulp_error) {
+    Type type = x.type();
+    internal_assert(type.element_of() == Float(32));
+
+    static const std::vector<PolynomialApproximation> table = {
+        {1636, {0.108370587f, -0.330466717f}},
+        {52, {-0.040514674f, 0.130482733f, -0.333155125f}},
+        {3, {0.0151953483f, -0.051947888f, 0.133081749f, -0.333323419f}},
+        {2, {-0.00570497941f, 0.0206390806f, -0.0537397116f, 0.133314416f, -0.333332807f}}};
+
+    // Near zero, use an odd polynomial. Further out, use tanh(x) = 1 -
+    // 2 / (exp(2x) + 1), which doesn't suffer from cancellation
+    // there. The bounds in the table include the error from exp.
+    Expr ax = abs(x);
+    Expr u = ax * ax;
+    Expr small = ax + ax * u * evaluate_approximation(u, choose_approximation(table, max_ulp_error));
+    Expr large = 1.0f - 2.0f / (polynomial_exp(2.0f * ax, max_ulp_error) + 1.0f);
+    Expr result = select(ax < 0.625f, small, large);
+    result = select(x < 0.0f, -result, result);
+
+    return common_subexpression_elimination(result);
+}
+
+Expr polynomial_atan2(Expr y, Expr x, int max_ulp_error) {
+    Type type = x.type();
+    internal_assert(type.element_of() == Float(32) && y.type() == type);
+
+    static const std::vector<PolynomialApproximation> table = {
+        {296, {0.170341492f, -0.33183375f}},
+        {13, {-0.112251453f, 0.197141409f, -0.333255082f}},
+        {4, {0.0805371106f, -0.138776749f, 0.199777097f, -0.333329499f}},
+        {3, {-0.060782142f, 0.105938114f, -0.142435327f, 0.199984714f, -0.333333164f}}};
+
+    // Compute the arctangent of the ratio of the smaller to the
+    // larger magnitude, which is in [0, 1], and use symmetry to get
+    // the other octants.
+    Expr ax = abs(x), ay = abs(y);
+    Expr lo = min(ax, ay), hi = max(ax, ay);
+    Expr t = select(hi == 0.0f, make_zero(type),
+                    select(lo == hi, make_one(type), lo / hi));
+
+    // Reduce further to [0, tan(pi/8)] using atan(t) = pi/4 +
+    // atan((t - 1) / (t + 1)).
+    Expr past_pi_8 = t > 0.414213562373095f;
+    t = select(past_pi_8, (t - 1.0f) / (t + 1.0f), t);
+    Expr u = t * t;
+    Expr result = t + t * u * evaluate_approximation(u, choose_approximation(table, max_ulp_error));
+
+    result = select(past_pi_8, result + 0.785398163397448f, result);
+    result = select(ay > ax, 1.57079632679490f - result, result);
+    result = select(x < 0.0f, 3.14159265358979f - result, result);
+    result = select(y < 0.0f, -result, result);
+
+    return common_subexpression_elimination(result);
+}
+
+Expr polynomial_erf(Expr x_full, int max_ulp_error) {
+    Type type = x_full.type();
+    internal_assert(type.element_of() == Float(32));
+
+    // halide_erf is the most accurate approximation, with an error of
+    // at most 7 ULPs. The cheaper ones have the same form.
+    if (max_ulp_error < 20) {
+        return halide_erf(x_full);
+    }
+
+    static const std::vector<PolynomialApproximation> small_table = {
+        {472, {-0.0183684323f, 0.107835412f, -0.375137448f, 1.12834752f}},
+        {20, {0.00349419448f, -0.0254480969f, 0.112341963f, -0.376064211f, 1.12837791f}}};
+    static const std::vector<PolynomialApproximation> large_table = {
+        {472, {0.00377439987f, -0.00298326067f, 0.0611601211f, 0.0566380396f, 1.00395834f}},
+        {20, {0.0007720227f, -0.00205112086f, 0.0142042106f, 0.0363464952f, 0.0741901696f, 0.999085307f}}};
+
+    Expr x = abs(x_full);
+    Expr approx1 = evaluate_approximation(x, choose_approximation(large_table, max_ulp_error));
+    approx1 = 1.0f - pow(approx1, -16);
+    Expr approx2 = x * evaluate_approximation(x * x, choose_approximation(small_table, max_ulp_error));
+    Expr result = select(x > 1.0f, approx1, approx2);
+    result = select(x_full < 0.0f, -result, result);
+
+    return common_subexpression_elimination(result);
+}
+
 Expr raise_to_integer_power(Expr e, int64_t p) {
     Expr result;
     if (p == 0) {
@@ -658,6 +894,53 @@ Expr fast_exp(Expr x_full) {
     return result;
 }
 
+Expr fast_exp(Expr x, int max_ulp_error) {
+    user_assert(x.type() == Float(32)) << "fast_exp only works for Float(32)";
+    return Internal::polynomial_exp(x, max_ulp_error);
+}
+
+Expr fast_log(Expr x, int max_ulp_error) {
+    user_assert(x.type() == Float(32)) << "fast_log only works for Float(32)";
+    return Internal::polynomial_log(x, max_ulp_error);
+}
+
+Expr fast_pow(Expr x, Expr y, int max_ulp_error) {
+    if (const int64_t *i = as_const_int(y)) {
+        return raise_to_integer_power(x, *i);
+    }
+
+    x = cast<float>(x);
+    y = cast<float>(y);
+    Expr result = Internal::polynomial_log(x, max_ulp_error) * y;
+    return Internal::polynomial_exp(result, max_ulp_error);
+}
+
+Expr fast_sin(Expr x, int max_ulp_error) {
+    user_assert(x.type() == Float(32)) << "fast_sin only works for Float(32)";
+    return Internal::polynomial_sin(x, max_ulp_error);
+}
+
+Expr fast_cos(Expr x, int max_ulp_error) {
+    user_assert(x.type() == Float(32)) << "fast_cos only works for Float(32)";
+    return Internal::polynomial_cos(x, max_ulp_error);
+}
+
+Expr fast_tanh(Expr x, int max_ulp_error) {
+    user_assert(x.type() == Float(32)) << "fast_tanh only works for Float(32)";
+    return Internal::polynomial_tanh(x, max_ulp_error);
+}
+
+Expr fast_atan2(Expr y, Expr x, int max_ulp_error) {
+    user_assert(x.type() == Float(32) && y.type() == Float(32))
+        << "fast_atan2 only works for Float(32)";
+    return Internal::polynomial_atan2(y, x, max_ulp_error);
+}
+
+Expr fast_erf(Expr x, int max_ulp_error) {
+    user_assert(x.type() == Float(32)) << "fast_erf only works for Float(32)";
+    return Internal::polynomial_erf(x, max_ulp_error);
+}
+
 Expr print(const std::vector<Expr> &args) {
     // Insert spaces between each expr.
     std::vector<Expr> print_args(args.size()*2);
@@ -159,6 +159,19 @@ EXPORT Expr halide_exp(Expr a);
 EXPORT Expr halide_erf(Expr a);
 // @}
 
+/** Polynomial approximations of transcendentals for scalar or vector
+ * Float(32) values, with a bound on the error in ULPs. These
+ * implement the fast_ functions that take a max_ulp_error. */
+// @{
+EXPORT Expr polynomial_exp(Expr x, int max_ulp_error);
+EXPORT Expr polynomial_log(Expr x, int max_ulp_error);
+EXPORT Expr polynomial_sin(Expr x, int max_ulp_error);
+EXPORT Expr polynomial_cos(Expr x, int max_ulp_error);
+EXPORT Expr polynomial_tanh(Expr x, int max_ulp_error);
+EXPORT Expr polynomial_atan2(Expr y, Expr x, int max_ulp_error);
+EXPORT Expr polynomial_erf(Expr x, int max_ulp_error);
+// @}
+
 /** Raise an expression to an integer power by repeatedly multiplying
  * it by itself. */
 EXPORT Expr raise_to_integer_power(Expr a, int64_t b);
@@ -945,7 +958,9 @@ inline Expr select(Expr c1, Expr v1,
 // No backend supports these yet.
 
 /** Return the sine of a floating-point expression. If the argument is
- * not floating-point, it is cast to Float(32). Does not vectorize
+ * not floating-point, it is cast to Float(32). With the
+ * fast_vector_math target feature, vectorized Float(32) calls use
+ * fast_sin(x, 0) instead of libm. Otherwise does not vectorize
  * well. */
 inline Expr sin(Expr x) {
     user_assert(x.defined()) << "sin of undefined Expr\n";
@@ -977,7 +992,9 @@ inline Expr asin(Expr x) {
 }
 
 /** Return the cosine of a floating-point expression. If the argument
- * is not floating-point, it is cast to Float(32). Does not vectorize
+ * is not floating-point, it is cast to Float(32). With the
+ * fast_vector_math target feature, vectorized Float(32) calls use
+ * fast_cos(x, 0) instead of libm. Otherwise does not vectorize
  * well. */
 inline Expr cos(Expr x) {
     user_assert(x.defined()) << "cos of undefined Expr\n";
@@ -1041,7 +1058,9 @@ inline Expr atan(Expr x) {
 }
 
 /** Return the angle of a floating-point gradient. If the argument is
- * not floating-point, it is cast to Float(32). Does not vectorize
+ * not floating-point, it is cast to Float(32). With the
+ * fast_vector_math target feature, vectorized Float(32) calls use
+ * fast_atan2(y, x, 0) instead of libm. Otherwise does not vectorize
  * well. */
 inline Expr atan2(Expr y, Expr x) {
     user_assert(x.defined() && y.defined()) << "atan2 of undefined Expr\n";
@@ -1126,8 +1145,10 @@ inline Expr acosh(Expr x) {
 }
 
 /** Return the hyperbolic tangent of a floating-point expression.  If
- * the argument is not floating-point, it is cast to Float(32). Does
- * not vectorize well. */
+ * the argument is not floating-point, it is cast to Float(32).
+ * With the fast_vector_math target feature, vectorized Float(32)
+ * calls use fast_tanh(x, 0) instead of libm. Otherwise does not
+ * vectorize well. */
 inline Expr tanh(Expr x) {
     user_assert(x.defined()) << "tanh of undefined Expr\n";
     if (x.type() == Float(64)) {
@@ -1282,6 +1303,51 @@ inline Expr fast_pow(Expr x, Expr y) {
     return select(x == 0.0f, 0.0f, fast_exp(fast_log(x) * y));
 }
 
+/** Vectorizable polynomial approximations of transcendental
+ * functions for Float(32), with a bound on the error chosen by the
+ * caller. max_ulp_error is the largest acceptable error, in units in
+ * the last place of the result. The cheapest approximation at least
+ * that accurate is used. Bounds tighter than the most accurate
+ * approximation available get the most accurate one, so passing zero
+ * asks for the best there is. The bounds were measured over dense
+ * sweeps of the inputs. */
+// @{
+
+/** Exponential. At best accurate to 3 ULPs. Inputs that overflow
+ * give inf, and inputs that underflow give denormals or zero. */
+EXPORT Expr fast_exp(Expr x, int max_ulp_error);
+
+/** Natural logarithm. At best accurate to 3 ULPs. Returns nan for x
+ * < 0, -inf for x == 0, and handles denormals. */
+EXPORT Expr fast_log(Expr x, int max_ulp_error);
+
+/** One value raised to the power of another, computed as exp(y *
+ * log(x)) using the approximations above. The bound applies to those;
+ * the result has an additional error of roughly |y * log(x)| ULPs,
+ * which gets large when approaching overflow. Returns nan for x <
+ * 0. */
+EXPORT Expr fast_pow(Expr x, Expr y, int max_ulp_error);
+
+/** Sine. At best accurate to 3 ULPs for |x| <= 4096. The error
+ * grows for larger arguments. */
+EXPORT Expr fast_sin(Expr x, int max_ulp_error);
+
+/** Cosine. At best accurate to 3 ULPs for |x| <= 4096. The error
+ * grows for larger arguments. */
+EXPORT Expr fast_cos(Expr x, int max_ulp_error);
+
+/** Hyperbolic tangent. At best accurate to 2 ULPs. */
+EXPORT Expr fast_tanh(Expr x, int max_ulp_error);
+
+/** The angle of a gradient. At best accurate to 3 ULPs. Returns zero
+ * when both arguments are zero. */
+EXPORT Expr fast_atan2(Expr y, Expr x, int max_ulp_error);
+
+/** The error function. At best accurate to 7 ULPs, which is the
+ * approximation erf uses. */
+EXPORT Expr fast_erf(Expr x, int max_ulp_error);
+// @}
+
 /** Fast approximate inverse for Float(32). Corresponds to the rcpps
  * instruction on x86, and the vrecpe instruction on ARM. Vectorizes
  * cleanly. */
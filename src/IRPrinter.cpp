@@ -428,6 +428,10 @@ void IRPrinter::visit(const Load *op) {
     stream << op->name << "[";
     print(op->index);
     stream << "]";
+    if (!is_one(op->predicate)) {
+        stream << " if ";
+        print(op->predicate);
+    }
 }
 
 void IRPrinter::visit(const Ramp *op) {
@@ -534,6 +538,10 @@ void IRPrinter::visit(const Store *op) {
     print(op->index);
     stream << "] = ";
     print(op->value);
+    if (!is_one(op->predicate)) {
+        stream << " if ";
+        print(op->predicate);
+    }
     stream << '\n';
 }
 
@@ -1,9 +1,14 @@
 #include <string>
 #include <stdint.h>
+#include <iomanip>
+#include <list>
 #include <mutex>
 #include <set>
+#include <sstream>
 
 #include "CodeGen_Internal.h"
+#include "IRMutator.h"
+#include "IRPrinter.h"
 #include "JITModule.h"
 #include "LLVM_Headers.h"
 #include "LLVM_Runtime_Linker.h"
@@ -117,7 +122,7 @@ public:
     mutable RefCount ref_count;
 
     // Just construct a module with symbols to import into other modules.
-    JITModuleContents() : execution_engine(nullptr) {
+    JITModuleContents() : execution_engine(nullptr), memory_used(0) {
     }
 
     ~JITModuleContents() {
@@ -134,6 +139,9 @@ public:
     JITModule::Symbol entrypoint;
     JITModule::Symbol argv_entrypoint;
 
+    // The bytes of code and data sections allocated by the execution engine.
+    size_t memory_used;
+
     std::string name;
 };
 
@@ -181,9 +189,24 @@ JITModule::Symbol compile_and_get_function(ExecutionEngine &ee, const string &na
 // TODO: Does this need to be conditionalized to llvm 3.6?
 class HalideJITMemoryManager : public SectionMemoryManager {
     std::vector<JITModule> modules;
+    size_t &memory_used;
 
 public:
-    HalideJITMemoryManager(const std::vector<JITModule> &modules) : modules(modules) {}
+    HalideJITMemoryManager(const std::vector<JITModule> &modules, size_t &memory_used) :
+        modules(modules), memory_used(memory_used) {}
+
+    virtual uint8_t *allocateCodeSection(uintptr_t size, unsigned alignment,
+                                         unsigned section_id, StringRef section_name) {
+        memory_used += size;
+        return SectionMemoryManager::allocateCodeSection(size, alignment, section_id, section_name);
+    }
+
+    virtual uint8_t *allocateDataSection(uintptr_t size, unsigned alignment,
+                                         unsigned section_id, StringRef section_name,
+                                         bool is_read_only) {
+        memory_used += size;
+        return SectionMemoryManager::allocateDataSection(size, alignment, section_id, section_name, is_read_only);
+    }
 
     virtual uint64_t getSymbolAddress(const std::string &name) {
         for (size_t i = 0; i < modules.size(); i++) {
@@ -237,7 +260,7 @@ void JITModule::compile_module(std::unique_ptr<llvm::Module> m, const string &fu
     engine_builder.setTargetOptions(options);
     engine_builder.setErrorStr(&error_string);
     engine_builder.setEngineKind(llvm::EngineKind::JIT);
-    engine_builder.setMCJITMemoryManager(std::unique_ptr<RTDyldMemoryManager>(new HalideJITMemoryManager(dependencies)));
+    engine_builder.setMCJITMemoryManager(std::unique_ptr<RTDyldMemoryManager>(new HalideJITMemoryManager(dependencies, jit_module->memory_used)));
 
     engine_builder.setOptLevel(CodeGenOpt::Aggressive);
     engine_builder.setMCPU(mcpu);
@@ -366,6 +389,10 @@ JITModule::Symbol JITModule::argv_entrypoint_symbol() const {
     return jit_module->argv_entrypoint;
 }
 
+size_t JITModule::memory_used() const {
+    return jit_module->memory_used;
+}
+
 static bool module_already_in_graph(const JITModuleContents *start, const JITModuleContents *target, std::set <const JITModuleContents *> &already_seen) {
     if (start == target) {
         return true;
@@ -776,6 +803,9 @@ void JITSharedRuntime::init_jit_user_context(JITUserContext &jit_user_context,
 }
 
 void JITSharedRuntime::release_all() {
+    // Cached modules depend on the runtimes being released.
+    JITCache::clear();
+
     std::lock_guard<std::mutex> lock(shared_runtimes_mutex);
 
     for (int i = MaxRuntimeKind; i > 0; i--) {
@@ -800,5 +830,291 @@ void JITSharedRuntime::memoization_cache_set_size(int64_t size) {
     }
 }
 
+
+namespace {
+
+// Renames the things in lowered code whose names don't affect what it
+// computes: the functions, buffers and loop variables, and the
+// temporaries made by unique_name. Names are split into their
+// dot-separated components. The first component is always renamed,
+// and the others are renamed if they look generated (e.g. "v12" or
+// "x$3"). Fixed components such as "stride" or "host", which code
+// generation relies on, are left alone. Renaming is consistent, so
+// two pieces of code that canonicalize to the same thing differ only
+// by a renaming. Once rename_strings is set, string constants that
+// name something already renamed are renamed too, as long as the name
+// looks generated. This lets the names of auto-named Funcs in error
+// messages and intrinsics match, at the cost of the shared code
+// reporting one pipeline's generated names for the other.
+class CanonicalizeNames : public IRMutator {
+    std::map<std::string, std::string> renamed;
+
+    bool is_generated(const std::string &c) {
+        if (c.find('$') != std::string::npos) {
+            return true;
+        }
+        size_t i = 0;
+        while (i < c.size() && isalpha(c[i])) i++;
+        if (i == 0 || i == c.size()) {
+            return false;
+        }
+        while (i < c.size() && isdigit(c[i])) i++;
+        return i == c.size();
+    }
+
+    std::string rename_component(const std::string &c) {
+        auto it = renamed.find(c);
+        if (it != renamed.end()) {
+            return it->second;
+        }
+        std::string r = "_" + std::to_string(renamed.size());
+        renamed[c] = r;
+        return r;
+    }
+
+    using IRMutator::visit;
+
+    void visit(const Variable *op) {
+        expr = Variable::make(op->type, canonical(op->name));
+    }
+
+    void visit(const StringImm *op) {
+        std::string first = op->value.substr(0, op->value.find('.'));
+        if (rename_strings && is_generated(first) && renamed.count(first)) {
+            expr = StringImm::make(canonical(op->value));
+        } else {
+            expr = op;
+        }
+    }
+
+    void visit(const Let *op) {
+        std::string name = canonical(op->name);
+        expr = Let::make(name, mutate(op->value), mutate(op->body));
+    }
+
+    void visit(const LetStmt *op) {
+        std::string name = canonical(op->name);
+        stmt = LetStmt::make(name, mutate(op->value), mutate(op->body));
+    }
+
+    void visit(const For *op) {
+        std::string name = canonical(op->name);
+        stmt = For::make(name, mutate(op->min), mutate(op->extent),
+                         op->for_type, op->device_api, mutate(op->body));
+    }
+
+    void visit(const Load *op) {
+        expr = Load::make(op->type, canonical(op->name), mutate(op->index), BufferPtr(), Parameter(), mutate(op->predicate));
+    }
+
+    void visit(const Store *op) {
+        std::string name = canonical(op->name);
+        stmt = Store::make(name, mutate(op->value), mutate(op->index), Parameter(), mutate(op->predicate));
+    }
+
+    void visit(const Allocate *op) {
+        std::string name = canonical(op->name);
+        std::vector<Expr> extents;
+        for (Expr e : op->extents) {
+            extents.push_back(mutate(e));
+        }
+        Expr new_expr = op->new_expr.defined() ? mutate(op->new_expr) : Expr();
+        stmt = Allocate::make(name, op->type, extents, mutate(op->condition),
+                              mutate(op->body), new_expr, op->free_function);
+    }
+
+    void visit(const Free *op) {
+        stmt = Free::make(canonical(op->name));
+    }
+
+    void visit(const ProducerConsumer *op) {
+        std::string name = canonical(op->name);
+        stmt = ProducerConsumer::make(name, op->is_producer, mutate(op->body));
+    }
+
+    void visit(const Call *op) {
+        std::vector<Expr> args;
+        for (Expr e : op->args) {
+            args.push_back(mutate(e));
+        }
+        std::string name = op->name;
+        if (op->call_type == Call::Halide ||
+            op->call_type == Call::Image ||
+            functions.count(op->name)) {
+            name = canonical(op->name);
+        }
+        expr = Call::make(op->type, name, args, op->call_type);
+    }
+
+public:
+    // The names of the functions in the module. Calls to these are
+    // renamed.
+    std::set<std::string> functions;
+
+    bool rename_strings = false;
+
+    std::string canonical(const std::string &name) {
+        if (starts_with(name, "__") && !functions.count(name)) {
+            // Reserved names, such as __user_context.
+            return name;
+        }
+        std::string result;
+        size_t start = 0;
+        for (int i = 0; ; i++) {
+            size_t end = name.find('.', start);
+            std::string c = name.substr(start, end == std::string::npos ? std::string::npos : end - start);
+            if (i == 0 || is_generated(c)) {
+                c = rename_component(c);
+            }
+            result += c;
+            if (end == std::string::npos) {
+                break;
+            }
+            result += '.';
+            start = end + 1;
+        }
+        return result;
+    }
+};
+
+// Print the parts of a module and the modules it links against that
+// determine the code compiled for it, canonicalizing the names.
+std::string jit_cache_key(const Module &m, const std::vector<JITModule> &dependencies) {
+    std::ostringstream key;
+    // Print constants exactly.
+    key << std::setprecision(17);
+    key << m.target().to_string() << "\n";
+
+    CanonicalizeNames canonicalize;
+    for (const LoweredFunc &f : m.functions()) {
+        canonicalize.functions.insert(f.name);
+    }
+
+    // Find the names to rename before looking at any strings, so
+    // that a string that comes before the thing it names is still
+    // renamed.
+    for (const LoweredFunc &f : m.functions()) {
+        canonicalize.mutate(f.body);
+    }
+    canonicalize.rename_strings = true;
+
+    for (const BufferPtr &b : m.buffers()) {
+        // Buffers in the module are baked into the code, so they're
+        // identified by address rather than by contents.
+        key << "buffer " << canonicalize.canonical(b.name()) << " " << (const void *)b.raw_buffer() << "\n";
+    }
+
+    for (const LoweredFunc &f : m.functions()) {
+        key << "func " << canonicalize.canonical(f.name) << " " << (int)f.linkage << " (";
+        for (const LoweredArgument &arg : f.args) {
+            key << canonicalize.canonical(arg.name) << " "
+                << (int)arg.kind << " " << arg.type << " "
+                << (int)arg.dimensions << " "
+                << arg.alignment.modulus << " " << arg.alignment.remainder << ", ";
+        }
+        key << ")\n";
+        IRPrinter printer(key);
+        printer.print(canonicalize.mutate(f.body));
+    }
+
+    for (const JITModule &dep : dependencies) {
+        key << "depends on";
+        for (const auto &e : dep.exports()) {
+            key << " " << e.first << "=" << e.second.address;
+        }
+        key << "\n";
+    }
+
+    return key.str();
+}
+
+struct JITCacheEntry {
+    std::string key;
+    JITModule module;
+};
+
+std::mutex jit_cache_mutex;
+// The cached modules, most recently used first.
+std::list<JITCacheEntry> jit_cache;
+size_t jit_cache_memory_used = 0;
+size_t jit_cache_max_memory = 64 * 1024 * 1024;
+
+// Drop the least recently used modules until the cache fits in its
+// budget. Always keeps the most recently used one.
+void trim_jit_cache() {
+    while (jit_cache_memory_used > jit_cache_max_memory && jit_cache.size() > 1) {
+        jit_cache_memory_used -= jit_cache.back().module.memory_used();
+        jit_cache.pop_back();
+    }
+}
+
+}
+
+JITModule JITCache::get(const Module &m, const LoweredFunc &fn, const std::vector<JITModule> &dependencies) {
+    std::string key = jit_cache_key(m, dependencies);
+
+    {
+        std::lock_guard<std::mutex> lock(jit_cache_mutex);
+        for (auto it = jit_cache.begin(); it != jit_cache.end(); it++) {
+            if (it->key == key) {
+                debug(2) << "Reusing cached jit module " << it->module.entrypoint_symbol().address
+                         << " for " << fn.name << "\n";
+                jit_cache.splice(jit_cache.begin(), jit_cache, it);
+                return jit_cache.front().module;
+            }
+        }
+    }
+
+    // Compile without holding the lock. If another thread compiled
+    // the same thing in the meantime, the first one into the cache
+    // wins.
+    JITModule module(m, fn, dependencies);
+
+    std::lock_guard<std::mutex> lock(jit_cache_mutex);
+    for (const JITCacheEntry &e : jit_cache) {
+        if (e.key == key) {
+            return e.module;
+        }
+    }
+    jit_cache.push_front({key, module});
+    jit_cache_memory_used += module.memory_used();
+    trim_jit_cache();
+    return module;
+}
+
+void JITCache::evict(const JITModule &m) {
+    std::lock_guard<std::mutex> lock(jit_cache_mutex);
+    for (auto it = jit_cache.begin(); it != jit_cache.end(); ) {
+        if (it->module.jit_module.same_as(m.jit_module)) {
+            jit_cache_memory_used -= it->module.memory_used();
+            it = jit_cache.erase(it);
+        } else {
+            it++;
+        }
+    }
+}
+
+void JITCache::clear() {
+    std::lock_guard<std::mutex> lock(jit_cache_mutex);
+    jit_cache.clear();
+    jit_cache_memory_used = 0;
+}
+
+size_t JITCache::size() {
+    std::lock_guard<std::mutex> lock(jit_cache_mutex);
+    return jit_cache.size();
+}
+
+size_t JITCache::memory_used() {
+    std::lock_guard<std::mutex> lock(jit_cache_mutex);
+    return jit_cache_memory_used;
+}
+
+void JITCache::set_max_memory(size_t bytes) {
+    std::lock_guard<std::mutex> lock(jit_cache_mutex);
+    jit_cache_max_memory = bytes;
+    trim_jit_cache();
+}
+
 }
 }
@@ -136,6 +136,10 @@ struct JITModule {
 
     /** Return true if compile_module has been called on this module. */
     EXPORT bool compiled() const;
+
+    /** The number of bytes of code and data the JIT allocated for this
+     * module, not counting its dependencies. */
+    EXPORT size_t memory_used() const;
 };
 
 typedef int (*halide_task)(void *user_context, int, uint8_t *);
@@ -175,6 +179,39 @@ public:
     EXPORT static void release_all();
 };
 
+/** A process-wide cache of JIT compiled modules, shared by all
+ * Pipelines. Modules whose lowered code is the same up to the names
+ * of functions, buffers, loop variables and temporaries, for the same
+ * target and linking against the same externs, are compiled once and
+ * their code is shared. The cache holds onto modules until they're
+ * evicted, explicitly or because the code held by the cache exceeds
+ * its memory budget, in which case the least recently used modules go
+ * first. Pipelines still using an evicted module keep it alive. */
+class JITCache {
+public:
+    /** Get a compiled module for the function fn in the module m,
+     * compiling it if there isn't an equivalent module in the cache. */
+    EXPORT static JITModule get(const Module &m, const LoweredFunc &fn,
+                                const std::vector<JITModule> &dependencies = std::vector<JITModule>());
+
+    /** Remove a module from the cache. */
+    EXPORT static void evict(const JITModule &m);
+
+    /** Remove all modules from the cache. */
+    EXPORT static void clear();
+
+    /** The number of modules in the cache. */
+    EXPORT static size_t size();
+
+    /** The number of bytes of code and data held by the modules in the
+     * cache. */
+    EXPORT static size_t memory_used();
+
+    /** Set the number of bytes of code and data the cache may hold
+     * before it starts evicting modules. The default is 64 MB. */
+    EXPORT static void set_max_memory(size_t bytes);
+};
+
 }
 }
 
@@ -0,0 +1,381 @@
+#include <map>
+#include <set>
+
+#include "LICM.h"
+#include "IREquality.h"
+#include "IRMutator.h"
+#include "IROperator.h"
+#include "Scope.h"
+#include "Simplify.h"
+#include "Substitute.h"
+
+namespace Halide {
+namespace Internal {
+
+using std::map;
+using std::pair;
+using std::set;
+using std::string;
+using std::vector;
+
+namespace {
+
+const string hoisted_suffix = ".hoisted";
+
+// Find the buffers written to or allocated within a loop body, and
+// check for calls with side effects, which might write to anything.
+class FindWrites : public IRVisitor {
+    using IRVisitor::visit;
+
+    void visit(const Store *op) {
+        buffers.insert(op->name);
+        IRVisitor::visit(op);
+    }
+
+    void visit(const Allocate *op) {
+        buffers.insert(op->name);
+        IRVisitor::visit(op);
+    }
+
+    void visit(const Call *op) {
+        if (!op->is_pure()) {
+            has_side_effects = true;
+        }
+        IRVisitor::visit(op);
+    }
+
+public:
+    set<string> buffers;
+    bool has_side_effects = false;
+};
+
+// Expressions that aren't worth hoisting, because they're as cheap
+// to recompute as a variable. These are also the ones the simplifier
+// would substitute back in.
+bool is_trivial(Expr e) {
+    if (is_const(e) || e.as<Variable>()) {
+        return true;
+    } else if (const Broadcast *b = e.as<Broadcast>()) {
+        return is_trivial(b->value);
+    } else if (const Ramp *r = e.as<Ramp>()) {
+        return is_trivial(r->base) && is_trivial(r->stride);
+    } else if (const Add *add = e.as<Add>()) {
+        return add->a.as<Variable>() && is_const(add->b);
+    } else if (const Sub *sub = e.as<Sub>()) {
+        return sub->a.as<Variable>() && is_const(sub->b);
+    }
+    return false;
+}
+
+template<typename T>
+bool may_fault(const T *op) {
+    return !op->type.is_float() && (!is_const(op->b) || is_zero(op->b));
+}
+
+// Check if evaluating an expression might fault, if it's evaluated
+// where it wouldn't have been.
+class MayFault : public IRVisitor {
+    using IRVisitor::visit;
+
+    void visit(const Load *) {
+        result = true;
+    }
+
+    void visit(const Div *op) {
+        result = result || may_fault(op);
+        IRVisitor::visit(op);
+    }
+
+    void visit(const Mod *op) {
+        result = result || may_fault(op);
+        IRVisitor::visit(op);
+    }
+
+public:
+    bool result = false;
+};
+
+// Check if an expression can be evaluated outside of the loop
+// instead of inside it.
+class IsInvariant : public IRVisitor {
+    using IRVisitor::visit;
+
+    const Scope<int> &varying;
+    const set<string> &written;
+    bool loads_ok, in_conditional;
+
+    void visit(const Variable *op) {
+        if (varying.contains(op->name) || written.count(op->name)) {
+            result = false;
+        }
+    }
+
+    void visit(const Load *op) {
+        if (!loads_ok || in_conditional ||
+            written.count(op->name) || !is_one(op->predicate)) {
+            result = false;
+        } else {
+            IRVisitor::visit(op);
+        }
+    }
+
+    // Integer division by a value that might be zero may trap, so
+    // it can't be moved out from under an if statement either.
+    template<typename T>
+    void visit_division(const T *op) {
+        if (in_conditional && may_fault(op)) {
+            result = false;
+        } else {
+            IRVisitor::visit(op);
+        }
+    }
+
+    void visit(const Div *op) { visit_division(op); }
+    void visit(const Mod *op) { visit_division(op); }
+
+    void visit(const Call *op) {
+        // Leave the hints to loop partitioning where they are.
+        if (!op->is_pure() ||
+            op->is_intrinsic(Call::likely) ||
+            op->is_intrinsic(Call::likely_if_innermost)) {
+            result = false;
+        } else {
+            IRVisitor::visit(op);
+        }
+    }
+
+    // Lets within the expression bind names that vary with the
+    // loop as far as this visitor knows, but they're hoisted along
+    // with the rest of the expression.
+    void visit(const Let *op) {
+        op->value.accept(this);
+        op->body.accept(this);
+    }
+
+public:
+    bool result = true;
+    IsInvariant(const Scope<int> &v, const set<string> &w, bool l, bool c)
+        : varying(v), written(w), loads_ok(l), in_conditional(c) {}
+};
+
+// Hoist the invariant values out of the body of a single loop.
+class HoistInvariants : public IRMutator {
+    using IRMutator::visit;
+
+    const For *loop;
+
+    // Names that vary from one iteration to the next.
+    Scope<int> varying;
+
+    // Buffers that may change within the loop.
+    set<string> written;
+
+    // Whether loads may be hoisted at all. If nothing in the loop has
+    // side effects, invariant loads always load the same value.
+    bool loads_ok;
+
+    // How many if statements we're inside. Loads and divisions in
+    // these may fault when the condition is false.
+    int conditional_depth = 0;
+
+    // The lets in the body that have been hoisted, mapped to the
+    // hoisted values.
+    map<string, Expr> renamed;
+
+    map<Expr, string, IRDeepCompare> hoisted_names;
+
+    bool is_invariant(Expr e) {
+        IsInvariant check(varying, written, loads_ok, conditional_depth > 0);
+        e.accept(&check);
+        return check.result;
+    }
+
+    // Make a new hoisted value, or reuse an existing one.
+    Expr hoist(Expr e) {
+        e = substitute(renamed, e);
+        auto it = hoisted_names.find(e);
+        if (it != hoisted_names.end()) {
+            return Variable::make(e.type(), it->second);
+        }
+        string name = unique_name(loop->name + hoisted_suffix);
+        hoisted_names[e] = name;
+        hoisted.push_back({name, e});
+        return Variable::make(e.type(), name);
+    }
+
+    template<typename LetOrLetStmt, typename Body>
+    Body visit_let(const LetOrLetStmt *op) {
+        // If the value is invariant, it has already been hoisted (or
+        // is too cheap to bother), so uses of the let can refer to
+        // the value directly, and the let becomes dead.
+        Expr value = mutate(op->value);
+        bool invariant = !value.type().is_handle() && is_invariant(value);
+        if (invariant) {
+            renamed[op->name] = value;
+        } else {
+            varying.push(op->name, 0);
+        }
+        Body body = mutate(op->body);
+        if (invariant) {
+            renamed.erase(op->name);
+        } else {
+            varying.pop(op->name);
+        }
+        if (value.same_as(op->value) && body.same_as(op->body)) {
+            return op;
+        }
+        return LetOrLetStmt::make(op->name, value, body);
+    }
+
+    void visit(const Let *op) {
+        expr = visit_let<Let, Expr>(op);
+    }
+
+    void visit(const LetStmt *op) {
+        stmt = visit_let<LetStmt, Stmt>(op);
+    }
+
+    void visit(const For *op) {
+        if (op->device_api != DeviceAPI::None &&
+            op->device_api != DeviceAPI::Host) {
+            // Device code is compiled separately, and its loads must
+            // see the buffers copied to the device.
+            stmt = op;
+            return;
+        }
+
+        Expr min = mutate(op->min);
+        Expr extent = mutate(op->extent);
+        varying.push(op->name, 0);
+        Stmt body = mutate(op->body);
+        varying.pop(op->name);
+        if (min.same_as(op->min) && extent.same_as(op->extent) && body.same_as(op->body)) {
+            stmt = op;
+        } else {
+            stmt = For::make(op->name, min, extent, op->for_type, op->device_api, body);
+        }
+    }
+
+    void visit(const IfThenElse *op) {
+        Expr condition = mutate(op->condition);
+        conditional_depth++;
+        Stmt then_case = mutate(op->then_case);
+        Stmt else_case = mutate(op->else_case);
+        conditional_depth--;
+        if (condition.same_as(op->condition) &&
+            then_case.same_as(op->then_case) &&
+            else_case.same_as(op->else_case)) {
+            stmt = op;
+        } else {
+            stmt = IfThenElse::make(condition, then_case, else_case);
+        }
+    }
+
+    void visit(const Call *op) {
+        if (op->is_intrinsic(Call::if_then_else)) {
+            internal_assert(op->args.size() == 3);
+            Expr condition = mutate(op->args[0]);
+            conditional_depth++;
+            Expr true_value = mutate(op->args[1]);
+            Expr false_value = mutate(op->args[2]);
+            conditional_depth--;
+            expr = Call::make(op->type, op->name, {condition, true_value, false_value},
+                              op->call_type, op->func, op->value_index, op->image, op->param);
+        } else {
+            IRMutator::visit(op);
+        }
+    }
+
+    void visit(const Variable *op) {
+        auto it = renamed.find(op->name);
+        if (it != renamed.end()) {
+            expr = it->second;
+        } else {
+            expr = op;
+        }
+    }
+
+public:
+    vector<pair<string, Expr>> hoisted;
+
+    HoistInvariants(const For *loop) : loop(loop) {
+        varying.push(loop->name, 0);
+
+        FindWrites writes;
+        loop->body.accept(&writes);
+        written = writes.buffers;
+        loads_ok = !writes.has_side_effects;
+    }
+
+    using IRMutator::mutate;
+
+    Expr mutate(Expr e) {
+        if (e.defined() && !is_trivial(e) && !e.type().is_handle() && is_invariant(e)) {
+            return hoist(e);
+        }
+        return IRMutator::mutate(e);
+    }
+};
+
+class LICM : public IRMutator {
+    using IRMutator::visit;
+
+    void visit(const For *op) {
+        if (op->device_api != DeviceAPI::None &&
+            op->device_api != DeviceAPI::Host) {
+            // Device code is compiled separately, and can't see
+            // values hoisted outside of it.
+            stmt = op;
+            return;
+        }
+
+        // Do the inner loops first.
+        Stmt body = mutate(op->body);
+        Stmt loop = For::make(op->name, op->min, op->extent, op->for_type, op->device_api, body);
+
+        HoistInvariants hoister(loop.as<For>());
+        body = hoister.mutate(body);
+        if (hoister.hoisted.empty()) {
+            stmt = loop;
+            return;
+        }
+
+        stmt = For::make(op->name, op->min, op->extent, op->for_type, op->device_api, body);
+
+        // Hoisted loads and divisions must not run if the loop
+        // wouldn't have.
+        Expr runs = simplify(op->extent > 0);
+        for (size_t i = hoister.hoisted.size(); i > 0; i--) {
+            Expr value = hoister.hoisted[i-1].second;
+            MayFault may_fault;
+            value.accept(&may_fault);
+            if (may_fault.result && !is_one(runs)) {
+                value = Call::make(value.type(), Call::if_then_else,
+                                   {runs, value, make_zero(value.type())},
+                                   Call::PureIntrinsic);
+            }
+            stmt = LetStmt::make(hoister.hoisted[i-1].first, value, stmt);
+        }
+    }
+};
+
+}  // namespace
+
+Stmt loop_invariant_code_motion(Stmt s) {
+    return LICM().mutate(s);
+}
+
+string get_hoisted_loop_name(const string &name) {
+    size_t pos = name.rfind(hoisted_suffix);
+    if (pos == string::npos) {
+        return "";
+    }
+    size_t end = pos + hoisted_suffix.size();
+    if (end != name.size() && name[end] != '$') {
+        return "";
+    }
+    return name.substr(0, pos);
+}
+
+}
+}
@@ -0,0 +1,32 @@
+#ifndef HALIDE_LICM_H
+#define HALIDE_LICM_H
+
+/** \file
+ * Defines a lowering pass that hoists loop-invariant values out of
+ * loops.
+ */
+
+#include "IR.h"
+
+namespace Halide {
+namespace Internal {
+
+/** Hoist expressions that don't depend on a loop's variable out of
+ * the loop, and loads from addresses that don't, as long as
+ * nothing in the loop writes to the buffer loaded from. Loops are
+ * processed innermost first, so values end up outside the outermost
+ * loop they're invariant in. Each hoisted value becomes a LetStmt
+ * just outside the loop, with a name recognized by
+ * get_hoisted_loop_name. Loops that run on a device are left
+ * alone. */
+EXPORT Stmt loop_invariant_code_motion(Stmt s);
+
+/** If name is the name of a LetStmt made by
+ * loop_invariant_code_motion, return the name of the loop the value
+ * was hoisted out of. Otherwise return the empty string. */
+std::string get_hoisted_loop_name(const std::string &name);
+
+}
+}
+
+#endif
@@ -93,6 +93,10 @@ class FindLoads : public IRGraphVisitor {
     set<const Load *> found;
 
     void visit(const Load *op) {
+        if (!is_one(op->predicate)) {
+            // Predicated loads may not happen on every iteration.
+            return;
+        }
         if (found.count(op) == 0) {
             found.insert(op);
             result.push_back(op);
@@ -166,19 +170,52 @@ public:
     StepForwards(const Scope<Expr> &s) : linear(s) {}
 };
 
+// Reduce a graph to a canonical form, so that graph_equal can find
+// indices that are the same.
+Expr canonicalize_graph(Expr e) {
+    // We need to simplify it, but it's a full graph, so we'll need
+    // to CSE it first.
+    e = common_subexpression_elimination(e);
+    e = simplify(e);
+    e = substitute_in_all_lets(e);
+    return e;
+}
+
 Expr step_forwards(Expr e, const Scope<Expr> &linear) {
     StepForwards step(linear);
     e = step.mutate(e);
     if (!step.success) {
         return Expr();
     } else {
-        // We need to simplify it to reduce it to a canonical form,
-        // but it's a full graph, so we'll need to CSE it first.
-        e = common_subexpression_elimination(e);
-        e = simplify(e);
-        e = substitute_in_all_lets(e);
-        return e;
+        return canonicalize_graph(e);
+    }
+}
+
+// A dense vector load at some constant offset from a symbolic base.
+struct VectorWindow {
+    const Load *load;
+    Expr base;
+    int64_t offset;
+};
+
+/** Split the base of a dense vector load into a symbolic part and a
+ * constant offset. */
+VectorWindow split_window(const Load *load) {
+    const Ramp *r = load->index.as<Ramp>();
+    internal_assert(r);
+    VectorWindow w = {load, r->base, 0};
+    if (const Add *add = r->base.as<Add>()) {
+        if (const int64_t *c = as_const_int(add->b)) {
+            w.base = add->a;
+            w.offset = *c;
+        }
+    } else if (const Sub *sub = r->base.as<Sub>()) {
+        if (const int64_t *c = as_const_int(sub->b)) {
+            w.base = sub->a;
+            w.offset = -*c;
+        }
     }
+    return w;
 }
 
 /** Carry loads over a single For loop body. */
@@ -243,6 +280,128 @@ class LoopCarryOverLoop : public IRMutator {
         stmt = Block::make(result);
     }
 
+    bool safe_to_lift(const Load *load) {
+        return (load->image.defined() ||
+                load->param.defined() ||
+                in_consume.contains(load->name));
+    }
+
+    // The taps of a vectorized stencil are vector loads at a handful
+    // of constant offsets from a base that moves by one whole vector
+    // per iteration, so no tap is ever loaded again as another tap
+    // on the next iteration, and there's nothing to carry. Rewrite
+    // each group of such windows in terms of a run of whole vectors
+    // starting at the lowest offset and spaced one vector apart,
+    // followed by the window at the highest offset. Every window is
+    // then a slice or shuffle of two neighboring vectors of the
+    // run. Each vector but the last two is loaded again as the next
+    // one along on the next iteration, so they can be carried in
+    // registers and rotated down by one vector per iteration. None
+    // of the vectors extend beyond the windows they replace.
+    static const int max_window_span = 4;
+    Stmt rotate_vector_windows(Stmt graph_stmt) {
+        FindLoads find_loads;
+        graph_stmt.accept(&find_loads);
+
+        vector<vector<VectorWindow>> groups;
+        for (const Load *load : find_loads.result) {
+            const Ramp *r = load->index.as<Ramp>();
+            if (!safe_to_lift(load) || !r || !is_one(r->stride)) continue;
+            int lanes = load->type.lanes();
+            Expr step = is_linear(r->base, linear);
+            const int64_t *const_step = step.defined() ? as_const_int(step) : nullptr;
+            if (!const_step || *const_step != lanes) continue;
+
+            VectorWindow w = split_window(load);
+            bool represented = false;
+            for (vector<VectorWindow> &g : groups) {
+                if (g[0].load->name == load->name &&
+                    g[0].load->type == load->type &&
+                    graph_equal(g[0].base, w.base)) {
+                    g.push_back(w);
+                    represented = true;
+                    break;
+                }
+            }
+            if (!represented) {
+                groups.push_back({w});
+            }
+        }
+
+        for (const vector<VectorWindow> &g : groups) {
+            int64_t min_offset = g[0].offset, max_offset = g[0].offset;
+            for (const VectorWindow &w : g) {
+                min_offset = std::min(min_offset, w.offset);
+                max_offset = std::max(max_offset, w.offset);
+            }
+            if (min_offset == max_offset) continue;
+
+            const Load *proto = g[0].load;
+            Type t = proto->type;
+            int lanes = t.lanes();
+
+            // Wider windows would need more vectors in flight than
+            // there are registers to carry them in, and would load
+            // the gaps between far-apart windows.
+            if (max_offset - min_offset > max_window_span * (int64_t)lanes) continue;
+
+            // The offsets of the vectors in the run.
+            vector<int64_t> starts;
+            for (int64_t o = min_offset; o <= max_offset; o += lanes) {
+                starts.push_back(o);
+            }
+            if (starts.back() != max_offset) {
+                starts.push_back(max_offset);
+            }
+
+            vector<Expr> pieces;
+            for (int64_t o : starts) {
+                Expr index = Ramp::make(g[0].base + make_const(Int(32), o), 1, lanes);
+                pieces.push_back(Load::make(t, proto->name, canonicalize_graph(index),
+                                            proto->image, proto->param));
+            }
+
+            debug(3) << "Rotating " << g.size() << " vector windows of " << proto->name
+                     << " through " << pieces.size() << " vectors\n";
+
+            for (const VectorWindow &w : g) {
+                size_t a = 0;
+                while (a + 1 < starts.size() && starts[a + 1] <= w.offset) {
+                    a++;
+                }
+                Expr window;
+                if (starts[a] == w.offset) {
+                    window = pieces[a];
+                } else {
+                    internal_assert(a + 1 < starts.size());
+                    size_t b = a + 1;
+                    Expr both = Call::make(t.with_lanes(lanes * 2), Call::concat_vectors,
+                                           {pieces[a], pieces[b]}, Call::PureIntrinsic);
+                    if (starts[b] == starts[a] + lanes) {
+                        window = Call::make(t, Call::slice_vector,
+                                            {both, (int)(w.offset - starts[a]), 1, lanes},
+                                            Call::PureIntrinsic);
+                    } else {
+                        // The last vector overlaps the one before it.
+                        vector<Expr> args = {both};
+                        for (int i = 0; i < lanes; i++) {
+                            int64_t pos = w.offset + i;
+                            if (pos < starts[a] + lanes) {
+                                args.push_back((int)(pos - starts[a]));
+                            } else {
+                                args.push_back((int)(lanes + pos - starts[b]));
+                            }
+                        }
+                        window = Call::make(t, Call::shuffle_vector, args, Call::PureIntrinsic);
+                    }
+                }
+                graph_stmt = graph_substitute(w.load, window, graph_stmt);
+            }
+        }
+
+        return graph_stmt;
+    }
+
     Stmt lift_carried_values_out_of_stmt(Stmt orig_stmt) {
         debug(4) << "About to lift carried values out of stmt: " << orig_stmt << "\n";
 
@@ -251,6 +410,10 @@ class LoopCarryOverLoop : public IRMutator {
         // exponential runtime.
         Stmt graph_stmt = substitute_in_all_lets(orig_stmt);
 
+        // Turn overlapping vector windows into vectors that can be
+        // carried.
+        graph_stmt = rotate_vector_windows(graph_stmt);
+
         // Find all the loads in these stmts.
         FindLoads find_loads;
         graph_stmt.accept(&find_loads);
@@ -261,10 +424,7 @@ class LoopCarryOverLoop : public IRMutator {
         vector<vector<const Load *>> loads;
         for (const Load *load : find_loads.result) {
             // Check if it's safe to lift out.
-            bool safe = (load->image.defined() ||
-                         load->param.defined() ||
-                         in_consume.contains(load->name));
-            if (!safe) continue;
+            if (!safe_to_lift(load)) continue;
 
             bool represented = false;
             for (vector<const Load *> &v : loads) {
@@ -504,7 +664,11 @@ class LoopCarry : public IRMutator {
     }
 
     void visit(const For *op) {
-        if (op->for_type == ForType::Serial && !is_one(op->extent)) {
+        if (op->device_api != DeviceAPI::None &&
+            op->device_api != DeviceAPI::Host) {
+            // Device code is compiled by its own backend.
+            stmt = op;
+        } else if (op->for_type == ForType::Serial && !is_one(op->extent)) {
             Stmt body = mutate(op->body);
             LoopCarryOverLoop carry(op->name, in_consume, max_carried_values);
             body = carry.mutate(body);
@@ -10,7 +10,13 @@ namespace Internal {
  * induction variables instead of redoing the load. Can be an
  * optimization or pessimization depending on how good the L1 cache is
  * on the architecture and how many memory issue slots there
- * are. Currently only intended for Hexagon. */
+ * are. Overlapping vector loads that slide by a whole vector per
+ * iteration, such as the taps of a vectorized stencil, are rebuilt
+ * from a run of whole vectors which are then carried and rotated
+ * from one iteration to the next, as long as the windows span no
+ * more than a few vectors. Loops on other devices are left
+ * alone. Always run by the Hexagon backend, and on other targets only
+ * with the loop_carry target feature. */
 Stmt loop_carry(Stmt, int max_carried_values = 8);
 
 }
@@ -15,8 +15,11 @@
 #include "DebugToFile.h"
 #include "DeepCopy.h"
 #include "Deinterleave.h"
+#include "DivideByInvariant.h"
 #include "EarlyFree.h"
+#include "EmulateFloat16Math.h"
 #include "FindCalls.h"
+#include "ForkStages.h"
 #include "Function.h"
 #include "FuseGPUThreadLoops.h"
 #include "FuzzFloatStores.h"
@@ -25,11 +28,13 @@
 #include "InjectImageIntrinsics.h"
 #include "InjectOpenGLIntrinsics.h"
 #include "Inline.h"
+#include "LICM.h"
 #include "IRMutator.h"
 #include "IROperator.h"
 #include "IRPrinter.h"
 #include "LoopCarry.h"
 #include "Memoization.h"
+#include "ParamProfiling.h"
 #include "PartitionLoops.h"
 #include "Prefetch.h"
 #include "Profiling.h"
@@ -39,6 +44,7 @@
 #include "RemoveTrivialForLoops.h"
 #include "RemoveUndef.h"
 #include "ScheduleFunctions.h"
+#include "ScratchStorage.h"
 #include "SelectGPUAPI.h"
 #include "SkipStages.h"
 #include "SlidingWindow.h"
@@ -53,6 +59,7 @@
 #include "UniquifyVariableNames.h"
 #include "UnrollLoops.h"
 #include "VaryingAttributes.h"
+#include "VectorMath.h"
 #include "VectorizeLoops.h"
 #include "WrapCalls.h"
 
@@ -65,7 +72,8 @@ using std::string;
 using std::vector;
 using std::map;
 
-Stmt lower(vector<Function> outputs, const string &pipeline_name, const Target &t, const vector<IRMutator *> &custom_passes) {
+Stmt lower(vector<Function> outputs, const string &pipeline_name, const Target &t, const vector<IRMutator *> &custom_passes,
+           bool concurrent_stages) {
 
     // Compute an environment
     map<string, Function> env;
@@ -131,6 +139,10 @@ Stmt lower(vector<Function> outputs, const string &pipeline_name, const Target &
     s = bounds_inference(s, outputs, order, env, func_bounds, t);
     debug(2) << "Lowering after computation bounds inference:\n" << s << '\n';
 
+    debug(1) << "Specializing for expected image shapes...\n";
+    s = specialize_image_shapes(s, outputs, t);
+    debug(2) << "Lowering after specializing for expected image shapes:\n" << s << '\n';
+
     debug(1) << "Performing sliding window optimization...\n";
     s = sliding_window(s, env);
     debug(2) << "Lowering after sliding window:\n" << s << '\n';
@@ -218,21 +230,37 @@ Stmt lower(vector<Function> outputs, const string &pipeline_name, const Target &
     s = remove_trivial_for_loops(s);
     debug(2) << "Lowering after second simplifcation:\n" << s << "\n\n";
 
+    debug(1) << "Sharing scratch storage within fuse groups...\n";
+    s = share_scratch_storage(s, env);
+    debug(2) << "Lowering after sharing scratch storage:\n" << s << "\n\n";
+
     debug(1) << "Unrolling...\n";
     s = unroll_loops(s);
     s = simplify(s);
     debug(2) << "Lowering after unrolling:\n" << s << "\n\n";
 
     debug(1) << "Vectorizing...\n";
-    s = vectorize_loops(s);
+    s = vectorize_loops(s, t);
     s = simplify(s);
+    s = accumulate_vector_reductions(s);
     debug(2) << "Lowering after vectorizing:\n" << s << "\n\n";
 
+    if (t.has_feature(Target::FastVectorMath)) {
+        debug(1) << "Approximating vectorized transcendentals...\n";
+        s = approximate_vector_math(s);
+        debug(2) << "Lowering after approximating vectorized transcendentals:\n" << s << "\n\n";
+    }
+
     debug(1) << "Detecting vector interleavings...\n";
     s = rewrite_interleavings(s);
     s = simplify(s);
     debug(2) << "Lowering after rewriting vector interleavings:\n" << s << "\n\n";
 
+    debug(1) << "Detecting vector transposes...\n";
+    s = rewrite_transposes(s);
+    s = simplify(s);
+    debug(2) << "Lowering after rewriting vector transposes:\n" << s << "\n\n";
+
     debug(1) << "Partitioning loops to simplify boundary conditions...\n";
     s = partition_loops(s);
     s = simplify(s);
@@ -242,6 +270,30 @@ Stmt lower(vector<Function> outputs, const string &pipeline_name, const Target &
     s = trim_no_ops(s);
     debug(2) << "Lowering after loop trimming:\n" << s << "\n\n";
 
+    debug(1) << "Optimizing vector division by invariant values...\n";
+    s = optimize_invariant_divisions(s);
+    debug(2) << "Lowering after optimizing vector division:\n" << s << "\n\n";
+
+    debug(1) << "Hoisting loop invariant values...\n";
+    s = loop_invariant_code_motion(s);
+    s = simplify(s);
+    debug(2) << "Lowering after hoisting loop invariant values:\n" << s << "\n\n";
+
+    if (t.arch != Target::Hexagon && t.has_feature(Target::LoopCarry)) {
+        // The Hexagon backend always does this itself, after aligning
+        // loads, and for the code offloaded to Hexagon.
+        debug(1) << "Carrying values across loop iterations...\n";
+        s = loop_carry(s);
+        s = simplify(s);
+        debug(2) << "Lowering after carrying values across loop iterations:\n" << s << "\n\n";
+    }
+
+    if (concurrent_stages) {
+        debug(1) << "Forking independent stages...\n";
+        s = fork_independent_stages(s);
+        debug(2) << "Lowering after forking independent stages:\n" << s << "\n\n";
+    }
+
     debug(1) << "Injecting early frees...\n";
     s = inject_early_frees(s);
     debug(2) << "Lowering after injecting early frees:\n" << s << "\n\n";
@@ -252,12 +304,22 @@ Stmt lower(vector<Function> outputs, const string &pipeline_name, const Target &
         debug(2) << "Lowering after injecting profiling:\n" << s << "\n\n";
     }
 
+    if (t.has_feature(Target::ProfileParams)) {
+        debug(1) << "Injecting parameter profiling...\n";
+        s = inject_param_profiling(s, pipeline_name, outputs, t);
+        debug(2) << "Lowering after injecting parameter profiling:\n" << s << "\n\n";
+    }
+
     if (t.has_feature(Target::FuzzFloatStores)) {
         debug(1) << "Fuzzing floating point stores...\n";
         s = fuzz_float_stores(s);
         debug(2) << "Lowering after fuzzing floating point stores:\n" << s << "\n\n";
     }
 
+    debug(1) << "Emulating float16 math...\n";
+    s = emulate_float16_math(s, t);
+    debug(2) << "Lowering after emulating float16 math:\n" << s << "\n\n";
+
     debug(1) << "Simplifying...\n";
     s = common_subexpression_elimination(s);
 
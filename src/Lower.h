@@ -17,9 +17,12 @@ class IRMutator;
 
 /** Given a halide function with a schedule, create a statement that
  * evaluates it. Automatically pulls in all the functions f depends
- * on. Some stages of lowering may be target-specific. */
+ * on. Some stages of lowering may be target-specific. If
+ * concurrent_stages is true, sibling stages that don't depend on
+ * each other are run concurrently on the thread pool. */
 EXPORT Stmt lower(std::vector<Function> outputs, const std::string &pipeline_name, const Target &t,
-                  const std::vector<IRMutator *> &custom_passes = std::vector<IRMutator *>());
+                  const std::vector<IRMutator *> &custom_passes = std::vector<IRMutator *>(),
+                  bool concurrent_stages = false);
 
 void lower_test();
 
@@ -0,0 +1,169 @@
+#include "OptimizeShuffles.h"
+#include "IRMutator.h"
+#include "IROperator.h"
+#include "IREquality.h"
+#include "CSE.h"
+#include "Simplify.h"
+#include "Scope.h"
+#include "Bounds.h"
+
+namespace Halide {
+namespace Internal {
+
+using std::vector;
+using std::string;
+using std::pair;
+
+namespace {
+
+// Find an upper bound of bounds.max - bounds.min.
+Expr span_of_bounds(Interval bounds) {
+    internal_assert(bounds.is_bounded());
+
+    const Min *min_min = bounds.min.as<Min>();
+    const Max *min_max = bounds.min.as<Max>();
+    const Min *max_min = bounds.max.as<Min>();
+    const Max *max_max = bounds.max.as<Max>();
+    const Add *min_add = bounds.min.as<Add>();
+    const Add *max_add = bounds.max.as<Add>();
+    const Sub *min_sub = bounds.min.as<Sub>();
+    const Sub *max_sub = bounds.max.as<Sub>();
+
+    if (min_min && max_min && equal(min_min->b, max_min->b)) {
+        return span_of_bounds({min_min->a, max_min->a});
+    } else if (min_max && max_max && equal(min_max->b, max_max->b)) {
+        return span_of_bounds({min_max->a, max_max->a});
+    } else if (min_add && max_add && equal(min_add->b, max_add->b)) {
+        return span_of_bounds({min_add->a, max_add->a});
+    } else if (min_sub && max_sub && equal(min_sub->b, max_sub->b)) {
+        return span_of_bounds({min_sub->a, max_sub->a});
+    } else {
+        return bounds.max - bounds.min;
+    }
+}
+
+// Replace indirect loads with dynamic_shuffle intrinsics where
+// possible.
+class OptimizeShuffles : public IRMutator {
+    int lut_alignment;
+    int max_lut_size;
+    int lut_element_bits;
+    Scope<Interval> bounds;
+    vector<pair<string, Expr>> lets;
+
+    using IRMutator::visit;
+
+    template <typename T>
+    void visit_let(const T *op) {
+        // We only care about vector lets.
+        if (op->value.type().is_vector()) {
+            bounds.push(op->name, bounds_of_expr_in_scope(op->value, bounds));
+        }
+        IRMutator::visit(op);
+        if (op->value.type().is_vector()) {
+            bounds.pop(op->name);
+        }
+    }
+
+    void visit(const Let *op) {
+        lets.push_back({op->name, op->value});
+        visit_let(op);
+        lets.pop_back();
+    }
+    void visit(const LetStmt *op) { visit_let(op); }
+
+    void visit(const For *op) {
+        if (op->device_api != DeviceAPI::None &&
+            op->device_api != DeviceAPI::Host) {
+            // Device code doesn't know about dynamic_shuffle.
+            stmt = op;
+        } else {
+            IRMutator::visit(op);
+        }
+    }
+
+    void visit(const Load *op) {
+        if (!op->type.is_vector() || op->index.as<Ramp>() ||
+            !is_one(op->predicate) ||
+            (lut_element_bits != 0 && op->type.bits() != lut_element_bits)) {
+            // Don't handle scalar, simple, or predicated vector
+            // loads, or tables of the wrong element type.
+            IRMutator::visit(op);
+            return;
+        }
+
+        Expr index = mutate(op->index);
+        Interval unaligned_index_bounds = bounds_of_expr_in_scope(index, bounds);
+        if (unaligned_index_bounds.is_bounded()) {
+            // We want to try both the unaligned and aligned
+            // bounds. The unaligned bounds might fit in the LUT,
+            // while the aligned bounds do not.
+            vector<Interval> candidates;
+            if (lut_alignment != 0) {
+                int align = std::max(1, lut_alignment / op->type.bytes());
+                candidates.push_back({
+                    (unaligned_index_bounds.min / align) * align,
+                    ((unaligned_index_bounds.max + align) / align) * align - 1
+                });
+            }
+            candidates.push_back(unaligned_index_bounds);
+
+            for (Interval index_bounds : candidates) {
+                Expr index_span = span_of_bounds(index_bounds);
+                index_span = common_subexpression_elimination(index_span);
+                index_span = simplify(index_span);
+
+                if (can_prove(index_span < max_lut_size)) {
+                    // This is a lookup within an up to max_lut_size
+                    // element array. We can use dynamic_shuffle for this.
+                    const int64_t *const_span = as_const_int(index_span);
+                    if (!const_span && lut_alignment == 0) {
+                        // Loading max_lut_size elements could run off
+                        // the end of the buffer.
+                        continue;
+                    }
+                    int const_extent = const_span ? (int)*const_span + 1 : max_lut_size;
+                    Expr base = simplify(index_bounds.min);
+
+                    // Load all of the possible indices loaded from the
+                    // LUT. Note that for clamped ramps with a non-zero
+                    // lut_alignment, this loads up to 1 vector past the
+                    // max. CodeGen_Hexagon::allocation_padding returns a
+                    // native vector size to account for this.
+                    Expr lut = Load::make(op->type.with_lanes(const_extent), op->name,
+                                          Ramp::make(base, 1, const_extent),
+                                          op->image, op->param);
+
+                    // We know the size of the LUT is not more than 256, so we
+                    // can safely cast the index to 8 bit, which
+                    // dynamic_shuffle requires.
+                    index = simplify(cast(UInt(8).with_lanes(op->type.lanes()), index - base));
+
+                    expr = Call::make(op->type, "dynamic_shuffle", {lut, index, 0, const_extent - 1}, Call::PureIntrinsic);
+                    return;
+                }
+            }
+        }
+        if (!index.same_as(op->index)) {
+            expr = Load::make(op->type, op->name, index, op->image, op->param, op->predicate);
+        } else {
+            expr = op;
+        }
+    }
+
+public:
+    OptimizeShuffles(int lut_alignment, int max_lut_size, int lut_element_bits)
+        : lut_alignment(lut_alignment), max_lut_size(max_lut_size), lut_element_bits(lut_element_bits) {
+        internal_assert(max_lut_size <= 256)
+            << "dynamic_shuffle indices are 8 bit, so LUTs are limited to 256 elements\n";
+    }
+};
+
+}  // namespace
+
+Stmt optimize_shuffles(Stmt s, int lut_alignment, int max_lut_size, int lut_element_bits) {
+    return OptimizeShuffles(lut_alignment, max_lut_size, lut_element_bits).mutate(s);
+}
+
+}  // namespace Internal
+}  // namespace Halide
@@ -0,0 +1,31 @@
+#ifndef HALIDE_OPTIMIZE_SHUFFLES_H
+#define HALIDE_OPTIMIZE_SHUFFLES_H
+
+/** \file
+ * Defines a lowering pass that replaces indirect loads from small
+ * lookup tables with in-register shuffles.
+ */
+
+#include "IR.h"
+
+namespace Halide {
+namespace Internal {
+
+/** Replace indirect vector loads whose indices provably span fewer
+ * than max_lut_size elements with a dense load of the table and a
+ * "dynamic_shuffle" intrinsic call of the form (lut, uint8 index,
+ * min index, max index). If lut_element_bits is non-zero, only tables
+ * with elements of that width are considered.
+ *
+ * A non-zero lut_alignment (in bytes) permits the table load to be
+ * rounded out to that alignment, or to max_lut_size elements when the
+ * span is not constant. This reads past the end of the table, so it
+ * is only valid on targets that pad their allocations. With a
+ * lut_alignment of zero, only tables of exactly the index span are
+ * loaded. Loops that run on a device are left alone. */
+EXPORT Stmt optimize_shuffles(Stmt s, int lut_alignment, int max_lut_size, int lut_element_bits = 0);
+
+}  // namespace Internal
+}  // namespace Halide
+
+#endif
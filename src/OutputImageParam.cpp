@@ -82,6 +82,25 @@ OutputImageParam::Dimension OutputImageParam::Dimension::set_bounds(Expr min, Ex
     return set_min(min).set_extent(extent);
 }
 
+OutputImageParam::Dimension OutputImageParam::Dimension::specialize_extent(int extent) {
+    param.set_extent_specialization(d, extent);
+    return *this;
+}
+
+OutputImageParam::Dimension OutputImageParam::Dimension::specialize_min(int min) {
+    param.set_min_specialization(d, min);
+    return *this;
+}
+
+OutputImageParam::Dimension OutputImageParam::Dimension::specialize_stride(int stride) {
+    param.set_stride_specialization(d, stride);
+    return *this;
+}
+
+OutputImageParam::Dimension OutputImageParam::Dimension::specialize_bounds(int min, int extent) {
+    return specialize_min(min).specialize_extent(extent);
+}
+
 OutputImageParam::Dimension OutputImageParam::Dimension::dim(int i) {
     return OutputImageParam::Dimension(param, i);
 }
@@ -81,6 +81,32 @@ public:
         /** Set the min and extent in one call. */
         EXPORT Dimension set_bounds(Expr min, Expr extent);
 
+        /** Declare the extent this dimension is expected to have on
+         * most calls. Unlike set_extent, other extents are still
+         * allowed. The pipeline gets a second copy of its code in
+         * which the extent is known, and in which the bounds checks
+         * and bounds query handling fold away. A single test at the
+         * top of the pipeline picks between that copy and the
+         * general one. E.g. for a pipeline that is usually run on
+         * dense 256x256 tiles:
+         \code
+         im.dim(0).specialize_bounds(0, 256).specialize_stride(1);
+         im.dim(1).specialize_bounds(0, 256).specialize_stride(256);
+         \endcode
+         * Each call to a specialize method adds to the test, so only
+         * specialize the values you really expect to be fixed. */
+        EXPORT Dimension specialize_extent(int extent);
+
+        /** Declare the min or stride this dimension is expected to
+         * have. See specialize_extent. */
+        // @{
+        EXPORT Dimension specialize_min(int min);
+        EXPORT Dimension specialize_stride(int stride);
+        // @}
+
+        /** Declare the expected min and extent in one call. */
+        EXPORT Dimension specialize_bounds(int min, int extent);
+
         /** Get a different dimension of the same buffer */
         // @{
         EXPORT Dimension dim(int i);
@@ -0,0 +1,277 @@
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+
+#include "ParamProfiling.h"
+#include "FindCalls.h"
+#include "Func.h"
+#include "IROperator.h"
+#include "IRVisitor.h"
+
+namespace Halide {
+namespace Internal {
+
+using std::map;
+using std::pair;
+using std::string;
+using std::vector;
+
+namespace {
+
+// Find the scalar and buffer parameters referred to by some IR.
+class FindParameters : public IRGraphVisitor {
+    using IRGraphVisitor::visit;
+
+    void found(const Parameter &p) {
+        if (!p.defined()) {
+            return;
+        }
+        if (p.is_buffer()) {
+            buffers[p.name()] = p;
+        } else {
+            scalars[p.name()] = p;
+        }
+    }
+
+    void visit(const Variable *op) {
+        found(op->param);
+    }
+
+    void visit(const Load *op) {
+        IRGraphVisitor::visit(op);
+        found(op->param);
+    }
+
+    void visit(const Call *op) {
+        IRGraphVisitor::visit(op);
+        found(op->param);
+    }
+
+public:
+    map<string, Parameter> scalars, buffers;
+
+    void add_output_buffers(const vector<Function> &outputs) {
+        for (Function f : outputs) {
+            for (Parameter p : f.output_buffers()) {
+                buffers[p.name()] = p;
+            }
+        }
+    }
+};
+
+// Is a scalar parameter of a type whose values can be recorded
+// exactly as an int64?
+bool is_profiled_type(Type t) {
+    return t.is_bool() || t.is_int() || (t.is_uint() && t.bits() < 64);
+}
+
+// A field recorded for a scalar or buffer parameter: its name, the
+// Expr that holds its value, and where it comes from.
+struct ProfiledField {
+    string name;
+    Expr value;
+    Parameter param;
+    // The buffer dimension and whether this is its stride rather
+    // than its extent. Unused for scalars.
+    int dim;
+    bool is_stride;
+};
+
+vector<ProfiledField> profiled_fields(const FindParameters &params) {
+    vector<ProfiledField> fields;
+    for (const pair<string, Parameter> &p : params.scalars) {
+        Type t = p.second.type();
+        if (is_profiled_type(t)) {
+            fields.push_back({p.first, Variable::make(t, p.first, p.second), p.second, -1, false});
+        }
+    }
+    for (const pair<string, Parameter> &p : params.buffers) {
+        for (int i = 0; i < p.second.dimensions(); i++) {
+            string dim = std::to_string(i);
+            for (bool is_stride : {false, true}) {
+                string name = p.first + (is_stride ? ".stride." : ".extent.") + dim;
+                fields.push_back({name, Variable::make(Int(32), name, p.second), p.second, i, is_stride});
+            }
+        }
+    }
+    return fields;
+}
+
+// Is a buffer field already fixed, or already expected to have some
+// value?
+bool is_buffer_field_known(const ProfiledField &field) {
+    const Parameter &p = field.param;
+    if (field.is_stride) {
+        return p.stride_constraint(field.dim).defined() || p.stride_specialization(field.dim).defined();
+    } else {
+        return p.extent_constraint(field.dim).defined() || p.extent_specialization(field.dim).defined();
+    }
+}
+
+}  // namespace
+
+Stmt inject_param_profiling(Stmt s, const string &pipeline_name,
+                            const vector<Function> &outputs, const Target &t) {
+    FindParameters params;
+    s.accept(&params);
+    params.add_output_buffers(outputs);
+
+    vector<Stmt> records;
+    for (const ProfiledField &field : profiled_fields(params)) {
+        Expr record = Call::make(Int(32), "halide_param_profile_record",
+                                 {pipeline_name, field.name, cast(Int(64), field.value)},
+                                 Call::Extern);
+        records.push_back(Evaluate::make(record));
+    }
+    if (records.empty()) {
+        return s;
+    }
+    Stmt record = Block::make(records);
+
+    // Bounds queries would count every shape twice.
+    if (!t.has_feature(Target::NoBoundsQuery)) {
+        Expr is_bounds_query = const_false();
+        for (const pair<string, Parameter> &p : params.buffers) {
+            string inference_mode_name = p.first + ".host_and_dev_are_null";
+            is_bounds_query = is_bounds_query || Variable::make(UInt(1), inference_mode_name, p.second);
+        }
+        record = IfThenElse::make(!is_bounds_query, record);
+    }
+
+    return Block::make(record, s);
+}
+
+bool ParamProfile::parse(const string &report) {
+    std::istringstream lines(report);
+    string line;
+    while (std::getline(lines, line)) {
+        std::istringstream words(line);
+        string pipeline_name, field_name;
+        if (!(words >> pipeline_name)) {
+            // Skip blank lines.
+            continue;
+        }
+        uint64_t total;
+        if (!(words >> field_name >> total)) {
+            return false;
+        }
+        Field &field = fields[{pipeline_name, field_name}];
+        field.total += total;
+        int64_t value;
+        uint64_t count;
+        while (words >> value) {
+            if (!(words >> count)) {
+                return false;
+            }
+            field.counts[value] += count;
+        }
+        if (!words.eof()) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void ParamProfile::load(const string &filename) {
+    std::ifstream file(filename.c_str());
+    user_assert(file.good()) << "Could not open parameter profile " << filename << "\n";
+    std::stringstream report;
+    report << file.rdbuf();
+    user_assert(parse(report.str())) << "Malformed parameter profile " << filename << "\n";
+}
+
+const ParamProfile::Field *ParamProfile::find(const string &pipeline_name, const string &field_name) const {
+    auto it = fields.find({pipeline_name, field_name});
+    if (it == fields.end()) {
+        return nullptr;
+    }
+    return &it->second;
+}
+
+int specialize_on_param_profile(const vector<Function> &outputs,
+                                const string &pipeline_name,
+                                const ParamProfile &profile, int top_k) {
+    FindParameters params;
+    for (Function f : outputs) {
+        for (const pair<string, Function> &callee : find_transitive_calls(f)) {
+            callee.second.accept(&params);
+        }
+    }
+    params.add_output_buffers(outputs);
+
+    // Buffer fields that only ever had one value become part of the
+    // expected shape of the buffer (see specialize_image_shapes), and
+    // scalars that only ever had one value are tested along with
+    // every other specialization. Otherwise, as the first
+    // specialization to match wins, a field that never changes would
+    // hide all the specializations after it. Each other field is
+    // checked for one of its common values, and the most common are
+    // tested first.
+    Expr fixed;
+    vector<pair<uint64_t, Expr>> conditions;
+    for (const ProfiledField &field : profiled_fields(params)) {
+        bool is_buffer = field.dim >= 0;
+        if (is_buffer && is_buffer_field_known(field)) {
+            continue;
+        }
+        const ParamProfile::Field *dist = profile.find(pipeline_name, field.name);
+        if (!dist || dist->counts.empty()) {
+            continue;
+        }
+        if (dist->counts.size() == 1) {
+            Expr value = make_const(field.value.type(), dist->counts.begin()->first);
+            Parameter p = field.param;
+            if (!is_buffer) {
+                Expr c = field.value == value;
+                fixed = fixed.defined() ? (fixed && c) : c;
+            } else if (field.is_stride) {
+                p.set_stride_specialization(field.dim, value);
+            } else {
+                p.set_extent_specialization(field.dim, value);
+            }
+            continue;
+        }
+        vector<pair<uint64_t, int64_t>> values;
+        for (const pair<int64_t, uint64_t> &v : dist->counts) {
+            values.push_back({v.second, v.first});
+        }
+        std::stable_sort(values.begin(), values.end(),
+                         [](const pair<uint64_t, int64_t> &a, const pair<uint64_t, int64_t> &b) {
+                             return a.first > b.first;
+                         });
+        for (size_t i = 0; i < values.size() && (int)i < top_k; i++) {
+            if (values[i].first * 10 < dist->total) {
+                break;
+            }
+            Expr value = make_const(field.value.type(), values[i].second);
+            conditions.push_back({values[i].first, field.value == value});
+        }
+    }
+    std::stable_sort(conditions.begin(), conditions.end(),
+                     [](const pair<uint64_t, Expr> &a, const pair<uint64_t, Expr> &b) {
+                         return a.first > b.first;
+                     });
+    if (fixed.defined()) {
+        if (conditions.empty()) {
+            conditions.push_back({0, fixed});
+        } else {
+            for (pair<uint64_t, Expr> &c : conditions) {
+                c.second = fixed && c.second;
+            }
+        }
+    }
+
+    for (Function f : outputs) {
+        Func func(f);
+        for (const pair<uint64_t, Expr> &c : conditions) {
+            func.specialize(c.second);
+            for (int i = 0; i < func.num_update_definitions(); i++) {
+                func.update(i).specialize(c.second);
+            }
+        }
+    }
+    return (int)conditions.size();
+}
+
+}
+}
@@ -0,0 +1,96 @@
+#ifndef HALIDE_PARAM_PROFILING_H
+#define HALIDE_PARAM_PROFILING_H
+
+/** \file
+ * Defines the lowering pass that records the values of a pipeline's
+ * scalar parameters and buffer shapes when the target has the
+ * profile_params feature, and the means to turn such a profile back
+ * into specializations of the pipeline.
+ *
+ * The runtime keeps the most common values of each field (see
+ * runtime/param_profiler.cpp), and reports them at exit, or after
+ * each realization when jitting. The report goes to the file named by
+ * the environment variable HL_PARAM_PROFILE if it is set, and to
+ * halide_print otherwise. Each line describes one field:
+ *
+ * <pipeline_name> <field_name> <# of calls> (<value> <# of calls with that value>)*
+ *
+ * Fields are the names of scalar Params, and <buffer>.extent.<dim> or
+ * <buffer>.stride.<dim> for input and output buffers. Reports from
+ * many runs may be appended to the same file; they are summed when
+ * loaded.
+ *
+ * Sample output:
+ * blur radius 1000 3 712 5 250 1 38
+ * blur input.stride.0 1000 1 1000
+ * blur blur.extent.0 1000 1920 640 1280 360
+ */
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "IR.h"
+#include "Function.h"
+#include "Target.h"
+
+namespace Halide {
+namespace Internal {
+
+/** Take a statement representing a halide pipeline and insert calls
+ * that record the values of its integer scalar parameters and the
+ * extents and strides of its buffers on each run. Bounds queries are
+ * not recorded. */
+Stmt inject_param_profiling(Stmt s, const std::string &pipeline_name,
+                            const std::vector<Function> &outputs, const Target &t);
+
+/** The distribution of parameter values of some pipelines, as
+ * reported by the runtime when profiling parameters. */
+class ParamProfile {
+public:
+    struct Field {
+        /** The number of runs recorded. */
+        uint64_t total = 0;
+        /** The number of runs with each of the most common values. */
+        std::map<int64_t, uint64_t> counts;
+    };
+
+    /** Add the distributions in a report to this profile. Returns
+     * false if the report is malformed. */
+    EXPORT bool parse(const std::string &report);
+
+    /** Add the distributions in a report file to this profile. */
+    EXPORT void load(const std::string &filename);
+
+    /** Get the distribution of a field, or nullptr if it was never
+     * recorded. */
+    EXPORT const Field *find(const std::string &pipeline_name, const std::string &field_name) const;
+
+    bool empty() const {
+        return fields.empty();
+    }
+
+private:
+    std::map<std::pair<std::string, std::string>, Field> fields;
+};
+
+/** Specialize every stage of the outputs of a pipeline on the top_k
+ * most common values of each of its parameters in a profile, with the
+ * existing definition as the general fallback. Values seen in fewer
+ * than a tenth of the runs are not worth the code size. Fields that
+ * only ever had one value are not specialized on by themselves, as
+ * they would hide the others: buffer extents and strides become the
+ * expected shape of the buffer (see
+ * OutputImageParam::Dimension::specialize_extent), and scalars are
+ * added to the condition of every other specialization. Buffer fields
+ * that are already constrained or have an expected value are
+ * skipped. Returns the number of specializations added to each
+ * stage. */
+EXPORT int specialize_on_param_profile(const std::vector<Function> &outputs,
+                                       const std::string &pipeline_name,
+                                       const ParamProfile &profile, int top_k);
+
+}
+}
+
+#endif
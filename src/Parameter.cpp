@@ -19,6 +19,9 @@ struct ParameterContents {
     Expr min_constraint[4];
     Expr extent_constraint[4];
     Expr stride_constraint[4];
+    Expr min_specialization[4];
+    Expr extent_specialization[4];
+    Expr stride_specialization[4];
     Expr min_value, max_value;
     const bool is_buffer;
     const bool is_explicit_name;
@@ -238,6 +241,51 @@ Expr Parameter::stride_constraint(int dim) const {
     check_dim_ok(dim);
     return contents->stride_constraint[dim];
 }
+void Parameter::set_min_specialization(int dim, Expr e) {
+    check_is_buffer();
+    check_dim_ok(dim);
+    user_assert(!e.defined() || is_const(e))
+        << "Can't specialize the min of " << name() << " in dimension " << dim
+        << " to the non-constant value " << e << "\n";
+    contents->min_specialization[dim] = e.defined() ? cast<int>(e) : e;
+}
+
+void Parameter::set_extent_specialization(int dim, Expr e) {
+    check_is_buffer();
+    check_dim_ok(dim);
+    user_assert(!e.defined() || is_const(e))
+        << "Can't specialize the extent of " << name() << " in dimension " << dim
+        << " to the non-constant value " << e << "\n";
+    contents->extent_specialization[dim] = e.defined() ? cast<int>(e) : e;
+}
+
+void Parameter::set_stride_specialization(int dim, Expr e) {
+    check_is_buffer();
+    check_dim_ok(dim);
+    user_assert(!e.defined() || is_const(e))
+        << "Can't specialize the stride of " << name() << " in dimension " << dim
+        << " to the non-constant value " << e << "\n";
+    contents->stride_specialization[dim] = e.defined() ? cast<int>(e) : e;
+}
+
+Expr Parameter::min_specialization(int dim) const {
+    check_is_buffer();
+    check_dim_ok(dim);
+    return contents->min_specialization[dim];
+}
+
+Expr Parameter::extent_specialization(int dim) const {
+    check_is_buffer();
+    check_dim_ok(dim);
+    return contents->extent_specialization[dim];
+}
+
+Expr Parameter::stride_specialization(int dim) const {
+    check_is_buffer();
+    check_dim_ok(dim);
+    return contents->stride_specialization[dim];
+}
+
 int Parameter::host_alignment() const {
     check_is_buffer();
     return contents->host_alignment;
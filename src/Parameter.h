@@ -126,6 +126,18 @@ public:
     EXPORT int host_alignment() const;
     //@}
 
+    /** Get and set the constant min, extent, and stride a buffer is
+     * expected to have (see
+     * OutputImageParam::Dimension::specialize_extent) */
+    //@{
+    EXPORT void set_min_specialization(int dim, Expr e);
+    EXPORT void set_extent_specialization(int dim, Expr e);
+    EXPORT void set_stride_specialization(int dim, Expr e);
+    EXPORT Expr min_specialization(int dim) const;
+    EXPORT Expr extent_specialization(int dim) const;
+    EXPORT Expr stride_specialization(int dim) const;
+    //@}
+
     /** Get and set constraints for scalar parameters. These are used
      * directly by Param, so they must be exported. */
     // @{
@@ -69,7 +69,7 @@ class MarkClampedRampsAsLikely : public IRMutator {
         if (index.same_as(op->index) && value.same_as(op->value)) {
             stmt = op;
         } else {
-            stmt = Store::make(op->name, value, index, op->param);
+            stmt = Store::make(op->name, value, index, op->param, op->predicate);
         }
     }
 
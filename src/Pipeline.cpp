@@ -3,6 +3,7 @@
 #include "Pipeline.h"
 #include "Argument.h"
 #include "Func.h"
+#include "ImageParam.h"
 #include "IRVisitor.h"
 #include "LLVM_Headers.h"
 #include "LLVM_Output.h"
@@ -104,8 +105,12 @@ struct PipelineContents {
      * define_extern calls. */
     std::map<std::string, JITExtern> jit_externs;
 
+    /** Whether independent sibling stages should be run
+     * concurrently. */
+    bool concurrent_stages;
+
     PipelineContents() :
-        module("", Target()) {
+        module("", Target()), concurrent_stages(false) {
         // user_context needs to be a const void * (not a non-const void *)
         // to maintain backwards compatibility with existing code.
         user_context_arg.arg = Argument("__user_context", Argument::InputScalar, type_of<const void*>(), 0);
@@ -573,7 +578,8 @@ Module Pipeline::compile_to_module(const vector<Argument> &args,
             custom_passes.push_back(p.pass);
         }
 
-        private_body = lower(contents->outputs, fn_name, target, custom_passes);
+        private_body = lower(contents->outputs, fn_name, target, custom_passes,
+                             contents->concurrent_stages);
     }
 
     std::vector<std::string> namespaces;
@@ -675,9 +681,10 @@ void *Pipeline::compile_jit(const Target &target_arg) {
     infer_arguments(module.functions().back().body);
 
     std::map<std::string, JITExtern> lowered_externs = contents->jit_externs;
-    // Compile to jit module
-    JITModule jit_module(module, module.functions().back(),
-                         make_externs_jit_module(target_arg, lowered_externs));
+    // Compile to jit module, or reuse an equivalent one compiled for
+    // another Pipeline.
+    JITModule jit_module = JITCache::get(module, module.functions().back(),
+                                         make_externs_jit_module(target_arg, lowered_externs));
 
     // Dump bitcode to a file if the environment variable
     // HL_GENBITCODE is non-zero.
@@ -759,6 +766,19 @@ const vector<CustomLoweringPass> &Pipeline::custom_lowering_passes() {
     return contents->custom_lowering_passes;
 }
 
+void Pipeline::set_concurrent_stages(bool enable) {
+    user_assert(defined()) << "Pipeline is undefined\n";
+    if (contents->concurrent_stages != enable) {
+        contents->concurrent_stages = enable;
+        invalidate_cache();
+    }
+}
+
+bool Pipeline::concurrent_stages() const {
+    user_assert(defined()) << "Pipeline is undefined\n";
+    return contents->concurrent_stages;
+}
+
 const JITHandlers &Pipeline::jit_handlers() {
     user_assert(defined()) << "Pipeline is undefined\n";
     return contents->jit_handlers;
@@ -849,6 +869,18 @@ struct ErrorBuffer {
         return std::string(buf, end);
     }
 
+    // Pass the recorded errors to halide_runtime_error and clear them.
+    void report(int exit_status) {
+        std::string output = str();
+        if (output.empty()) {
+            output = ("The pipeline returned exit status " +
+                      std::to_string(exit_status) +
+                      " but halide_error was never called.\n");
+        }
+        end = 0;
+        halide_runtime_error << output;
+    }
+
     static void handler(void *ctx, const char *message) {
         if (ctx) {
             JITUserContext *ctx1 = (JITUserContext *)ctx;
@@ -890,14 +922,7 @@ struct JITFuncCallContext {
     void report_if_error(int exit_status) {
         // Only report the errors if no custom error handler was installed
         if (exit_status && !custom_error_handler) {
-            std::string output = error_buffer.str();
-            if (output.empty()) {
-                output = ("The pipeline returned exit status " +
-                          std::to_string(exit_status) +
-                          " but halide_error was never called.\n");
-            }
-            halide_runtime_error << output;
-            error_buffer.end = 0;
+            error_buffer.report(exit_status);
         }
     }
 
@@ -1154,9 +1179,262 @@ void Pipeline::realize(Realization dst, const Target &t) {
         }
     }
 
+    // Likewise for the most common parameter values.
+    if (target.has_feature(Target::ProfileParams)) {
+        JITModule::Symbol report_sym =
+            contents->jit_module.find_symbol_by_name("halide_param_profile_report");
+        JITModule::Symbol reset_sym =
+            contents->jit_module.find_symbol_by_name("halide_param_profile_reset");
+        if (report_sym.address && reset_sym.address) {
+            void *uc = jit_context.user_context_param.get_scalar<void *>();
+            void (*report_fn_ptr)(void *) = (void (*)(void *))(report_sym.address);
+            report_fn_ptr(uc);
+
+            void (*reset_fn_ptr)() = (void (*)())(reset_sym.address);
+            reset_fn_ptr();
+        }
+    }
+
     jit_context.finalize(exit_status);
 }
 
+struct PreparedPipelineContents {
+    mutable RefCount ref_count;
+
+    // Holds a reference to the compiled code.
+    JITModule module;
+    int (*argv_function)(const void **);
+
+    // The values passed to the argv function. The inputs point into
+    // the storage below, and the outputs are filled in on each call.
+    vector<const void *> args;
+    size_t num_inputs;
+
+    // For each input: its name, whether it's a buffer, and its type
+    // if it's a scalar.
+    vector<string> names;
+    vector<bool> is_buffer;
+    vector<Type> types;
+
+    // Storage for the inputs. Scalars are all at most 8 bytes.
+    vector<uint64_t> scalars;
+    vector<BufferPtr> buffers;
+    int unbound_buffers;
+
+    // The outputs, for checking the buffers passed in.
+    vector<Type> output_types;
+    vector<int> output_dims;
+
+    // The context the user_context argument points to. Made once.
+    ErrorBuffer error_buffer;
+    JITUserContext jit_context;
+    const void *user_context;
+    bool custom_error_handler;
+
+    void (*profiler_report)(void *);
+    void (*profiler_reset)();
+
+    PreparedPipelineContents() : argv_function(nullptr), num_inputs(0), unbound_buffers(0),
+                                 user_context(nullptr), custom_error_handler(false),
+                                 profiler_report(nullptr), profiler_reset(nullptr) {}
+
+    int find_input(const string &name, bool buffer) const {
+        for (size_t i = 0; i < num_inputs; i++) {
+            if (is_buffer[i] == buffer && names[i] == name) {
+                return (int)i;
+            }
+        }
+        user_error << "Pipeline was not prepared with an "
+                   << (buffer ? "ImageParam" : "Param") << " called \"" << name << "\"\n";
+        return -1;
+    }
+};
+
+namespace Internal {
+template<>
+EXPORT RefCount &ref_count<PreparedPipelineContents>(const PreparedPipelineContents *p) {
+    return p->ref_count;
+}
+
+template<>
+EXPORT void destroy<PreparedPipelineContents>(const PreparedPipelineContents *p) {
+    delete p;
+}
+}
+
+PreparedPipeline Pipeline::prepare(const Target &t) {
+    Target target = t;
+    user_assert(defined()) << "Can't prepare an undefined Pipeline\n";
+
+    // Resolve the target the same way realize does.
+    if (target.os == Target::OSUnknown) {
+        if (contents->jit_module.compiled()) {
+            target = contents->jit_target;
+        } else {
+            target = get_jit_target_from_environment();
+        }
+    }
+
+    compile_jit(target);
+
+    PreparedPipeline result;
+    result.contents = new PreparedPipelineContents;
+    PreparedPipelineContents &p = *result.contents;
+
+    p.module = contents->jit_module;
+    p.argv_function = p.module.argv_function();
+    internal_assert(p.argv_function);
+
+    // Set up the context once, as JITFuncCallContext does per call.
+    JITHandlers handlers = jit_handlers();
+    void *user_context = nullptr;
+    if (handlers.custom_error == nullptr) {
+        handlers.custom_error = ErrorBuffer::handler;
+        user_context = &p.error_buffer;
+    } else {
+        p.custom_error_handler = true;
+    }
+    JITSharedRuntime::init_jit_user_context(p.jit_context, user_context, handlers);
+    p.user_context = &p.jit_context;
+
+    // Bind the inputs to their current values.
+    const vector<InferredArgument> &input_args = contents->inferred_args;
+    p.num_inputs = input_args.size();
+    p.names.resize(p.num_inputs);
+    p.is_buffer.resize(p.num_inputs);
+    p.types.resize(p.num_inputs);
+    p.scalars.resize(p.num_inputs, 0);
+    p.buffers.resize(p.num_inputs);
+    p.args.resize(p.num_inputs);
+    for (size_t i = 0; i < p.num_inputs; i++) {
+        const InferredArgument &arg = input_args[i];
+        p.names[i] = arg.arg.name;
+        p.is_buffer[i] = arg.arg.is_buffer();
+        p.types[i] = arg.arg.type;
+        if (arg.param.defined() && arg.param.same_as(contents->user_context_arg.param)) {
+            p.args[i] = &p.user_context;
+        } else if (arg.param.defined() && arg.param.is_buffer()) {
+            p.buffers[i] = arg.param.get_buffer();
+            if (p.buffers[i].defined()) {
+                p.args[i] = p.buffers[i].raw_buffer();
+            } else {
+                p.args[i] = nullptr;
+                p.unbound_buffers++;
+            }
+        } else if (arg.param.defined()) {
+            internal_assert(arg.param.type().bytes() <= (int)sizeof(uint64_t));
+            memcpy(&p.scalars[i], arg.param.get_scalar_address(), arg.param.type().bytes());
+            p.args[i] = &p.scalars[i];
+        } else {
+            internal_assert(arg.buffer.defined());
+            p.buffers[i] = arg.buffer;
+            p.args[i] = p.buffers[i].raw_buffer();
+        }
+    }
+
+    // Leave room for the outputs.
+    for (Function f : contents->outputs) {
+        for (Type t : f.output_types()) {
+            p.output_types.push_back(t);
+            p.output_dims.push_back(f.dimensions());
+            p.args.push_back(nullptr);
+        }
+    }
+
+    if (target.has_feature(Target::Profile)) {
+        JITModule::Symbol report_sym = p.module.find_symbol_by_name("halide_profiler_report");
+        JITModule::Symbol reset_sym = p.module.find_symbol_by_name("halide_profiler_reset");
+        if (report_sym.address && reset_sym.address) {
+            p.profiler_report = (void (*)(void *))(report_sym.address);
+            p.profiler_reset = (void (*)())(reset_sym.address);
+        }
+    }
+
+    return result;
+}
+
+PreparedPipeline::PreparedPipeline() : contents(nullptr) {
+}
+
+bool PreparedPipeline::defined() const {
+    return contents.defined();
+}
+
+void PreparedPipeline::set_scalar(const string &name, Type t, const void *value) {
+    user_assert(defined()) << "Can't set a Param on an undefined PreparedPipeline\n";
+    PreparedPipelineContents &p = *contents;
+    int i = p.find_input(name, false);
+    user_assert(p.types[i] == t)
+        << "Can't set Param \"" << name << "\" of type " << p.types[i]
+        << " to a value of type " << t << "\n";
+    memcpy(&p.scalars[i], value, t.bytes());
+}
+
+PreparedPipeline &PreparedPipeline::set(const ImageParam &param, BufferPtr buf) {
+    user_assert(defined()) << "Can't set an ImageParam on an undefined PreparedPipeline\n";
+    PreparedPipelineContents &p = *contents;
+    int i = p.find_input(param.name(), true);
+    user_assert(!buf.defined() || buf.type() == param.type())
+        << "Can't bind ImageParam \"" << param.name() << "\" of type " << param.type()
+        << " to a Buffer of type " << buf.type() << "\n";
+    user_assert(!buf.defined() || buf.dimensions() == param.dimensions())
+        << "Can't bind " << param.dimensions() << "-dimensional ImageParam \"" << param.name()
+        << "\" to a " << buf.dimensions() << "-dimensional Buffer\n";
+    if (p.args[i] == nullptr) {
+        p.unbound_buffers--;
+    }
+    p.buffers[i] = buf;
+    if (buf.defined()) {
+        p.args[i] = buf.raw_buffer();
+    } else {
+        p.args[i] = nullptr;
+        p.unbound_buffers++;
+    }
+    return *this;
+}
+
+void PreparedPipeline::operator()(Realization dst) {
+    vector<buffer_t *> bufs(dst.size());
+    vector<halide_type_t> types(dst.size());
+    vector<int> dims(dst.size());
+    for (size_t i = 0; i < dst.size(); i++) {
+        bufs[i] = dst[i].raw_buffer();
+        types[i] = dst[i].type();
+        dims[i] = dst[i].dimensions();
+    }
+    run(bufs.data(), types.data(), dims.data(), dst.size());
+}
+
+void PreparedPipeline::run(buffer_t **outputs, const halide_type_t *types, const int *dims, size_t n) {
+    user_assert(defined()) << "Can't call an undefined PreparedPipeline\n";
+    PreparedPipelineContents &p = *contents;
+
+    user_assert(n == p.output_types.size())
+        << "Can't call prepared pipeline with " << p.output_types.size()
+        << " outputs with " << n << " Images\n";
+    user_assert(p.unbound_buffers == 0)
+        << "Can't call prepared pipeline because an ImageParam is not bound to a Buffer\n";
+    for (size_t i = 0; i < n; i++) {
+        user_assert(Type(types[i]) == p.output_types[i] && dims[i] == p.output_dims[i])
+            << "Can't realize output " << i << " of type " << p.output_types[i]
+            << " and dimensionality " << p.output_dims[i]
+            << " into a Buffer of type " << Type(types[i])
+            << " and dimensionality " << dims[i] << "\n";
+        p.args[p.num_inputs + i] = outputs[i];
+    }
+
+    int exit_status = p.argv_function(p.args.data());
+
+    if (p.profiler_report) {
+        p.profiler_report((void *)p.user_context);
+        p.profiler_reset();
+    }
+
+    if (exit_status && !p.custom_error_handler) {
+        p.error_buffer.report(exit_status);
+    }
+}
+
 void Pipeline::infer_input_bounds(Realization dst) {
 
     Target target = get_jit_target_from_environment();
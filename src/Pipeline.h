@@ -20,8 +20,11 @@ namespace Halide {
 
 struct Argument;
 class Func;
+class ImageParam;
 struct Outputs;
 struct PipelineContents;
+struct PreparedPipelineContents;
+template<typename T> class Param;
 
 namespace Internal {
 class IRMutator;
@@ -51,6 +54,7 @@ struct CustomLoweringPass {
 };
 
 struct JITExtern;
+class PreparedPipeline;
 
 /** A class representing a Halide pipeline. Constructed from the Func
  * or Funcs that it outputs. */
@@ -341,6 +345,19 @@ public:
     /** Get the custom lowering passes. */
     EXPORT const std::vector<CustomLoweringPass> &custom_lowering_passes();
 
+    /** Run stages that don't depend on each other concurrently. By
+     * default the stages of a pipeline are computed one after the
+     * other in the realization order, and each stage only
+     * parallelizes over its own parallel loops. With this set,
+     * consecutive sibling stages computed at the same loop level
+     * (e.g. independent compute_root Funcs) that neither read nor
+     * write each other's buffers are launched together as tasks on
+     * the thread pool. Off by default. */
+    // @{
+    EXPORT void set_concurrent_stages(bool enable);
+    EXPORT bool concurrent_stages() const;
+    // @}
+
     /** See Func::realize */
     // @{
     EXPORT Realization realize(std::vector<int32_t> sizes, const Target &target = Target());
@@ -363,6 +380,24 @@ public:
     }
     // @}
 
+    /** JIT-compile the pipeline and bind its arguments once, returning
+     * an object that can be called many times with much less overhead
+     * than realize. The prepared pipeline starts with the current
+     * values of all Params and ImageParams, and uses the custom
+     * handlers installed on this Pipeline at the time of the
+     * call. Later changes to the Pipeline's Params, ImageParams, or
+     * handlers do not affect it; use PreparedPipeline::set
+     * instead. E.g.:
+     \code
+     PreparedPipeline p = pipeline.prepare();
+     for (Image<float> &tile : tiles) {
+         p.set(gain, next_gain()).set(input, next_input());
+         p(tile);
+     }
+     \endcode
+     */
+    EXPORT PreparedPipeline prepare(const Target &target = Target());
+
     /** For a given size of output, or a given set of output buffers,
      * determine the bounds required of all unbound ImageParams
      * referenced. Communicates the result by allocating new buffers
@@ -460,6 +495,54 @@ void init_arg_types(std::vector<ScalarOrBufferT> &arg_types) {
 
 }
 
+/** A JIT-compiled Pipeline with its arguments bound, made by
+ * Pipeline::prepare. Calling it only fills in the output buffers and
+ * jumps into the compiled code: it does none of the argument
+ * inference, validation, or context setup done by
+ * Pipeline::realize. A PreparedPipeline may not be called from
+ * more than one thread at once. */
+class PreparedPipeline {
+    Internal::IntrusivePtr<PreparedPipelineContents> contents;
+
+    friend class Pipeline;
+
+    EXPORT void set_scalar(const std::string &name, Type t, const void *value);
+    EXPORT void run(buffer_t **outputs, const halide_type_t *types, const int *dims, size_t n);
+
+public:
+    /** Make an undefined PreparedPipeline object. */
+    EXPORT PreparedPipeline();
+
+    /** Check if this object has been made by Pipeline::prepare. */
+    EXPORT bool defined() const;
+
+    /** Set the value of a Param for subsequent calls. */
+    template<typename T, typename T2>
+    PreparedPipeline &set(const Param<T> &p, T2 value) {
+        T val = (T)value;
+        set_scalar(p.name(), type_of<T>(), &val);
+        return *this;
+    }
+
+    /** Bind an ImageParam to a buffer for subsequent calls. The
+     * prepared pipeline keeps a reference to the buffer. */
+    EXPORT PreparedPipeline &set(const ImageParam &p, Internal::BufferPtr buf);
+
+    /** Run the pipeline into the given output buffers. Only the
+     * number, types, and dimensionality of the buffers are checked. */
+    // @{
+    EXPORT void operator()(Realization dst);
+
+    template<typename T, int D>
+    void operator()(Image<T, D> &dst) {
+        buffer_t *buf = dst.raw_buffer();
+        halide_type_t t = dst.type();
+        int dims = dst.dimensions();
+        run(&buf, &t, &dims, 1);
+    }
+    // @}
+};
+
 struct JITExtern {
     // assert pipeline.defined() == (c_function == nullptr) -- strictly one or the other
     // which should be enforced by the constructors.
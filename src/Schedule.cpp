@@ -93,6 +93,8 @@ struct ScheduleContents {
     bool memoized;
     bool touched;
     bool allow_race_conditions;
+    std::string fuse_group;
+    Expr sliding_strip;
 
     ScheduleContents() : memoized(false), touched(false), allow_race_conditions(false) {};
 
@@ -130,6 +132,9 @@ struct ScheduleContents {
                 p.offset = mutator->mutate(p.offset);
             }
         }
+        if (sliding_strip.defined()) {
+            sliding_strip = mutator->mutate(sliding_strip);
+        }
     }
 };
 
@@ -162,6 +167,8 @@ Schedule Schedule::deep_copy(
     copy.contents->memoized = contents->memoized;
     copy.contents->touched = contents->touched;
     copy.contents->allow_race_conditions = contents->allow_race_conditions;
+    copy.contents->fuse_group = contents->fuse_group;
+    copy.contents->sliding_strip = contents->sliding_strip;
 
     // Deep-copy wrapper functions. If function has already been deep-copied before,
     // i.e. it's in the 'copied_map', use the deep-copied version from the map instead
@@ -288,6 +295,22 @@ bool Schedule::allow_race_conditions() const {
     return contents->allow_race_conditions;
 }
 
+const std::string &Schedule::fuse_group() const {
+    return contents->fuse_group;
+}
+
+std::string &Schedule::fuse_group() {
+    return contents->fuse_group;
+}
+
+const Expr &Schedule::sliding_strip() const {
+    return contents->sliding_strip;
+}
+
+Expr &Schedule::sliding_strip() {
+    return contents->sliding_strip;
+}
+
 void Schedule::accept(IRVisitor *visitor) const {
     for (const ReductionVariable &r : rvars()) {
         if (r.min.defined()) {
@@ -321,6 +344,9 @@ void Schedule::accept(IRVisitor *visitor) const {
             p.offset.accept(visitor);
         }
     }
+    if (sliding_strip().defined()) {
+        sliding_strip().accept(visitor);
+    }
 }
 
 void Schedule::mutate(IRMutator *mutator) {
@@ -58,6 +58,22 @@ enum class TailStrategy {
      * instead of a multiple of the split factor as with RoundUp. */
     ShiftInwards,
 
+    /** Like GuardWithIf, but also shift the start of the loop
+     * back so that each iteration of the outer loop begins at a
+     * coordinate that is a multiple of the split factor relative
+     * to the min of the Func's storage. The first and last
+     * iterations are guarded with if statements, which get
+     * factored out into a loop prologue and epilogue, so the
+     * steady state of a vectorized loop stores whole aligned
+     * vectors. Always legal. Pros: avoids stores that straddle
+     * cache lines in memory-bound stages, and loads of other
+     * buffers at the same coordinates are aligned too if those
+     * buffers have the same min. Cons: like GuardWithIf,
+     * increases code size; if the split variable isn't used
+     * directly as a coordinate of the Func, there's nothing to
+     * align to and this is the same as GuardWithIf. */
+    PeelToAlign,
+
     /** For pure definitions use ShiftInwards. For pure vars in
      * update definitions use RoundUp. For RVars in update
      * definitions use GuardWithIf. */
@@ -313,6 +329,24 @@ public:
     bool &allow_race_conditions();
     // @}
 
+    /** The name of the Func whose tiles this function is computed
+     * in as part of a fused group, or empty if it's not part of
+     * one. Members of the same group computed at the same loop level
+     * share one scratch allocation. See \ref Func::fuse_group */
+    // @{
+    const std::string &fuse_group() const;
+    std::string &fuse_group();
+    // @}
+
+    /** The number of iterations per strip to use when splitting a
+     * parallel loop so that this function can slide over it, or
+     * undefined to choose one automatically. See \ref
+     * Func::sliding_strip */
+    // @{
+    const Expr &sliding_strip() const;
+    Expr &sliding_strip();
+    // @}
+
     /** Pass an IRVisitor through to all Exprs referenced in the
      * Schedule. */
     void accept(IRVisitor *) const;
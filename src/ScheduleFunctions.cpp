@@ -96,6 +96,10 @@ Stmt build_provide_loop_nest_helper(string func_name,
 
     vector<Split> splits = s.splits();
 
+    // The min of the storage dimension each split using PeelToAlign
+    // aligns its loop to, by name of the split var.
+    map<string, Expr> peel_alignment_min;
+
     // Define the function args in terms of the loop variables using the splits
     for (const Split &split : splits) {
         Expr outer = Variable::make(Int(32), prefix + split.outer);
@@ -125,9 +129,10 @@ Stmt build_provide_loop_nest_helper(string func_name,
 
             if (split.exact) {
                 user_assert(split.tail == TailStrategy::Auto ||
-                            split.tail == TailStrategy::GuardWithIf)
+                            split.tail == TailStrategy::GuardWithIf ||
+                            split.tail == TailStrategy::PeelToAlign)
                     << "When splitting Var " << split.old_var
-                    << " the tail strategy must be GuardWithIf or Auto. "
+                    << " the tail strategy must be GuardWithIf, PeelToAlign, or Auto. "
                     << "Anything else may change the meaning of the algorithm\n";
             }
 
@@ -142,7 +147,31 @@ Stmt build_provide_loop_nest_helper(string func_name,
                 }
             }
 
-            if ((iter != dim_extent_alignment.end()) &&
+            Expr peel;
+            if (tail == TailStrategy::PeelToAlign) {
+                // We can only align the loop to the storage if the
+                // split var is used directly as a coordinate.
+                // Otherwise fall back to GuardWithIf.
+                string buffer_name = func_name;
+                if (values.size() > 1) {
+                    buffer_name += ".0";
+                }
+                for (size_t i = 0; i < site.size(); i++) {
+                    const Variable *v = site[i].as<Variable>();
+                    if (v && v->name == old_var_name) {
+                        peel_alignment_min[split.old_var] =
+                            Variable::make(Int(32), buffer_name + ".min." + std::to_string(i));
+                        peel = Variable::make(Int(32), old_var_name + ".peel");
+                        break;
+                    }
+                }
+                if (!peel.defined()) {
+                    tail = TailStrategy::GuardWithIf;
+                }
+            }
+
+            if (!peel.defined() &&
+                (iter != dim_extent_alignment.end()) &&
                 is_zero(simplify(iter->second % split.factor))) {
                 // We have proved that the split factor divides the
                 // old extent. No need to adjust the base or add an if
@@ -154,6 +183,27 @@ Stmt build_provide_loop_nest_helper(string func_name,
             } else if (is_one(split.factor)) {
                 // The split factor trivially divides the old extent,
                 // but we know nothing new about the outer dimension.
+            } else if (peel.defined()) {
+                // Start the outer loop peel points before the old
+                // min, at the last coordinate before it that's a
+                // multiple of the split factor from the min of the
+                // storage. Then guard both ends as in GuardWithIf
+                // below. Partitioning the outer loop on these
+                // conditions peels off a prologue, leaving a steady
+                // state that starts each inner loop at an aligned
+                // address.
+                Expr rebased = outer * split.factor + inner - peel;
+                string rebased_var_name = prefix + split.old_var + ".rebased";
+                Expr rebased_var = Variable::make(Int(32), rebased_var_name);
+                stmt = substitute(prefix + split.old_var, rebased_var + old_min, stmt);
+
+                // The conditions are separate if statements so that
+                // bounds inference can trim the domain by each.
+                stmt = IfThenElse::make(likely(rebased_var < old_extent), stmt, Stmt());
+                stmt = IfThenElse::make(likely(rebased_var >= 0), stmt, Stmt());
+                stmt = LetStmt::make(rebased_var_name, rebased, stmt);
+
+                base = base - peel;
             } else if (tail == TailStrategy::GuardWithIf) {
                 // It's an exact split but we failed to prove that the
                 // extent divides the factor. Use predication.
@@ -324,12 +374,23 @@ Stmt build_provide_loop_nest_helper(string func_name,
         if (split.is_split()) {
             Expr inner_extent = split.factor;
             Expr outer_extent = (old_var_max - old_var_min + split.factor)/split.factor;
+            map<string, Expr>::iterator peel_min = peel_alignment_min.find(split.old_var);
+            string peel_name = prefix + split.old_var + ".peel";
+            if (peel_min != peel_alignment_min.end()) {
+                // The peeled points need an extra iteration of the
+                // outer loop.
+                Expr peel = Variable::make(Int(32), peel_name);
+                outer_extent = (old_var_max - old_var_min + peel + split.factor)/split.factor;
+            }
             stmt = LetStmt::make(prefix + split.inner + ".loop_min", 0, stmt);
             stmt = LetStmt::make(prefix + split.inner + ".loop_max", inner_extent-1, stmt);
             stmt = LetStmt::make(prefix + split.inner + ".loop_extent", inner_extent, stmt);
             stmt = LetStmt::make(prefix + split.outer + ".loop_min", 0, stmt);
             stmt = LetStmt::make(prefix + split.outer + ".loop_max", outer_extent-1, stmt);
             stmt = LetStmt::make(prefix + split.outer + ".loop_extent", outer_extent, stmt);
+            if (peel_min != peel_alignment_min.end()) {
+                stmt = LetStmt::make(peel_name, (old_var_min - peel_min->second) % split.factor, stmt);
+            }
         } else if (split.is_fuse()) {
             // Define bounds on the fused var using the bounds on the inner and outer
             Expr inner_extent = Variable::make(Int(32), prefix + split.inner + ".loop_extent");
@@ -0,0 +1,324 @@
+#include <algorithm>
+
+#include "ScratchStorage.h"
+#include "Bounds.h"
+#include "Debug.h"
+#include "Function.h"
+#include "IRMutator.h"
+#include "IROperator.h"
+#include "Simplify.h"
+
+namespace Halide {
+namespace Internal {
+
+using std::map;
+using std::set;
+using std::string;
+using std::vector;
+
+namespace {
+
+// Buffers within the scratch allocation start on cache line
+// boundaries, which also keeps them aligned for vector loads.
+const int64_t scratch_alignment = 64;
+
+struct ScratchBuffer {
+    string name;
+    Type type;
+    int64_t bytes;
+    // The range of producers (in program order) over which the
+    // buffer is live.
+    int first, last;
+    int64_t offset;
+};
+
+// The fuse group that the Func backing a buffer belongs to, or the
+// empty string.
+string fuse_group_of(const string &buffer, const map<string, Function> &env) {
+    auto iter = env.find(buffer);
+    if (iter == env.end()) {
+        // Tuple-valued Funcs have one buffer per element, named f.0, f.1, ...
+        size_t dot = buffer.rfind('.');
+        if (dot == string::npos) return "";
+        iter = env.find(buffer.substr(0, dot));
+        if (iter == env.end() || iter->second.outputs() == 1) return "";
+    }
+    const Schedule &sched = iter->second.schedule();
+    return sched.memoized() ? "" : sched.fuse_group();
+}
+
+// Find the constant-sized allocations of fuse group members made
+// directly in a loop body, keyed by group.
+class FindGroupAllocations : public IRVisitor {
+    const map<string, Function> &env;
+
+    using IRVisitor::visit;
+
+    void visit(const For *) {
+        // Allocations inside inner loops are handled at that level.
+    }
+
+    void visit(const Allocate *op) {
+        IRVisitor::visit(op);
+
+        string group = fuse_group_of(op->name, env);
+        if (group.empty() || op->new_expr.defined()) return;
+
+        int64_t elems = 1;
+        for (Expr e : op->extents) {
+            Expr bound = find_constant_bound(simplify(e), Direction::Upper);
+            const int64_t *c = bound.defined() ? as_const_int(bound) : nullptr;
+            if (!c || *c < 0) return;
+            elems *= *c;
+            if (elems > 0x7fffffff) return;
+        }
+        ScratchBuffer b = {op->name, op->type, elems * op->type.bytes(), -1, -1, 0};
+        result[group].push_back(b);
+    }
+
+public:
+    map<string, vector<ScratchBuffer>> result;
+    FindGroupAllocations(const map<string, Function> &e) : env(e) {}
+};
+
+// Compute the lifetime of each buffer, in terms of the sequence of
+// producers in the loop body. Touching a buffer anywhere inside an
+// inner loop makes it live for that entire loop.
+class ComputeLifetimes : public IRVisitor {
+    vector<ScratchBuffer> &buffers;
+    int stage;
+    vector<set<size_t>> loops;
+
+    void touch(size_t i) {
+        ScratchBuffer &b = buffers[i];
+        b.first = b.first < 0 ? stage : std::min(b.first, stage);
+        b.last = std::max(b.last, stage);
+        if (!loops.empty()) {
+            loops.back().insert(i);
+        }
+    }
+
+    void touch(const string &name) {
+        for (size_t i = 0; i < buffers.size(); i++) {
+            if (buffers[i].name == name) {
+                touch(i);
+            }
+        }
+    }
+
+    using IRVisitor::visit;
+
+    void visit(const ProducerConsumer *op) {
+        if (op->is_producer) {
+            stage++;
+        }
+        IRVisitor::visit(op);
+    }
+
+    void visit(const For *op) {
+        int start = stage;
+        loops.push_back(set<size_t>());
+        IRVisitor::visit(op);
+        set<size_t> touched;
+        touched.swap(loops.back());
+        loops.pop_back();
+        for (size_t i : touched) {
+            buffers[i].first = std::min(buffers[i].first, start);
+            buffers[i].last = std::max(buffers[i].last, stage);
+            if (!loops.empty()) {
+                loops.back().insert(i);
+            }
+        }
+    }
+
+    void visit(const Load *op) {
+        touch(op->name);
+        IRVisitor::visit(op);
+    }
+
+    void visit(const Store *op) {
+        touch(op->name);
+        IRVisitor::visit(op);
+    }
+
+public:
+    ComputeLifetimes(vector<ScratchBuffer> &b) : buffers(b), stage(0) {}
+};
+
+// Find the buffers whose address or buffer_t escapes, e.g. to extern
+// stages. These can't be moved into the scratch storage, because
+// only loads and stores are redirected to it.
+class FindEscapingBuffers : public IRGraphVisitor {
+    using IRGraphVisitor::visit;
+
+    void visit(const Variable *op) {
+        if (ends_with(op->name, ".buffer")) {
+            result.insert(op->name.substr(0, op->name.size() - 7));
+        }
+    }
+
+    void visit(const Call *op) {
+        if (op->is_intrinsic(Call::address_of)) {
+            internal_assert(op->args.size() == 1);
+            if (const Load *load = op->args[0].as<Load>()) {
+                result.insert(load->name);
+            }
+        }
+        IRGraphVisitor::visit(op);
+    }
+
+public:
+    set<string> result;
+};
+
+int64_t align_up(int64_t x, int64_t a) {
+    return ((x + a - 1) / a) * a;
+}
+
+// Assign each buffer the lowest offset that doesn't collide with a
+// buffer that's live at the same time. Only buffers of the same type
+// may occupy the same bytes, so that alias analysis by type and
+// constant index in codegen stays valid. Returns the total size.
+int64_t assign_offsets(vector<ScratchBuffer> &buffers) {
+    std::sort(buffers.begin(), buffers.end(),
+              [](const ScratchBuffer &a, const ScratchBuffer &b) {
+                  return a.first < b.first;
+              });
+    int64_t total = 0;
+    for (size_t i = 0; i < buffers.size(); i++) {
+        ScratchBuffer &b = buffers[i];
+        vector<std::pair<int64_t, int64_t>> busy;
+        for (size_t j = 0; j < i; j++) {
+            const ScratchBuffer &o = buffers[j];
+            if ((o.first <= b.last && b.first <= o.last) || o.type != b.type) {
+                busy.push_back({o.offset, o.offset + o.bytes});
+            }
+        }
+        std::sort(busy.begin(), busy.end());
+        int64_t offset = 0;
+        for (auto r : busy) {
+            if (offset + b.bytes <= r.first) break;
+            offset = std::max(offset, align_up(r.second, scratch_alignment));
+        }
+        b.offset = offset;
+        total = std::max(total, offset + b.bytes);
+    }
+    return total;
+}
+
+class RedirectToScratch : public IRMutator {
+    const string &scratch;
+    const map<string, const ScratchBuffer *> &buffers;
+
+    Expr offset_index(Expr index, const ScratchBuffer *b) {
+        internal_assert(b->offset % b->type.bytes() == 0);
+        return index + make_const(index.type().element_of(), b->offset / b->type.bytes());
+    }
+
+    using IRMutator::visit;
+
+    void visit(const Allocate *op) {
+        if (buffers.count(op->name)) {
+            stmt = mutate(op->body);
+        } else {
+            IRMutator::visit(op);
+        }
+    }
+
+    void visit(const Load *op) {
+        auto iter = buffers.find(op->name);
+        if (iter != buffers.end()) {
+            Expr index = offset_index(mutate(op->index), iter->second);
+            expr = Load::make(op->type, scratch, index, op->image, op->param);
+        } else {
+            IRMutator::visit(op);
+        }
+    }
+
+    void visit(const Store *op) {
+        auto iter = buffers.find(op->name);
+        if (iter != buffers.end()) {
+            Expr value = mutate(op->value);
+            Expr index = offset_index(mutate(op->index), iter->second);
+            stmt = Store::make(scratch, value, index, op->param);
+        } else {
+            IRMutator::visit(op);
+        }
+    }
+
+public:
+    RedirectToScratch(const string &s, const map<string, const ScratchBuffer *> &b) :
+        scratch(s), buffers(b) {}
+};
+
+class ShareScratchStorage : public IRMutator {
+    const map<string, Function> &env;
+
+    using IRMutator::visit;
+
+    void visit(const For *op) {
+        IRMutator::visit(op);
+        op = stmt.as<For>();
+        internal_assert(op);
+
+        if (op->device_api != DeviceAPI::None &&
+            op->device_api != DeviceAPI::Host) {
+            return;
+        }
+
+        FindGroupAllocations finder(env);
+        op->body.accept(&finder);
+
+        FindEscapingBuffers escaping;
+        op->body.accept(&escaping);
+
+        Stmt body = op->body;
+        for (auto &group : finder.result) {
+            vector<ScratchBuffer> &bufs = group.second;
+            bufs.erase(std::remove_if(bufs.begin(), bufs.end(),
+                                      [&](const ScratchBuffer &b) {
+                                          return escaping.result.count(b.name) > 0;
+                                      }),
+                       bufs.end());
+            if (bufs.size() < 2) continue;
+
+            ComputeLifetimes lifetimes(bufs);
+            body.accept(&lifetimes);
+
+            int64_t total = assign_offsets(bufs);
+            // Padding for the scalar that loads are permitted to
+            // read past the end of a buffer.
+            int64_t padding = 0;
+            map<string, const ScratchBuffer *> by_name;
+            for (const ScratchBuffer &b : bufs) {
+                padding = std::max(padding, (int64_t)b.type.bytes());
+                by_name[b.name] = &b;
+                debug(3) << "Placing " << b.name << " (" << b.bytes << " bytes, live for stages "
+                         << b.first << " to " << b.last << ") at offset " << b.offset
+                         << " of the scratch storage for " << group.first << "\n";
+            }
+            total += padding;
+            if (total > 0x7fffffff) continue;
+
+            string scratch = unique_name(group.first + ".scratch");
+            body = RedirectToScratch(scratch, by_name).mutate(body);
+            body = Allocate::make(scratch, UInt(8), {make_const(Int(32), total)}, const_true(), body);
+        }
+
+        if (!body.same_as(op->body)) {
+            stmt = For::make(op->name, op->min, op->extent, op->for_type, op->device_api, body);
+        }
+    }
+
+public:
+    ShareScratchStorage(const map<string, Function> &e) : env(e) {}
+};
+
+}  // namespace
+
+Stmt share_scratch_storage(Stmt s, const map<string, Function> &env) {
+    return ShareScratchStorage(env).mutate(s);
+}
+
+}
+}
@@ -0,0 +1,27 @@
+#ifndef HALIDE_SCRATCH_STORAGE_H
+#define HALIDE_SCRATCH_STORAGE_H
+
+/** \file
+ * Defines the lowering pass that packs the intermediates of a fused
+ * group into one scratch allocation.
+ */
+
+#include <map>
+
+#include "IR.h"
+
+namespace Halide {
+namespace Internal {
+
+/** Within each loop body, find the constant-sized allocations of
+ * Funcs that belong to the same fuse group (see \ref
+ * Func::fuse_group), compute when each is live, and replace them
+ * with a single scratch allocation in which buffers with disjoint
+ * lifetimes occupy the same bytes. Must be run after storage
+ * flattening and before early frees are injected. */
+Stmt share_scratch_storage(Stmt s, const std::map<std::string, Function> &env);
+
+}
+}
+
+#endif
@@ -3721,13 +3721,15 @@ private:
     void visit(const Load *op) {
         // Load of a broadcast should be broadcast of the load
         Expr index = mutate(op->index);
-        if (const Broadcast *b = index.as<Broadcast>()) {
+        Expr predicate = mutate(op->predicate);
+        const Broadcast *b = index.as<Broadcast>();
+        if (b && is_one(predicate)) {
             Expr load = Load::make(op->type.element_of(), op->name, b->value, op->image, op->param);
             expr = Broadcast::make(load, b->lanes);
-        } else if (index.same_as(op->index)) {
+        } else if (index.same_as(op->index) && predicate.same_as(op->predicate)) {
             expr = op;
         } else {
-            expr = Load::make(op->type, op->name, index, op->image, op->param);
+            expr = Load::make(op->type, op->name, index, op->image, op->param, predicate);
         }
     }
 
@@ -3912,7 +3914,7 @@ private:
                 vector<Expr> load_indices;
                 for (Expr e : new_args) {
                     const Load *load = e.as<Load>();
-                    if (load && load->name == first_load->name) {
+                    if (load && load->name == first_load->name && is_one(load->predicate)) {
                         load_indices.push_back(load->index);
                     }
                 }
@@ -4351,16 +4353,19 @@ private:
     void visit(const Store *op) {
         Expr value = mutate(op->value);
         Expr index = mutate(op->index);
+        Expr predicate = mutate(op->predicate);
 
         const Load *load = value.as<Load>();
 
-        if (is_undef(value) || (load && load->name == op->name && equal(load->index, index))) {
-            // foo[x] = foo[x] or foo[x] = undef is a no-op
+        if (is_undef(value) || is_zero(predicate) ||
+            (load && load->name == op->name && equal(load->index, index) && is_one(load->predicate))) {
+            // foo[x] = foo[x] or foo[x] = undef is a no-op, as is a
+            // store with no lanes enabled.
             stmt = Evaluate::make(0);
-        } else if (value.same_as(op->value) && index.same_as(op->index)) {
+        } else if (value.same_as(op->value) && index.same_as(op->index) && predicate.same_as(op->predicate)) {
             stmt = op;
         } else {
-            stmt = Store::make(op->name, value, index, op->param);
+            stmt = Store::make(op->name, value, index, op->param, predicate);
         }
     }
 
@@ -8,12 +8,14 @@
 #include "Simplify.h"
 #include "Monotonic.h"
 #include "Bounds.h"
+#include "CodeGen_GPU_Dev.h"
 
 namespace Halide {
 namespace Internal {
 
 using std::string;
 using std::map;
+using std::set;
 
 namespace {
 
@@ -324,13 +326,136 @@ public:
     SlidingWindowOnFunctionAndLoop(Function f, string v, Expr v_min) : func(f), loop_var(v), loop_min(v_min) {}
 };
 
+// Does a statement refer to a function anywhere other than inside
+// the loop with the given name?
+class UsesFuncOutsideLoop : public IRVisitor {
+    const string &func, &loop;
+
+    using IRVisitor::visit;
+
+    void visit(const For *op) {
+        if (op->name != loop) {
+            IRVisitor::visit(op);
+        }
+    }
+
+    void visit(const Call *op) {
+        if (op->name == func) {
+            result = true;
+        }
+        IRVisitor::visit(op);
+    }
+
+    void visit(const Provide *op) {
+        if (op->name == func) {
+            result = true;
+        }
+        IRVisitor::visit(op);
+    }
+
+    void visit(const ProducerConsumer *op) {
+        if (op->name == func) {
+            result = true;
+        }
+        IRVisitor::visit(op);
+    }
+
+    void visit(const Variable *op) {
+        if (starts_with(op->name, func + ".")) {
+            result = true;
+        }
+    }
+
+public:
+    bool result = false;
+    UsesFuncOutsideLoop(const string &f, const string &l) : func(f), loop(l) {}
+};
+
+class HasDeviceLoop : public IRVisitor {
+    using IRVisitor::visit;
+
+    void visit(const For *op) {
+        if ((op->device_api != DeviceAPI::None &&
+             op->device_api != DeviceAPI::Host) ||
+            CodeGen_GPU_Dev::is_gpu_var(op->name)) {
+            result = true;
+        } else {
+            IRVisitor::visit(op);
+        }
+    }
+
+public:
+    bool result = false;
+};
+
 // Perform sliding window optimization for a particular function
 class SlidingWindowOnFunction : public IRMutator {
     Function func;
+    const Realize *realize;
 
+    // Did we slide over any loop visited so far?
+    bool slid = false;
 
     using IRMutator::visit;
 
+    // A parallel loop between the store and compute levels of the
+    // function can't be slid over, because the iterations run out of
+    // order and share storage. Instead split it into strips, run the
+    // strips in parallel, and slide over the loop within each
+    // strip. The first iteration of each strip computes the whole
+    // window. The realization moves inside the strip so that each
+    // strip has its own storage, which storage folding can then
+    // shrink. Returns an undefined Stmt if this doesn't apply.
+    Stmt slide_in_strips(const For *op, Stmt body) {
+        if (op->for_type != ForType::Parallel || realize == nullptr || slid ||
+            (op->device_api != DeviceAPI::None && op->device_api != DeviceAPI::Host) ||
+            CodeGen_GPU_Dev::is_gpu_var(op->name)) {
+            return Stmt();
+        }
+
+        HasDeviceLoop device_loop;
+        body.accept(&device_loop);
+        UsesFuncOutsideLoop outside(func.name(), op->name);
+        realize->body.accept(&outside);
+        if (device_loop.result || outside.result) {
+            return Stmt();
+        }
+
+        Expr strip_size = func.schedule().sliding_strip();
+        if (!strip_size.defined()) {
+            // Enough strips to keep a machine busy, but no longer than
+            // a strip needs to be to amortize the warm up.
+            strip_size = clamp(op->extent / 8, 1, 16);
+        } else if (is_one(strip_size)) {
+            return Stmt();
+        }
+        strip_size = max(strip_size, 1);
+
+        string strip_name = op->name + ".strip";
+        string strip_size_name = strip_name + ".size";
+        string strip_min_name = strip_name + ".min";
+        Expr strip = Variable::make(Int(32), strip_name);
+        Expr strip_size_var = Variable::make(Int(32), strip_size_name);
+        Expr strip_min = Variable::make(Int(32), strip_min_name);
+
+        Stmt new_body = SlidingWindowOnFunctionAndLoop(func, op->name, strip_min).mutate(body);
+        if (new_body.same_as(body)) {
+            return Stmt();
+        }
+
+        debug(3) << "Sliding " << func.name() << " over strips of parallel loop " << op->name << "\n";
+
+        Expr strip_extent = min(strip_size_var, op->min + op->extent - strip_min);
+        Stmt s = For::make(op->name, strip_min, strip_extent, ForType::Serial, op->device_api, new_body);
+        s = Realize::make(realize->name, realize->types, realize->bounds, realize->condition, s);
+        s = LetStmt::make(strip_min_name, op->min + strip * strip_size_var, s);
+        Expr strips = (op->extent + strip_size_var - 1) / strip_size_var;
+        s = For::make(strip_name, 0, strips, ForType::Parallel, op->device_api, s);
+        s = LetStmt::make(strip_size_name, strip_size, s);
+        realize = nullptr;
+        return s;
+    }
+
     void visit(const For *op) {
         debug(3) << " Doing sliding window analysis over loop: " << op->name << "\n";
 
@@ -340,7 +465,15 @@ class SlidingWindowOnFunction : public IRMutator {
 
         if (op->for_type == ForType::Serial ||
             op->for_type == ForType::Unrolled) {
-            new_body = SlidingWindowOnFunctionAndLoop(func, op->name, op->min).mutate(new_body);
+            Stmt slid_body = SlidingWindowOnFunctionAndLoop(func, op->name, op->min).mutate(new_body);
+            slid = slid || !slid_body.same_as(new_body);
+            new_body = slid_body;
+        } else {
+            Stmt strips = slide_in_strips(op, new_body);
+            if (strips.defined()) {
+                stmt = strips;
+                return;
+            }
         }
 
         if (new_body.same_as(op->body)) {
@@ -351,12 +484,18 @@ class SlidingWindowOnFunction : public IRMutator {
     }
 
 public:
-    SlidingWindowOnFunction(Function f) : func(f) {}
+    SlidingWindowOnFunction(Function f, const Realize *r) : func(f), realize(r) {}
+
+    // Did the realization move inside the strips of a parallel loop?
+    bool sunk_realize() const {
+        return realize == nullptr;
+    }
 };
 
 // Perform sliding window optimization for all functions
 class SlidingWindow : public IRMutator {
     const map<string, Function> &env;
+    set<string> sunk;
 
     using IRMutator::visit;
 
@@ -379,11 +518,26 @@ class SlidingWindow : public IRMutator {
             return;
         }
 
+        // If it's a realization we already moved inside the strips
+        // of a parallel loop, we've already slid it.
+        if (sunk.count(op->name)) {
+            IRMutator::visit(op);
+            return;
+        }
+
         Stmt new_body = op->body;
 
         debug(3) << "Doing sliding window analysis on realization of " << op->name << "\n";
 
-        new_body = SlidingWindowOnFunction(iter->second).mutate(new_body);
+        SlidingWindowOnFunction slider(iter->second, op);
+        new_body = slider.mutate(new_body);
+
+        if (slider.sunk_realize()) {
+            sunk.insert(op->name);
+            stmt = mutate(new_body);
+            sunk.erase(op->name);
+            return;
+        }
 
         new_body = mutate(new_body);
 
@@ -1,9 +1,11 @@
 #include "StmtToHtml.h"
 #include "IRVisitor.h"
 #include "IROperator.h"
+#include "LICM.h"
 #include "Scope.h"
 
 #include <iterator>
+#include <map>
 #include <iostream>
 #include <fstream>
 #include <sstream>
@@ -22,6 +24,23 @@ std::string to_string(T value) {
     return os.str() ;
 }
 
+// Count the values hoisted out of each loop by
+// loop_invariant_code_motion.
+class CountHoisted : public IRVisitor {
+    using IRVisitor::visit;
+
+    void visit(const LetStmt *op) {
+        string loop = get_hoisted_loop_name(op->name);
+        if (!loop.empty()) {
+            counts[loop]++;
+        }
+        IRVisitor::visit(op);
+    }
+
+public:
+    std::map<string, int> counts;
+};
+
 class StmtToHtml : public IRVisitor {
 
     static const std::string css, js;
@@ -564,6 +583,23 @@ private:
     }
 
 public:
+    // Summarize the values hoisted out of loops.
+    void print_hoisting_report(Stmt s) {
+        CountHoisted counter;
+        s.accept(&counter);
+        if (counter.counts.empty()) {
+            return;
+        }
+        stream << open_div("HoistingReport");
+        stream << open_line() << span("Comment", "// Loop invariant values hoisted:") << close_line();
+        for (const auto &c : counter.counts) {
+            stream << open_line()
+                   << span("Comment", "//   " + to_string(c.second) + " out of " + c.first)
+                   << close_line();
+        }
+        stream << close_div();
+    }
+
     void print(Expr ir) {
         ir.accept(this);
     }
@@ -592,6 +628,7 @@ public:
         stream << close_expand_button();
         stream << " " << matched("{");
         stream << open_div("FunctionBody Indent", id);
+        print_hoisting_report(op.body);
         print(op.body);
         stream << close_div();
         stream << matched("}");
@@ -669,6 +706,7 @@ function toggle(id) { \n \
 
 void print_to_html(string filename, Stmt s) {
     StmtToHtml sth(filename);
+    sth.print_hoisting_report(s);
     sth.print(s);
 }
 
@@ -18,6 +18,19 @@ int64_t next_power_of_two(int64_t x) {
     return static_cast<int64_t>(1) << static_cast<int64_t>(std::ceil(std::log2(x)));
 }
 
+// Pick the fold factor for a dimension whose live extent is bounded
+// by the given constant. Rounding up to a power of two turns the
+// wrapped index into a bitmask, but for tall stencils it can nearly
+// double the footprint of the buffer. Only round up if it wastes at
+// most a quarter of the extent. Otherwise fold by the extent itself;
+// the wrap is then a modulo by a constant, which codegen lowers to a
+// multiply and shift, and which is usually hoisted out of the
+// innermost loop anyway.
+int64_t choose_fold_factor(int64_t extent) {
+    int64_t p = next_power_of_two(extent);
+    return (p - extent) * 4 <= extent ? p : extent;
+}
+
 }  // namespace
 
 using std::string;
@@ -120,6 +133,11 @@ class AttemptStorageFoldingOfFunction : public IRMutator {
         Box required = box_required(body, func.name());
         Box box = box_union(provided, required);
 
+        // Set if we folded a dimension in which consecutive iterations
+        // of this loop overlap. We can still fold other dimensions
+        // over this loop, but not over any inner loops.
+        bool overlapping_fold = false;
+
         // Try each dimension in turn from outermost in
         for (size_t i = box.size(); i > 0; i--) {
             Expr min = simplify(box[i-1].min);
@@ -200,7 +218,7 @@ class AttemptStorageFoldingOfFunction : public IRMutator {
                     const int max_fold = 1024;
                     const int64_t *const_max_extent = as_const_int(max_extent);
                     if (const_max_extent && *const_max_extent <= max_fold) {
-                        factor = static_cast<int>(next_power_of_two(*const_max_extent));
+                        factor = static_cast<int>(choose_fold_factor(*const_max_extent));
                     } else {
                         debug(3) << "Not folding because extent not bounded by a constant not greater than " << max_fold << "\n"
                                  << "extent = " << extent << "\n"
@@ -217,17 +235,17 @@ class AttemptStorageFoldingOfFunction : public IRMutator {
 
                     Expr next_var = Variable::make(Int(32), op->name) + 1;
                     Expr next_min = substitute(op->name, next_var, min);
-                    if (can_prove(max < next_min)) {
-                        // There's no overlapping usage between loop
-                        // iterations, so we can continue to search
-                        // for further folding opportinities
-                        // recursively.
-                    } else if (!body.same_as(op->body)) {
-                        stmt = For::make(op->name, op->min, op->extent, op->for_type, op->device_api, body);
-                        return;
-                    } else {
-                        stmt = op;
-                        return;
+                    if (!can_prove(max < next_min)) {
+                        // Values are shared between loop iterations,
+                        // so we can't search inner loops for further
+                        // folding opportunities. Other dimensions
+                        // that also move monotonically with this
+                        // loop can still be folded: an element can
+                        // only be clobbered by one congruent to it in
+                        // every folded dimension, and the fold factor
+                        // of any one dimension in which they differ
+                        // already rules that out.
+                        overlapping_fold = true;
                     }
                 }
             } else {
@@ -240,7 +258,7 @@ class AttemptStorageFoldingOfFunction : public IRMutator {
         // If there's no communication of values from one loop
         // iteration to the next (which may happen due to sliding),
         // then we're safe to fold an inner loop.
-        if (box_contains(provided, required)) {
+        if (!overlapping_fold && box_contains(provided, required)) {
             body = mutate(body);
         }
 
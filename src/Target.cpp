@@ -251,6 +251,9 @@ const std::map<std::string, Target::Feature> feature_name_map = {
     {"fuzz_float_stores", Target::FuzzFloatStores},
     {"soft_float_abi", Target::SoftFloatABI},
     {"msan", Target::MSAN},
+    {"profile_params", Target::ProfileParams},
+    {"fast_vector_math", Target::FastVectorMath},
+    {"loop_carry", Target::LoopCarry},
 };
 
 bool lookup_feature(const std::string &tok, Target::Feature &result) {
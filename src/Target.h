@@ -76,6 +76,9 @@ struct Target {
         FuzzFloatStores = halide_target_feature_fuzz_float_stores,
         SoftFloatABI = halide_target_feature_soft_float_abi,
         MSAN = halide_target_feature_msan,
+        ProfileParams = halide_target_feature_profile_params,
+        FastVectorMath = halide_target_feature_fast_vector_math,
+        LoopCarry = halide_target_feature_loop_carry,
         FeatureEnd = halide_target_feature_end
     };
     Target() : os(OSUnknown), arch(ArchUnknown), bits(0) {}
@@ -0,0 +1,51 @@
+#include "VectorMath.h"
+#include "IRMutator.h"
+#include "IROperator.h"
+
+namespace Halide {
+namespace Internal {
+
+namespace {
+
+class ApproximateVectorMath : public IRMutator {
+    using IRMutator::visit;
+
+    void visit(const Call *op) {
+        IRMutator::visit(op);
+        op = expr.as<Call>();
+        if (!op || op->call_type != Call::PureExtern ||
+            !op->type.is_vector() || op->type.element_of() != Float(32)) {
+            return;
+        }
+
+        // Zero asks for the most accurate approximation.
+        if (op->name == "sin_f32") {
+            expr = polynomial_sin(op->args[0], 0);
+        } else if (op->name == "cos_f32") {
+            expr = polynomial_cos(op->args[0], 0);
+        } else if (op->name == "tanh_f32") {
+            expr = polynomial_tanh(op->args[0], 0);
+        } else if (op->name == "atan2_f32") {
+            expr = polynomial_atan2(op->args[0], op->args[1], 0);
+        }
+    }
+
+    void visit(const For *op) {
+        if (op->device_api != DeviceAPI::None &&
+            op->device_api != DeviceAPI::Host) {
+            // GPUs have their own vectorized math libraries.
+            stmt = op;
+        } else {
+            IRMutator::visit(op);
+        }
+    }
+};
+
+}  // namespace
+
+Stmt approximate_vector_math(Stmt s) {
+    return ApproximateVectorMath().mutate(s);
+}
+
+}
+}
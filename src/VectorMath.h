@@ -0,0 +1,28 @@
+#ifndef HALIDE_VECTOR_MATH_H
+#define HALIDE_VECTOR_MATH_H
+
+/** \file
+ * Defines the lowering pass that replaces vectorized calls to libm
+ * transcendentals with polynomial approximations, when the target has
+ * the fast_vector_math feature.
+ */
+
+#include "IR.h"
+
+namespace Halide {
+namespace Internal {
+
+/** Replace calls to sin, cos, tanh and atan2 on vectors of Float(32)
+ * outside of GPU kernels with the most accurate of the polynomial
+ * approximations used by fast_sin, fast_cos, fast_tanh and
+ * fast_atan2. Otherwise each lane would be a separate call into libm.
+ * Scalar calls are left alone. exp, log and pow already get
+ * polynomial approximations in codegen. The results differ slightly
+ * from libm, and sin and cos are only accurate for |x| <= 4096, so
+ * pipelines must opt in. */
+Stmt approximate_vector_math(Stmt s);
+
+}
+}
+
+#endif
@@ -1,4 +1,5 @@
 #include <algorithm>
+#include <limits>
 
 #include "VectorizeLoops.h"
 #include "IRMutator.h"
@@ -12,6 +13,7 @@
 #include "Solve.h"
 #include "Simplify.h"
 #include "CSE.h"
+#include "Associativity.h"
 
 namespace Halide {
 namespace Internal {
@@ -200,11 +202,13 @@ class RewriteAccessToVectorAlloc : public IRMutator {
     }
 
     void visit(const Load *op) {
-        expr = Load::make(op->type, op->name, mutate_index(op->name, op->index), op->image, op->param);
+        expr = Load::make(op->type, op->name, mutate_index(op->name, op->index),
+                          op->image, op->param, mutate(op->predicate));
     }
 
     void visit(const Store *op) {
-        stmt = Store::make(op->name, mutate(op->value), mutate_index(op->name, op->index), op->param);
+        stmt = Store::make(op->name, mutate(op->value), mutate_index(op->name, op->index),
+                           op->param, mutate(op->predicate));
     }
 
 public:
@@ -213,6 +217,240 @@ public:
 };
 
 
+// Restrict the loads and stores in a vectorized Stmt to the lanes
+// where a vector predicate is true, so that it can run
+// unconditionally in place of an if statement with a vector
+// condition. Sets valid to false if the Stmt contains something that
+// can't be predicated, in which case the caller should scalarize
+// instead.
+class PredicateLoadStore : public IRMutator {
+    Expr vector_predicate;
+    int lanes;
+
+    // Whether any lane is active. Used for scalar loads.
+    Expr any_lane;
+
+    using IRMutator::visit;
+
+    Expr merge_predicate(Expr pred, Expr new_pred) {
+        if (is_one(pred)) {
+            return new_pred;
+        } else {
+            return pred && new_pred;
+        }
+    }
+
+    Expr get_any_lane() {
+        if (!any_lane.defined()) {
+            any_lane = extract_lane(vector_predicate, 0);
+            for (int i = 1; i < lanes; i++) {
+                any_lane = any_lane || extract_lane(vector_predicate, i);
+            }
+        }
+        return any_lane;
+    }
+
+    void visit(const Load *op) {
+        Expr predicate = mutate(op->predicate);
+        Expr index = mutate(op->index);
+        if (op->type.lanes() == lanes) {
+            predicate = merge_predicate(predicate, vector_predicate);
+        } else if (op->type.is_scalar()) {
+            // A load that doesn't depend on the vectorized var. It
+            // must happen if any lane would have done it.
+            predicate = merge_predicate(predicate, get_any_lane());
+        } else {
+            valid = false;
+            expr = op;
+            return;
+        }
+        expr = Load::make(op->type, op->name, index, op->image, op->param, predicate);
+    }
+
+    void visit(const Store *op) {
+        // Scalar stores in a vectorized loop would be done once by
+        // each active lane in turn. Predication can't express that.
+        if (op->value.type().lanes() != lanes) {
+            valid = false;
+            stmt = op;
+            return;
+        }
+        Expr predicate = merge_predicate(mutate(op->predicate), vector_predicate);
+        stmt = Store::make(op->name, mutate(op->value), mutate(op->index), op->param, predicate);
+    }
+
+    // Integer division by a value that may be zero would trap in the
+    // inactive lanes, so divide those lanes by one instead.
+    template<typename T>
+    void visit_division(const T *op) {
+        Expr a = mutate(op->a), b = mutate(op->b);
+        if (op->type.is_float() || is_const(b)) {
+            // Nothing to do.
+        } else if (b.type().lanes() == lanes) {
+            b = select(vector_predicate, b, make_one(b.type()));
+        } else if (b.type().is_scalar()) {
+            b = select(get_any_lane(), b, make_one(b.type()));
+        } else {
+            valid = false;
+            expr = op;
+            return;
+        }
+        expr = T::make(a, b);
+    }
+
+    void visit(const Div *op) {
+        visit_division(op);
+    }
+
+    void visit(const Mod *op) {
+        visit_division(op);
+    }
+
+    void visit(const Call *op) {
+        // Calls with side-effects would happen in the inactive lanes too.
+        if (!op->is_pure()) {
+            valid = false;
+            expr = op;
+        } else {
+            IRMutator::visit(op);
+        }
+    }
+
+    void visit(const For *op) {
+        valid = false;
+        stmt = op;
+    }
+
+    void visit(const Allocate *op) {
+        valid = false;
+        stmt = op;
+    }
+
+    void visit(const Free *op) {
+        valid = false;
+        stmt = op;
+    }
+
+    void visit(const AssertStmt *op) {
+        valid = false;
+        stmt = op;
+    }
+
+public:
+    bool valid = true;
+
+    PredicateLoadStore(Expr p) : vector_predicate(p), lanes(p.type().lanes()) {}
+};
+
+// Replace the loads from a buffer with calls to a self-reference, as
+// prove_associativity expects to find in an update definition.
+class LoadsToSelfReferences : public IRMutator {
+    string name;
+
+    using IRMutator::visit;
+
+    void visit(const Load *op) {
+        if (op->name == name) {
+            load = op;
+            expr = Call::make(op->type, op->name, {mutate(op->index)}, Call::Halide);
+        } else {
+            IRMutator::visit(op);
+        }
+    }
+
+public:
+    // One of the loads replaced.
+    const Load *load = nullptr;
+
+    LoadsToSelfReferences(const string &n) : name(n) {}
+};
+
+// Check if an expression loads from a buffer.
+class LoadsFromBuffer : public IRVisitor {
+    const string &name;
+
+    using IRVisitor::visit;
+
+    void visit(const Load *op) {
+        result = result || op->name == name;
+        IRVisitor::visit(op);
+    }
+
+public:
+    bool result = false;
+
+    LoadsFromBuffer(const string &n) : name(n) {}
+};
+
+bool loads_from_buffer(Expr e, const string &name) {
+    LoadsFromBuffer l(name);
+    e.accept(&l);
+    return l.result;
+}
+
+// The vector_reduce intrinsic that implements an associative
+// operator found by prove_associativity, or nullptr if there isn't
+// one.
+const char *vector_reduce_for(const AssociativeOp &assoc) {
+    const string &x = assoc.x.first, &y = assoc.y.first;
+    auto is_x_and_y = [&](Expr a, Expr b) {
+        const Variable *va = a.as<Variable>(), *vb = b.as<Variable>();
+        return (va && vb &&
+                ((va->name == x && vb->name == y) ||
+                 (va->name == y && vb->name == x)));
+    };
+    Expr op = assoc.op;
+    if (const Add *add = op.as<Add>()) {
+        return is_x_and_y(add->a, add->b) ? Call::vector_reduce_add : nullptr;
+    } else if (const Mul *mul = op.as<Mul>()) {
+        return is_x_and_y(mul->a, mul->b) ? Call::vector_reduce_mul : nullptr;
+    } else if (const Min *mn = op.as<Min>()) {
+        return is_x_and_y(mn->a, mn->b) ? Call::vector_reduce_min : nullptr;
+    } else if (const Max *mx = op.as<Max>()) {
+        return is_x_and_y(mx->a, mx->b) ? Call::vector_reduce_max : nullptr;
+    } else if (const And *a = op.as<And>()) {
+        return is_x_and_y(a->a, a->b) ? Call::vector_reduce_and : nullptr;
+    } else if (const Or *o = op.as<Or>()) {
+        return is_x_and_y(o->a, o->b) ? Call::vector_reduce_or : nullptr;
+    }
+    return nullptr;
+}
+
+// Apply the operator of a vector_reduce intrinsic to two values.
+Expr apply_reduce_op(const string &reduce, Expr a, Expr b) {
+    if (reduce == Call::vector_reduce_add) {
+        return a + b;
+    } else if (reduce == Call::vector_reduce_mul) {
+        return a * b;
+    } else if (reduce == Call::vector_reduce_min) {
+        return min(a, b);
+    } else if (reduce == Call::vector_reduce_max) {
+        return max(a, b);
+    } else if (reduce == Call::vector_reduce_and) {
+        return a && b;
+    } else {
+        internal_assert(reduce == Call::vector_reduce_or);
+        return a || b;
+    }
+}
+
+// The identity of the operator of a vector_reduce intrinsic.
+Expr reduce_op_identity(const string &reduce, Type t) {
+    if (reduce == Call::vector_reduce_add) {
+        return make_zero(t);
+    } else if (reduce == Call::vector_reduce_mul) {
+        return make_one(t);
+    } else if (reduce == Call::vector_reduce_min) {
+        return t.is_float() ? make_const(t, std::numeric_limits<double>::infinity()) : t.max();
+    } else if (reduce == Call::vector_reduce_max) {
+        return t.is_float() ? make_const(t, -std::numeric_limits<double>::infinity()) : t.min();
+    } else if (reduce == Call::vector_reduce_and) {
+        return const_true();
+    } else {
+        return const_false();
+    }
+}
+
 // Substitutes a vector for a scalar var in a Stmt. Used on the
 // body of every vectorized loop.
 class VectorSubs : public IRMutator {
@@ -225,6 +463,14 @@ class VectorSubs : public IRMutator {
     // A suffix to attach to widened variables.
     string widening_suffix;
 
+    // Whether divergent ifs may be vectorized with predicated loads
+    // and stores rather than scalarized.
+    bool allow_predication;
+
+    // Whether associative updates of a single location may be
+    // vectorized as horizontal reductions.
+    bool allow_reductions;
+
     // A scope containing lets and letstmts whose values became
     // vectors.
     Scope<Expr> scope;
@@ -316,13 +562,15 @@ class VectorSubs : public IRMutator {
     }
 
     void visit(const Load *op) {
+        Expr predicate = mutate(op->predicate);
         Expr index = mutate(op->index);
 
-        if (index.same_as(op->index)) {
+        if (predicate.same_as(op->predicate) && index.same_as(op->index)) {
             expr = op;
         } else {
-            int w = index.type().lanes();
-            expr = Load::make(op->type.with_lanes(w), op->name, index, op->image, op->param);
+            int w = std::max(predicate.type().lanes(), index.type().lanes());
+            expr = Load::make(op->type.with_lanes(w), op->name, widen(index, w),
+                              op->image, op->param, widen(predicate, w));
         }
     }
 
@@ -487,14 +735,29 @@ class VectorSubs : public IRMutator {
     }
 
     void visit(const Store *op) {
+        Expr predicate = mutate(op->predicate);
         Expr value = mutate(op->value);
         Expr index = mutate(op->index);
 
-        if (value.same_as(op->value) && index.same_as(op->index)) {
+        if (index.type().is_scalar() && value.type().is_vector()) {
+            // Every lane stores to the same place.
+            Stmt s = vectorize_reduction(op, index);
+            if (!s.defined()) {
+                // A vector store would have every lane write the
+                // same location at once, and lose all but one of
+                // the updates. Do them one lane at a time instead.
+                s = scalarize(op);
+            }
+            stmt = s;
+            return;
+        }
+
+        if (predicate.same_as(op->predicate) && value.same_as(op->value) && index.same_as(op->index)) {
             stmt = op;
         } else {
-            int lanes = std::max(value.type().lanes(), index.type().lanes());
-            stmt = Store::make(op->name, widen(value, lanes), widen(index, lanes), op->param);
+            int lanes = std::max(predicate.type().lanes(), std::max(value.type().lanes(), index.type().lanes()));
+            stmt = Store::make(op->name, widen(value, lanes), widen(index, lanes),
+                               op->param, widen(predicate, lanes));
         }
     }
 
@@ -540,14 +803,23 @@ class VectorSubs : public IRMutator {
                     IfThenElse::make(op->condition.as<Call>()->args[0],
                                      op->then_case, op->else_case);
 
-                stmt =
-                    IfThenElse::make(all_true,
-                                     mutate(op->then_case),
-                                     scalarize(without_likelies));
+                // Try to handle the case where not every lane is
+                // true (e.g. a loop tail) with predicated loads and
+                // stores instead.
+                Stmt predicated = predicate(c->args[0], op->then_case, op->else_case);
+                if (!predicated.defined()) {
+                    predicated = scalarize(without_likelies);
+                }
+
+                stmt = IfThenElse::make(all_true, mutate(op->then_case), predicated);
             } else {
-                // It's some arbitrary vector condition. Scalarize
-                // it.
-                stmt = scalarize(op);
+                // It's some arbitrary vector condition. Run both
+                // sides with predicated loads and stores if we can,
+                // and scalarize it otherwise.
+                stmt = predicate(cond, op->then_case, op->else_case);
+                if (!stmt.defined()) {
+                    stmt = scalarize(op);
+                }
             }
         } else {
             // It's an if statement on a scalar, we're ok to vectorize the innards.
@@ -568,7 +840,8 @@ class VectorSubs : public IRMutator {
         ForType for_type = op->for_type;
         if (for_type == ForType::Vectorized) {
             user_warning << "Warning: Encountered vector for loop over " << op->name
-                         << " inside vector for loop over " << var << "."
+                         << " inside vector for loop over " << var
+                         << " that could not be fused with it."
                          << " Ignoring the vectorize directive for the inner for loop.\n";
             for_type = ForType::Serial;
         }
@@ -648,6 +921,72 @@ class VectorSubs : public IRMutator {
         stmt = Allocate::make(op->name, op->type, new_extents, op->condition, body, new_expr, op->free_function);
     }
 
+    // Vectorize both sides of an if statement with the given
+    // (vectorized) condition, with their loads and stores predicated
+    // on it. Returns an undefined Stmt if either side can't be
+    // predicated.
+    Stmt predicate(Expr cond, Stmt then_case, Stmt else_case) {
+        if (!allow_predication) {
+            return Stmt();
+        }
+
+        // The cases may store to memory the condition loads from, so
+        // only evaluate it once.
+        string name = unique_name('t');
+        Expr var = Variable::make(cond.type(), name);
+
+        PredicateLoadStore then_pred(var);
+        Stmt result = then_pred.mutate(mutate(then_case));
+        if (!then_pred.valid) {
+            return Stmt();
+        }
+
+        if (else_case.defined()) {
+            PredicateLoadStore else_pred(!var);
+            Stmt predicated_else = else_pred.mutate(mutate(else_case));
+            if (!else_pred.valid) {
+                return Stmt();
+            }
+            result = Block::make(result, predicated_else);
+        }
+
+        return LetStmt::make(name, cond, result);
+    }
+
+    // Vectorize an associative update of a single location, such as a
+    // sum along a reduction domain, by combining the values from each
+    // lane with a horizontal reduction. Returns an undefined Stmt if
+    // the update isn't one we can do this way.
+    Stmt vectorize_reduction(const Store *op, Expr index) {
+        if (!allow_reductions || !is_one(op->predicate)) {
+            return Stmt();
+        }
+
+        LoadsToSelfReferences self_refs(op->name);
+        Expr value = self_refs.mutate(op->value);
+        if (!self_refs.load) {
+            return Stmt();
+        }
+
+        auto result = prove_associativity(op->name, {op->index}, {value});
+        if (!result.first) {
+            return Stmt();
+        }
+        const AssociativeOp &assoc = result.second[0];
+        const char *reduce = vector_reduce_for(assoc);
+        if (!reduce || !assoc.x.second.defined()) {
+            return Stmt();
+        }
+
+        int lanes = replacement.type().lanes();
+        Expr y = widen(mutate(assoc.y.second), lanes);
+        Expr reduced = Call::make(y.type().element_of(), reduce, {y}, Call::PureIntrinsic);
+        const Load *load = self_refs.load;
+        Expr x = Load::make(load->type, op->name, index, load->image, load->param);
+        Expr new_value = substitute(assoc.x.first, x, substitute(assoc.y.first, reduced, assoc.op));
+        return Store::make(op->name, new_value, index, op->param);
+    }
+
     Stmt scalarize(Stmt s) {
         // Wrap a serial loop around it. Maybe LLVM will have
         // better luck vectorizing it.
@@ -698,16 +1037,81 @@ class VectorSubs : public IRMutator {
     }
 
 public:
-    VectorSubs(string v, Expr r) : var(v), replacement(r) {
+    VectorSubs(string v, Expr r, bool p) :
+        var(v), replacement(r), allow_predication(p), allow_reductions(p) {
         widening_suffix = ".x" + std::to_string(replacement.type().lanes());
     }
 };
 
+// If the body of a vectorized loop is another vectorized loop of
+// constant extent, possibly inside some lets, fuse the two into a
+// single wider vectorized loop. The lanes of the inner loop vary
+// fastest, so e.g. a vectorized loop over the channels of an
+// interleaved image inside a vectorized loop over x becomes a single
+// dense vector. Returns the loop unchanged if it can't be fused.
+Stmt fuse_nested_vector_loops(const For *op) {
+    const IntImm *outer_extent = op->extent.as<IntImm>();
+    if (!outer_extent) {
+        return op;
+    }
+
+    vector<pair<string, Expr>> lets;
+    Stmt body = op->body;
+    while (const LetStmt *l = body.as<LetStmt>()) {
+        lets.push_back({l->name, l->value});
+        body = l->body;
+    }
+
+    const For *inner = body.as<For>();
+    if (!inner || inner->for_type != ForType::Vectorized) {
+        return op;
+    }
+
+    const IntImm *inner_extent = inner->extent.as<IntImm>();
+    if (!inner_extent || expr_uses_var(inner->min, op->name)) {
+        return op;
+    }
+    for (const auto &l : lets) {
+        if (expr_uses_var(inner->min, l.first)) {
+            return op;
+        }
+    }
+
+    int inner_lanes = (int)inner_extent->value;
+    string fused_name = op->name + "." + inner->name + ".fused";
+    Expr fused = Variable::make(Int(32), fused_name);
+
+    body = substitute(inner->name, inner->min + fused % inner_lanes, inner->body);
+    for (size_t i = lets.size(); i > 0; i--) {
+        body = LetStmt::make(lets[i-1].first, lets[i-1].second, body);
+    }
+    body = substitute(op->name, op->min + fused / inner_lanes, body);
+
+    Stmt result = For::make(fused_name, 0, (int)outer_extent->value * inner_lanes,
+                            ForType::Vectorized, op->device_api, body);
+
+    // There may be more loops to fuse.
+    return fuse_nested_vector_loops(result.as<For>());
+}
+
 // Vectorize all loops marked as such in a Stmt
 class VectorizeLoops : public IRMutator {
     using IRMutator::visit;
 
+    // Predicated loads and stores and horizontal reductions are only
+    // supported by the CPU backends.
+    bool allow_predication;
+
     void visit(const For *for_loop) {
+        if (for_loop->device_api != DeviceAPI::None &&
+            for_loop->device_api != DeviceAPI::Host) {
+            bool old_allow_predication = allow_predication;
+            allow_predication = false;
+            IRMutator::visit(for_loop);
+            allow_predication = old_allow_predication;
+            return;
+        }
+
         if (for_loop->for_type == ForType::Vectorized) {
             const IntImm *extent = for_loop->extent.as<IntImm>();
             if (!extent || extent->value <= 1) {
@@ -717,6 +1121,10 @@ class VectorizeLoops : public IRMutator {
                            << "constant extent > 1\n";
             }
 
+            Stmt fused = fuse_nested_vector_loops(for_loop);
+            for_loop = fused.as<For>();
+            extent = for_loop->extent.as<IntImm>();
+
             Expr for_var = Variable::make(Int(32), for_loop->name);
 
             Stmt body = for_loop->body;
@@ -727,18 +1135,137 @@ class VectorizeLoops : public IRMutator {
 
             // Replace the var with a ramp within the body
             Expr replacement = Ramp::make(0, 1, extent->value);
-            stmt = VectorSubs(for_loop->name, replacement).mutate(body);
+            stmt = VectorSubs(for_loop->name, replacement, allow_predication).mutate(body);
         } else {
             IRMutator::visit(for_loop);
         }
     }
 
+public:
+    VectorizeLoops(const Target &t) : allow_predication(t.arch != Target::Hexagon) {}
+};
+
+// Move horizontal reductions out of the serial loops around them,
+// accumulating into a vector inside the loop instead.
+class AccumulateVectorReductions : public IRMutator {
+    using IRMutator::visit;
+
+    // Match a store of the form buf[i] = buf[i] op vector_reduce(v).
+    const Call *match_reduction(const Store *op) {
+        if (!op || !is_one(op->predicate)) {
+            return nullptr;
+        }
+        Expr a, b;
+        if (const Add *add = op->value.as<Add>()) {
+            a = add->a; b = add->b;
+        } else if (const Mul *mul = op->value.as<Mul>()) {
+            a = mul->a; b = mul->b;
+        } else if (const Min *mn = op->value.as<Min>()) {
+            a = mn->a; b = mn->b;
+        } else if (const Max *mx = op->value.as<Max>()) {
+            a = mx->a; b = mx->b;
+        } else {
+            // Vectors of bools can't be stored, so there's no point
+            // looking for And and Or.
+            return nullptr;
+        }
+        if (a.as<Call>()) {
+            std::swap(a, b);
+        }
+        const Load *load = a.as<Load>();
+        const Call *reduce = b.as<Call>();
+        if (load && reduce &&
+            load->name == op->name &&
+            equal(load->index, op->index) &&
+            is_one(load->predicate) &&
+            reduce->call_type == Call::PureIntrinsic &&
+            reduce->name == reduce_op_name(op->value) &&
+            !loads_from_buffer(reduce->args[0], op->name)) {
+            return reduce;
+        }
+        return nullptr;
+    }
+
+    // The vector_reduce intrinsic that goes with the node type of a
+    // binary operator.
+    static string reduce_op_name(Expr e) {
+        if (e.as<Add>()) return Call::vector_reduce_add;
+        if (e.as<Mul>()) return Call::vector_reduce_mul;
+        if (e.as<Min>()) return Call::vector_reduce_min;
+        if (e.as<Max>()) return Call::vector_reduce_max;
+        return "";
+    }
+
+    void visit(const For *op) {
+        IRMutator::visit(op);
+        op = stmt.as<For>();
+        if (!op || op->for_type != ForType::Serial) {
+            return;
+        }
+
+        // Look for the reduction under some lets, possibly as the
+        // main case of an if statement that peels off a loop tail.
+        vector<pair<string, Expr>> lets;
+        Stmt body = op->body;
+        while (const LetStmt *l = body.as<LetStmt>()) {
+            lets.push_back({l->name, l->value});
+            body = l->body;
+        }
+        const IfThenElse *if_tail = body.as<IfThenElse>();
+        const Store *store = (if_tail ? if_tail->then_case : body).as<Store>();
+        const Call *reduce = match_reduction(store);
+        if (!reduce) {
+            return;
+        }
+
+        // The location can't change over the loop.
+        if (expr_uses_var(store->index, op->name)) {
+            return;
+        }
+        for (const auto &l : lets) {
+            if (expr_uses_var(store->index, l.first)) {
+                return;
+            }
+        }
+
+        Expr v = reduce->args[0];
+        Type t = v.type();
+        int lanes = t.lanes();
+        string acc = unique_name(store->name + ".accumulator");
+        Expr ramp = Ramp::make(0, 1, lanes);
+        Expr acc_value = Load::make(t, acc, ramp, BufferPtr(), Parameter());
+
+        Stmt update = Store::make(acc, apply_reduce_op(reduce->name, acc_value, v), ramp, Parameter());
+        if (if_tail) {
+            // The loop tail still updates the location directly.
+            update = IfThenElse::make(if_tail->condition, update, if_tail->else_case);
+        }
+        for (size_t i = lets.size(); i > 0; i--) {
+            update = LetStmt::make(lets[i-1].first, lets[i-1].second, update);
+        }
+
+        Stmt init = Store::make(acc, Broadcast::make(reduce_op_identity(reduce->name, t.element_of()), lanes),
+                                ramp, Parameter());
+        Stmt loop = For::make(op->name, op->min, op->extent, op->for_type, op->device_api, update);
+        Expr result = Call::make(t.element_of(), reduce->name, {acc_value}, Call::PureIntrinsic);
+        Expr old_value = Load::make(store->value.type(), store->name, store->index,
+                                    BufferPtr(), store->param);
+        Stmt final_store = Store::make(store->name, apply_reduce_op(reduce->name, old_value, result),
+                                       store->index, store->param);
+
+        stmt = Block::make({init, loop, final_store});
+        stmt = Allocate::make(acc, t.element_of(), {lanes}, const_true(), stmt);
+    }
 };
 
 } // Anonymous namespace
 
-Stmt vectorize_loops(Stmt s) {
-    return VectorizeLoops().mutate(s);
+Stmt vectorize_loops(Stmt s, const Target &t) {
+    return VectorizeLoops(t).mutate(s);
+}
+
+Stmt accumulate_vector_reductions(Stmt s) {
+    return AccumulateVectorReductions().mutate(s);
 }
 
 }
@@ -6,15 +6,25 @@
  */
 
 #include "IR.h"
+#include "Target.h"
 
 namespace Halide {
 namespace Internal {
 
 /** Take a statement with for loops marked for vectorization, and turn
  * them into single statements that operate on vectors. The loops in
- * question must have constant extent.
+ * question must have constant extent. If statements with a condition
+ * that varies across the vector are vectorized using predicated
+ * loads and stores where the target supports them, and scalarized
+ * otherwise.
  */
-Stmt vectorize_loops(Stmt);
+EXPORT Stmt vectorize_loops(Stmt s, const Target &t);
+
+/** Horizontal reductions produced by vectorize_loops are done once
+ * per vector. Where one is the only thing a serial loop does, and
+ * the location it updates doesn't vary over the loop, accumulate into
+ * a vector inside the loop instead and reduce once after it. */
+Stmt accumulate_vector_reductions(Stmt s);
 
 }
 }
@@ -728,7 +728,10 @@ typedef enum halide_target_feature_t {
     halide_target_feature_fuzz_float_stores = 35, ///< On every floating point store, set the last bit of the mantissa to zero. Pipelines for which the output is very different with this feature enabled may also produce very different output on different processors.
     halide_target_feature_soft_float_abi = 36, ///< Enable soft float ABI. This only enables the soft float ABI calling convention, which does not necessarily use soft floats.
     halide_target_feature_msan = 37, ///< Enable hooks for MSAN support.
-    halide_target_feature_end = 38 ///< A sentinel. Every target is considered to have this feature, and setting this feature does nothing.
+    halide_target_feature_profile_params = 38, ///< Record the most common values of each scalar parameter and buffer shape, for profile-guided specialization.
+    halide_target_feature_fast_vector_math = 39, ///< Replace vectorized calls to sin, cos, tanh and atan2 on floats with polynomial approximations, which are within 3 ULPs for |x| <= 4096 but may differ from libm.
+    halide_target_feature_loop_carry = 40, ///< Keep loads in registers across loop iterations where a later iteration loads them again, as the Hexagon backend always does. Can be an optimization or a pessimization depending on the cache and register file of the CPU.
+    halide_target_feature_end = 41 ///< A sentinel. Every target is considered to have this feature, and setting this feature does nothing.
 } halide_target_feature_t;
 
 /** This function is called internally by Halide in some situations to determine
@@ -1045,6 +1048,20 @@ extern void halide_profiler_reset();
  * reset. Also happens at process exit. */
 extern void halide_profiler_report(void *user_context);
 
+/** Record one run of a pipeline compiled with the -profile_params
+ * target flag, in which a scalar parameter or buffer field had the
+ * given value. Only the most common values of each field are kept. */
+extern int halide_param_profile_record(void *user_context, const char *pipeline_name,
+                                       const char *field_name, int64_t value);
+
+/** Forget all recorded parameter values. */
+extern void halide_param_profile_reset();
+
+/** Report the most common values of each recorded parameter to the
+ * file named by the environment variable HL_PARAM_PROFILE, or via
+ * halide_print if it is not set. Also happens at process exit. */
+extern void halide_param_profile_report(void *user_context);
+
 /// \name "Float16" functions
 /// These functions operate of bits (``uint16_t``) representing a half
 /// precision floating point number (IEEE-754 2008 binary16).
@@ -0,0 +1,156 @@
+#include "HalideRuntime.h"
+#include "printer.h"
+#include "scoped_mutex_lock.h"
+
+// Keeps the most common values of each scalar parameter and buffer
+// field of the pipelines compiled with -profile_params, using the
+// Space-Saving algorithm (Metwally et al.): a fixed number of
+// counters, where an untracked value takes over the counter with the
+// smallest count. Every value that occurs in more than 1 /
+// param_profile_slots of the runs is kept, and its count is
+// overestimated by at most that fraction of the runs.
+
+namespace Halide { namespace Runtime { namespace Internal {
+
+const int param_profile_slots = 16;
+
+struct param_profile_field {
+    param_profile_field *next;
+    const char *pipeline_name;
+    const char *field_name;
+    uint64_t total;
+    int num_values;
+    int64_t values[param_profile_slots];
+    uint64_t counts[param_profile_slots];
+};
+
+WEAK halide_mutex param_profile_lock = {{0}};
+WEAK param_profile_field *param_profile_fields = NULL;
+
+WEAK param_profile_field *find_or_create_field(const char *pipeline_name, const char *field_name) {
+    param_profile_field *prev = NULL;
+    for (param_profile_field *f = param_profile_fields; f; prev = f, f = f->next) {
+        // The same pipeline will deliver the same global constant
+        // strings, so they can be compared by pointer.
+        if (f->pipeline_name == pipeline_name && f->field_name == field_name) {
+            if (prev) {
+                // Bubble the field to the top to speed up future queries.
+                prev->next = f->next;
+                f->next = param_profile_fields;
+                param_profile_fields = f;
+            }
+            return f;
+        }
+    }
+    param_profile_field *f = (param_profile_field *)malloc(sizeof(param_profile_field));
+    if (!f) return NULL;
+    f->next = param_profile_fields;
+    f->pipeline_name = pipeline_name;
+    f->field_name = field_name;
+    f->total = 0;
+    f->num_values = 0;
+    param_profile_fields = f;
+    return f;
+}
+
+#define O_APPEND 1024
+#define O_CREAT 64
+#define O_WRONLY 1
+
+WEAK void param_profile_report_unlocked(void *user_context) {
+    int fd = 0;
+    const char *file_name = getenv("HL_PARAM_PROFILE");
+    if (file_name) {
+        fd = open(file_name, O_APPEND | O_CREAT | O_WRONLY, 0644);
+        if (fd <= 0) {
+            error(user_context) << "Failed to open parameter profile " << file_name << "\n";
+            return;
+        }
+    }
+
+    for (param_profile_field *f = param_profile_fields; f; f = f->next) {
+        Printer<StringStreamPrinter, 4096> sstr(user_context);
+        sstr << f->pipeline_name << " " << f->field_name << " " << f->total;
+        for (int i = 0; i < f->num_values; i++) {
+            sstr << " " << f->values[i] << " " << f->counts[i];
+        }
+        sstr << "\n";
+        if (fd > 0) {
+            write(fd, sstr.str(), sstr.size());
+        } else {
+            halide_print(user_context, sstr.str());
+        }
+    }
+
+    if (fd > 0) {
+        close(fd);
+    }
+}
+
+WEAK void param_profile_reset_unlocked() {
+    while (param_profile_fields) {
+        param_profile_field *f = param_profile_fields;
+        param_profile_fields = f->next;
+        free(f);
+    }
+}
+
+}}} // namespace Halide::Runtime::Internal
+
+extern "C" {
+
+WEAK int halide_param_profile_record(void *user_context, const char *pipeline_name,
+                                     const char *field_name, int64_t value) {
+    ScopedMutexLock lock(&param_profile_lock);
+
+    param_profile_field *f = find_or_create_field(pipeline_name, field_name);
+    if (!f) {
+        // Profiling is best-effort; don't fail the pipeline.
+        return 0;
+    }
+    f->total++;
+
+    int smallest = 0;
+    for (int i = 0; i < f->num_values; i++) {
+        if (f->values[i] == value) {
+            f->counts[i]++;
+            return 0;
+        }
+        if (f->counts[i] < f->counts[smallest]) {
+            smallest = i;
+        }
+    }
+    if (f->num_values < param_profile_slots) {
+        f->values[f->num_values] = value;
+        f->counts[f->num_values] = 1;
+        f->num_values++;
+    } else {
+        f->values[smallest] = value;
+        f->counts[smallest]++;
+    }
+    return 0;
+}
+
+WEAK void halide_param_profile_report(void *user_context) {
+    ScopedMutexLock lock(&param_profile_lock);
+    param_profile_report_unlocked(user_context);
+}
+
+WEAK void halide_param_profile_reset() {
+    ScopedMutexLock lock(&param_profile_lock);
+    param_profile_reset_unlocked();
+}
+
+namespace {
+__attribute__((destructor))
+WEAK void halide_param_profile_shutdown() {
+    if (!param_profile_fields) return;
+
+    // Not all implementations of ScopedMutexLock may be safe to use
+    // at static destruction time (windows), so report without it and
+    // leak the memory.
+    param_profile_report_unlocked(NULL);
+}
+}
+
+} // extern "C"
@@ -0,0 +1,72 @@
+#include "Halide.h"
+#include <stdio.h>
+
+using namespace Halide;
+using namespace Halide::Internal;
+
+// Count the parallel loops that run more than one stage.
+class CountForks : public IRMutator {
+    using IRMutator::visit;
+
+    void visit(const For *op) {
+        if (op->for_type == ForType::Parallel &&
+            starts_with(op->name, "fork_")) {
+            forks++;
+        }
+        IRMutator::visit(op);
+    }
+public:
+    int forks = 0;
+};
+
+int main(int argc, char **argv) {
+    Var x, y;
+
+    // Two independent branches and a third stage that depends on
+    // the first, all consumed by the output.
+    Func luma, chroma, hist, out;
+    luma(x, y) = x + y;
+    chroma(x, y) = x * 2 - y;
+    hist(x, y) = luma(x, y) + 1;
+    out(x, y) = luma(x, y) + chroma(x, y) * hist(x, y);
+
+    luma.compute_root().parallel(y).vectorize(x, 4);
+    chroma.compute_root().parallel(y);
+    hist.compute_root();
+
+    Pipeline p(out);
+    p.set_concurrent_stages(true);
+    CountForks *counter = new CountForks;
+    p.add_custom_lowering_pass(counter);
+
+    Image<int> result = p.realize(64, 64);
+
+    for (int y = 0; y < 64; y++) {
+        for (int x = 0; x < 64; x++) {
+            int l = x + y, c = x * 2 - y, h = l + 1;
+            int correct = l + c * h;
+            if (result(x, y) != correct) {
+                printf("result(%d, %d) = %d instead of %d\n",
+                       x, y, result(x, y), correct);
+                return -1;
+            }
+        }
+    }
+
+    if (counter->forks == 0) {
+        printf("Expected independent stages to be forked\n");
+        return -1;
+    }
+
+    // Turning it off again should recompile without the fork.
+    p.set_concurrent_stages(false);
+    counter->forks = 0;
+    p.realize(64, 64);
+    if (counter->forks != 0) {
+        printf("Stages were forked with concurrent_stages off\n");
+        return -1;
+    }
+
+    printf("Success!\n");
+    return 0;
+}
@@ -0,0 +1,111 @@
+#include "Halide.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <algorithm>
+#include <functional>
+#include <limits>
+
+using namespace Halide;
+
+// Check that the widening and narrowing idioms that get mapped to
+// SIMD instructions compute the same thing as their scalar
+// definitions.
+
+template<typename T>
+T saturate(int64_t x) {
+    int64_t lo = std::numeric_limits<T>::min(), hi = std::numeric_limits<T>::max();
+    return (T)std::max(lo, std::min(hi, x));
+}
+
+int64_t floor_div(int64_t a, int64_t b) {
+    int64_t q = a / b;
+    return (q * b > a) ? q - 1 : q;
+}
+
+template<typename T>
+int check(const char *name, Image<T> out, std::function<T(int64_t, int64_t)> correct,
+          Image<T> a, Image<T> b) {
+    for (int i = 0; i < out.width(); i++) {
+        T c = correct(a(i), b(i));
+        if (out(i) != c) {
+            printf("%s(%lld, %lld) = %lld instead of %lld\n", name,
+                   (long long)a(i), (long long)b(i), (long long)out(i), (long long)c);
+            return -1;
+        }
+    }
+    return 0;
+}
+
+template<typename T, typename W>
+int test_type() {
+    const int size = 1024;
+    Image<T> a(size), b(size);
+    for (int i = 0; i < size; i++) {
+        // Wrap around in unsigned math rather than overflowing.
+        a(i) = (T)((uint32_t)rand() * 37u + (uint32_t)i);
+        b(i) = (T)((uint32_t)rand() * 11u - (uint32_t)i);
+    }
+    // Make sure the extremes are in there.
+    a(0) = std::numeric_limits<T>::min();
+    b(0) = std::numeric_limits<T>::max();
+    a(1) = std::numeric_limits<T>::max();
+    b(1) = std::numeric_limits<T>::max();
+    a(2) = std::numeric_limits<T>::min();
+    b(2) = std::numeric_limits<T>::min();
+
+    Type wide = type_of<W>();
+    Type t = type_of<T>();
+    Var x;
+    Expr wa = cast(wide, a(x)), wb = cast(wide, b(x));
+    int bits = t.bits();
+
+    struct Test {
+        const char *name;
+        Expr e;
+        std::function<T(int64_t, int64_t)> correct;
+    };
+
+    std::vector<Test> tests = {
+        {"halving_add", cast(t, (wa + wb) / 2),
+         [](int64_t a, int64_t b) { return (T)floor_div(a + b, 2); }},
+        {"rounding_halving_add", cast(t, (wa + wb + 1) / 2),
+         [](int64_t a, int64_t b) { return (T)floor_div(a + b + 1, 2); }},
+        {"saturating_add", saturating_cast(t, wa + wb),
+         [](int64_t a, int64_t b) { return saturate<T>(a + b); }},
+        {"saturating_sub", saturating_cast(t, cast(wide.with_code(Type::Int), a(x)) -
+                                              cast(wide.with_code(Type::Int), b(x))),
+         [](int64_t a, int64_t b) { return saturate<T>(a - b); }},
+        {"rounding_shift_right", cast(t, (wa + 4) / 8),
+         [](int64_t a, int64_t b) { return (T)floor_div(a + 4, 8); }},
+        {"mul_shift_right", cast(t, (wa * wb) / (1 << bits)),
+         [=](int64_t a, int64_t b) { return (T)floor_div(a * b, int64_t(1) << bits); }},
+        {"absd_select", select(a(x) < b(x), b(x) - a(x), a(x) - b(x)),
+         [](int64_t a, int64_t b) { return (T)(a < b ? b - a : a - b); }},
+        {"absd_max_min", max(a(x), b(x)) - min(a(x), b(x)),
+         [](int64_t a, int64_t b) { return (T)(std::max(a, b) - std::min(a, b)); }},
+    };
+
+    for (Test &test : tests) {
+        Func f;
+        f(x) = test.e;
+        f.vectorize(x, 16);
+        Image<T> out = f.realize(size);
+        if (check<T>(test.name, out, test.correct, a, b)) {
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    if (test_type<uint8_t, uint16_t>() ||
+        test_type<int8_t, int16_t>() ||
+        test_type<uint16_t, uint32_t>() ||
+        test_type<int16_t, int32_t>()) {
+        return -1;
+    }
+
+    printf("Success!\n");
+    return 0;
+}
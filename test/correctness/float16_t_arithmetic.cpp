@@ -0,0 +1,125 @@
+#include "Halide.h"
+#include <stdio.h>
+#include <cmath>
+
+using namespace Halide;
+
+bool same(float16_t a, float16_t b) {
+    return a.to_bits() == b.to_bits() || (a.is_nan() && b.is_nan());
+}
+
+int test(const Target &target, int vector_width) {
+    const int size = 1 << 16;
+
+    // Every half, in both inputs, in different orders.
+    Image<float16_t> a(size), b(size);
+    for (int i = 0; i < size; i++) {
+        a(i) = float16_t::make_from_bits((uint16_t)i);
+        b(i) = float16_t::make_from_bits((uint16_t)(i * 7919));
+    }
+
+    // Just either side of the midpoint between each half and the next,
+    // where rounding to float first would land on the midpoint.
+    Image<double> c(size);
+    for (int i = 0; i < size; i++) {
+        double lo = (double)a(i);
+        double hi = (double)float16_t::make_from_bits((uint16_t)(i + 1));
+        double nudge = (i & 1) ? 1.0 / (1 << 30) : -1.0 / (1 << 30);
+        c(i) = std::isfinite(lo) && std::isfinite(hi) ? lo + (hi - lo) * (0.5 + nudge) : lo;
+    }
+
+    Var x;
+
+    // Conversions to float are exact.
+    Func widen;
+    widen(x) = cast<float>(a(x));
+
+    // Each operation rounds to half precision.
+    Func arith;
+    arith(x) = a(x) * b(x) + a(size - 1 - x);
+
+    // Conversions from float round to nearest, ties to even.
+    Func narrow;
+    narrow(x) = cast<float16_t>(cast<float>(b(x)) * 1.1f);
+
+    // Conversions from double round once.
+    Func narrow64;
+    narrow64(x) = cast<float16_t>(c(x));
+
+    // Comparisons and selects.
+    Func cmp;
+    cmp(x) = select(a(x) < b(x), a(x), b(x) / a(x));
+
+    if (vector_width > 1) {
+        widen.vectorize(x, vector_width);
+        arith.vectorize(x, vector_width);
+        narrow.vectorize(x, vector_width);
+        narrow64.vectorize(x, vector_width);
+        cmp.vectorize(x, vector_width);
+    }
+
+    Image<float> widen_result = widen.realize(size, target);
+    Image<float16_t> arith_result = arith.realize(size, target);
+    Image<float16_t> narrow_result = narrow.realize(size, target);
+    Image<float16_t> narrow64_result = narrow64.realize(size, target);
+    Image<float16_t> cmp_result = cmp.realize(size, target);
+
+    const RoundingMode rm = RoundingMode::ToNearestTiesToEven;
+    for (int i = 0; i < size; i++) {
+        float w = (float)a(i);
+        if (widen_result(i) != w && !(std::isnan(widen_result(i)) && std::isnan(w))) {
+            printf("widen(0x%x) = %f instead of %f\n", i, widen_result(i), w);
+            return -1;
+        }
+
+        float16_t correct = a(i).multiply(b(i), rm).add(a(size - 1 - i), rm);
+        if (!same(arith_result(i), correct)) {
+            printf("arith(0x%x) = 0x%x instead of 0x%x\n",
+                   i, arith_result(i).to_bits(), correct.to_bits());
+            return -1;
+        }
+
+        correct = float16_t((float)b(i) * 1.1f, rm);
+        if (!same(narrow_result(i), correct)) {
+            printf("narrow(0x%x) = 0x%x instead of 0x%x\n",
+                   i, narrow_result(i).to_bits(), correct.to_bits());
+            return -1;
+        }
+
+        correct = float16_t(c(i), rm);
+        if (!same(narrow64_result(i), correct)) {
+            printf("narrow64(%.17g) = 0x%x instead of 0x%x\n",
+                   c(i), narrow64_result(i).to_bits(), correct.to_bits());
+            return -1;
+        }
+
+        correct = a(i) < b(i) ? a(i) : b(i).divide(a(i), rm);
+        if (!same(cmp_result(i), correct)) {
+            printf("cmp(0x%x) = 0x%x instead of 0x%x\n",
+                   i, cmp_result(i).to_bits(), correct.to_bits());
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    Target target = get_jit_target_from_environment();
+
+    // With F16C on x86 the conversions are done in hardware. Without
+    // it they're done in software.
+    Target targets[] = {target, target.without_feature(Target::F16C)};
+    for (const Target &t : targets) {
+        for (int vector_width : {1, 8, 16}) {
+            if (test(t, vector_width) != 0) {
+                printf("Failed for target %s with vector width %d\n",
+                       t.to_string().c_str(), vector_width);
+                return -1;
+            }
+        }
+    }
+
+    printf("Success!\n");
+    return 0;
+}
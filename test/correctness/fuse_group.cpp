@@ -0,0 +1,163 @@
+#include "Halide.h"
+#include <stdio.h>
+
+using namespace Halide;
+using namespace Halide::Internal;
+
+#ifdef _WIN32
+#define DLLEXPORT __declspec(dllexport)
+#else
+#define DLLEXPORT
+#endif
+
+// An extern stage that copies a 2D float buffer.
+extern "C" DLLEXPORT int copy_2d(buffer_t *in, buffer_t *out) {
+    if (in->host == nullptr) {
+        for (int i = 0; i < 2; i++) {
+            in->min[i] = out->min[i];
+            in->extent[i] = out->extent[i];
+        }
+        return 0;
+    }
+    for (int y = out->min[1]; y < out->min[1] + out->extent[1]; y++) {
+        for (int x = out->min[0]; x < out->min[0] + out->extent[0]; x++) {
+            const float *src = (const float *)in->host +
+                (x - in->min[0]) * in->stride[0] + (y - in->min[1]) * in->stride[1];
+            float *dst = (float *)out->host +
+                (x - out->min[0]) * out->stride[0] + (y - out->min[1]) * out->stride[1];
+            *dst = *src;
+        }
+    }
+    return 0;
+}
+
+// Count the allocations made inside the tile loops of the output.
+class CountAllocations : public IRMutator {
+    using IRMutator::visit;
+
+    int loop_depth = 0;
+
+    void visit(const For *op) {
+        loop_depth++;
+        IRMutator::visit(op);
+        loop_depth--;
+    }
+
+    void visit(const Allocate *op) {
+        if (loop_depth > 0) {
+            if (op->name.find(".scratch") != std::string::npos) {
+                scratch++;
+            } else {
+                other++;
+            }
+        }
+        IRMutator::visit(op);
+    }
+public:
+    int scratch = 0, other = 0;
+};
+
+int main(int argc, char **argv) {
+    const int W = 160, H = 96;
+
+    Image<float> input(W + 8, H + 8);
+    for (int y = 0; y < input.height(); y++) {
+        for (int x = 0; x < input.width(); x++) {
+            input(x, y) = (float)((x * 17 + y * 31) % 256);
+        }
+    }
+
+    Var x, y, xo, yo, xi, yi;
+
+    // A chain of separable blurs, plus a stage of a different type.
+    Func in, b0, b1, b2, b3, q, out;
+    in(x, y) = input(x + 4, y + 4);
+    b0(x, y) = (in(x - 1, y) + in(x, y) + in(x + 1, y)) / 3;
+    b1(x, y) = (b0(x, y - 1) + b0(x, y) + b0(x, y + 1)) / 3;
+    b2(x, y) = (b1(x - 1, y) + b1(x, y) + b1(x + 1, y)) / 3;
+    q(x, y) = cast<int>(b2(x, y));
+    b3(x, y) = (b2(x, y - 1) + b2(x, y) + b2(x, y + 1)) / 3 + q(x, y);
+    out(x, y) = b3(x, y);
+
+    out.fuse_group({b0, b1, b2, q, b3}, x, y, xo, yo, xi, yi, 32, 16);
+    out.vectorize(xi, 8);
+
+    CountAllocations *counter = new CountAllocations;
+    out.add_custom_lowering_pass(counter);
+
+    Image<float> result = out.realize(W, H);
+
+    // Compute the reference with every stage computed at root.
+    Func rb0, rb1, rb2, rq, rb3;
+    rb0(x, y) = (in(x - 1, y) + in(x, y) + in(x + 1, y)) / 3;
+    rb1(x, y) = (rb0(x, y - 1) + rb0(x, y) + rb0(x, y + 1)) / 3;
+    rb2(x, y) = (rb1(x - 1, y) + rb1(x, y) + rb1(x + 1, y)) / 3;
+    rq(x, y) = cast<int>(rb2(x, y));
+    rb3(x, y) = (rb2(x, y - 1) + rb2(x, y) + rb2(x, y + 1)) / 3 + rq(x, y);
+    rb0.compute_root();
+    rb1.compute_root();
+    rb2.compute_root();
+    rq.compute_root();
+    Image<float> reference = rb3.realize(W, H);
+
+    for (int y = 0; y < H; y++) {
+        for (int x = 0; x < W; x++) {
+            if (result(x, y) != reference(x, y)) {
+                printf("result(%d, %d) = %f instead of %f\n",
+                       x, y, result(x, y), reference(x, y));
+                return -1;
+            }
+        }
+    }
+
+    if (counter->scratch != 1 || counter->other != 0) {
+        printf("Expected the fused stages to share one scratch allocation per tile. "
+               "Found %d scratch allocations and %d others.\n",
+               counter->scratch, counter->other);
+        return -1;
+    }
+
+    {
+        // Buffers passed to or produced by extern stages can't be
+        // redirected into the scratch storage, but the rest of the
+        // group still shares it.
+        Func c0, ext, c1, c2, c3, out2;
+        c0(x, y) = (in(x - 1, y) + in(x, y) + in(x + 1, y)) / 3;
+        ext.define_extern("copy_2d", {c0}, Float(32), 2);
+        c1(x, y) = (ext(x, y - 1) + ext(x, y) + ext(x, y + 1)) / 3;
+        c2(x, y) = (c1(x - 1, y) + c1(x, y) + c1(x + 1, y)) / 3;
+        c3(x, y) = (c2(x, y - 1) + c2(x, y) + c2(x, y + 1)) / 3;
+        out2(x, y) = c3(x, y);
+
+        out2.fuse_group({c0, ext, c1, c2, c3}, x, y, xo, yo, xi, yi, 32, 16);
+
+        CountAllocations *counter = new CountAllocations;
+        out2.add_custom_lowering_pass(counter);
+
+        Image<float> result = out2.realize(W, H);
+
+        Func rc3;
+        rc3(x, y) = (rb2(x, y - 1) + rb2(x, y) + rb2(x, y + 1)) / 3;
+        Image<float> reference = rc3.realize(W, H);
+
+        for (int y = 0; y < H; y++) {
+            for (int x = 0; x < W; x++) {
+                if (result(x, y) != reference(x, y)) {
+                    printf("With an extern stage, result(%d, %d) = %f instead of %f\n",
+                           x, y, result(x, y), reference(x, y));
+                    return -1;
+                }
+            }
+        }
+
+        if (counter->scratch != 1 || counter->other != 2) {
+            printf("Expected the stages with extern buffers to have their own allocations. "
+                   "Found %d scratch allocations and %d others.\n",
+                   counter->scratch, counter->other);
+            return -1;
+        }
+    }
+
+    printf("Success!\n");
+    return 0;
+}
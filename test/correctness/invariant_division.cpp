@@ -0,0 +1,84 @@
+#include "Halide.h"
+#include <stdio.h>
+#include <limits>
+
+using namespace Halide;
+using namespace Halide::Internal;
+
+// Vector division and mod by a value known only at runtime should
+// match Halide's Euclidean semantics.
+template<typename T>
+int test_type() {
+    const T lo = std::numeric_limits<T>::min(), hi = std::numeric_limits<T>::max();
+    const int size = 256;
+    Image<T> input(size);
+    for (int i = 0; i < size; i++) {
+        input(i) = (T)((uint32_t)rand() * 131 + i);
+    }
+    input(0) = lo;
+    input(1) = hi;
+    input(2) = 0;
+    input(3) = 1;
+    input(4) = (T)-1;
+
+    std::vector<T> divisors = {1, 2, 3, 7, 16, 100, hi, (T)(hi - 1), (T)(hi / 2 + 1)};
+    if (type_of<T>().is_int()) {
+        for (T d : {(T)-1, (T)-2, (T)-3, (T)-7, (T)-16, lo, (T)(lo + 1)}) {
+            divisors.push_back(d);
+        }
+    }
+    for (int i = 0; i < 8; i++) {
+        T d = (T)rand();
+        if (d != 0) {
+            divisors.push_back(d);
+        }
+    }
+
+    Param<T> d;
+    Var x;
+    Func div, mod;
+    div(x) = input(x) / d;
+    mod(x) = input(x) % d;
+    div.vectorize(x, 16);
+    mod.vectorize(x, 16);
+
+    for (T divisor : divisors) {
+        d.set(divisor);
+        Image<T> div_result = div.realize(size);
+        Image<T> mod_result = mod.realize(size);
+        for (int i = 0; i < size; i++) {
+            // Compute the reference in 64 bits, where the quotients
+            // can't overflow.
+            int64_t a = input(i), b = divisor;
+            T correct_div = (T)div_imp<int64_t>(a, b);
+            T correct_mod = (T)mod_imp<int64_t>(a, b);
+            if (div_result(i) != correct_div) {
+                printf("%lld / %lld = %lld instead of %lld\n",
+                       (long long)a, (long long)b,
+                       (long long)div_result(i), (long long)correct_div);
+                return -1;
+            }
+            if (mod_result(i) != correct_mod) {
+                printf("%lld %% %lld = %lld instead of %lld\n",
+                       (long long)a, (long long)b,
+                       (long long)mod_result(i), (long long)correct_mod);
+                return -1;
+            }
+        }
+    }
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    if (test_type<uint8_t>() ||
+        test_type<int8_t>() ||
+        test_type<uint16_t>() ||
+        test_type<int16_t>() ||
+        test_type<uint32_t>() ||
+        test_type<int32_t>()) {
+        return -1;
+    }
+
+    printf("Success!\n");
+    return 0;
+}
@@ -0,0 +1,111 @@
+#include "Halide.h"
+#include <stdio.h>
+
+using namespace Halide;
+using namespace Halide::Internal;
+
+// Make a pipeline that's the same every time for a given k, except
+// for the names of its temporaries.
+Pipeline make_pipeline(int k) {
+    Func f("f"), g("g");
+    Var x("x"), y("y");
+    g(x, y) = x * k + y;
+    f(x, y) = g(x, y) + g(x + 1, y);
+    g.compute_root().vectorize(x, 4);
+    return Pipeline(f);
+}
+
+// The same, with Funcs and Vars that get generated names, which
+// appear in strings in the lowered code such as error messages.
+Pipeline make_unnamed_pipeline(int k) {
+    Func f, g;
+    Var x, y;
+    g(x, y) = x * k + y;
+    f(x, y) = g(x, y) + g(x + 1, y);
+    g.compute_root().vectorize(x, 4);
+    return Pipeline(f);
+}
+
+int check(Pipeline p, int k) {
+    Image<int> result = p.realize(16, 16);
+    for (int y = 0; y < 16; y++) {
+        for (int x = 0; x < 16; x++) {
+            int correct = (x * k + y) + ((x + 1) * k + y);
+            if (result(x, y) != correct) {
+                printf("result(%d, %d) = %d instead of %d\n", x, y, result(x, y), correct);
+                return -1;
+            }
+        }
+    }
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    JITCache::clear();
+
+    Pipeline p1 = make_pipeline(3);
+    Pipeline p2 = make_pipeline(3);
+    Pipeline p3 = make_pipeline(5);
+
+    void *f1 = p1.compile_jit();
+    void *f2 = p2.compile_jit();
+    void *f3 = p3.compile_jit();
+
+    if (f1 != f2) {
+        printf("Identical pipelines didn't share code\n");
+        return -1;
+    }
+
+    if (f1 == f3) {
+        printf("Different pipelines shared code\n");
+        return -1;
+    }
+
+    if (JITCache::size() != 2) {
+        printf("Expected two modules in the cache instead of %d\n", (int)JITCache::size());
+        return -1;
+    }
+
+    if (JITCache::memory_used() == 0) {
+        printf("The cache reported no memory used\n");
+        return -1;
+    }
+
+    if (check(p1, 3) || check(p2, 3) || check(p3, 5)) {
+        return -1;
+    }
+
+    Pipeline p4 = make_unnamed_pipeline(3);
+    Pipeline p5 = make_unnamed_pipeline(3);
+    if (p4.compile_jit() != p5.compile_jit()) {
+        printf("Identical pipelines with generated names didn't share code\n");
+        return -1;
+    }
+
+    if (check(p4, 3) || check(p5, 3)) {
+        return -1;
+    }
+
+    // Pipelines keep evicted code alive.
+    JITCache::clear();
+    if (JITCache::size() != 0 || JITCache::memory_used() != 0) {
+        printf("Clearing the cache didn't empty it\n");
+        return -1;
+    }
+
+    if (check(p1, 3) || check(p3, 5)) {
+        return -1;
+    }
+
+    // With a tiny budget, only the most recent module is kept.
+    JITCache::set_max_memory(1);
+    make_pipeline(7).compile_jit();
+    make_pipeline(9).compile_jit();
+    if (JITCache::size() != 1) {
+        printf("Expected one module in the cache instead of %d\n", (int)JITCache::size());
+        return -1;
+    }
+
+    printf("Success!\n");
+    return 0;
+}
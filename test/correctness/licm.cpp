@@ -0,0 +1,144 @@
+#include "Halide.h"
+#include <stdio.h>
+#include <iostream>
+
+using namespace Halide;
+using namespace Halide::Internal;
+
+// Count the divisions and loads of a buffer inside loops over x.
+class CountInnerLoopWork : public IRMutator {
+    using IRMutator::visit;
+
+    int in_x_loop = 0;
+
+    void visit(const For *op) {
+        bool is_x = op->name.find(".x") != std::string::npos;
+        in_x_loop += is_x;
+        IRMutator::visit(op);
+        in_x_loop -= is_x;
+    }
+
+    void visit(const Div *op) {
+        if (in_x_loop) {
+            divs++;
+        }
+        IRMutator::visit(op);
+    }
+
+    void visit(const Load *op) {
+        if (in_x_loop && op->name == buffer) {
+            loads++;
+        }
+        IRMutator::visit(op);
+    }
+
+    std::string buffer;
+public:
+    int divs = 0, loads = 0;
+    CountInnerLoopWork(const std::string &b) : buffer(b) {}
+};
+
+// Find the body of the loop with the given name.
+class FindLoopBody : public IRVisitor {
+    using IRVisitor::visit;
+
+    void visit(const For *op) {
+        if (op->name == name) {
+            body = op->body;
+        }
+        IRVisitor::visit(op);
+    }
+
+    std::string name;
+public:
+    Stmt body;
+    FindLoopBody(const std::string &n) : name(n) {}
+};
+
+int main(int argc, char **argv) {
+    // Nothing is hoisted from a GPU loop into the host loop around
+    // it, where the loads would read host memory.
+    {
+        Expr x = Variable::make(Int(32), "x"), y = Variable::make(Int(32), "y");
+        Expr p = Variable::make(Int(32), "p"), q = Variable::make(Int(32), "q");
+        Expr value = Load::make(Int(32), "lut", 3, BufferPtr(), Parameter()) + p / q;
+        Stmt kernel_body = Store::make("out", value, x + y * 16, Parameter());
+        Stmt kernel = For::make("x", 0, 16, ForType::Parallel, DeviceAPI::CUDA, kernel_body);
+        Stmt s = For::make("y", 0, 10, ForType::Serial, DeviceAPI::None, kernel);
+
+        FindLoopBody finder("x");
+        loop_invariant_code_motion(s).accept(&finder);
+        if (!finder.body.same_as(kernel_body)) {
+            std::cout << "Hoisted values out of a GPU loop:\n" << finder.body << "\n";
+            return -1;
+        }
+    }
+
+    const int W = 67, H = 9;
+    Image<int> input(W, H), lut(H);
+    for (int y = 0; y < H; y++) {
+        lut(y) = y * y - 7;
+        for (int x = 0; x < W; x++) {
+            input(x, y) = x * 5 - y * 3;
+        }
+    }
+
+    ImageParam lut_param(Int(32), 1, "lut");
+    lut_param.set(lut);
+
+    Param<int> p, q;
+    p.set(1000);
+    q.set(7);
+
+    Var x, y;
+    Func f;
+    // Both the division and the load from the lut are invariant in
+    // the loop over x.
+    f(x, y) = input(x, y) + p / (q + y) + lut_param(y);
+    f.vectorize(x, 8);
+
+    CountInnerLoopWork *counter = new CountInnerLoopWork("lut");
+    f.add_custom_lowering_pass(counter);
+
+    Image<int> out = f.realize(W, H);
+    for (int yy = 0; yy < H; yy++) {
+        for (int xx = 0; xx < W; xx++) {
+            int correct = input(xx, yy) + 1000 / (7 + yy) + lut(yy);
+            if (out(xx, yy) != correct) {
+                printf("out(%d, %d) = %d instead of %d\n",
+                       xx, yy, out(xx, yy), correct);
+                return -1;
+            }
+        }
+    }
+
+    if (counter->divs != 0 || counter->loads != 0) {
+        printf("Found %d divisions and %d loads from the lut in the loops over x\n",
+               counter->divs, counter->loads);
+        return -1;
+    }
+
+    // The same on a real GPU, with the kernel launched from a serial
+    // loop over y.
+    Target t = get_jit_target_from_environment();
+    if (t.has_gpu_feature()) {
+        Func g;
+        g(x, y) = input(x, y) + p / q + lut_param(0);
+        g.gpu_tile(x, 16);
+
+        Image<int> out = g.realize(W, H, t);
+        for (int yy = 0; yy < H; yy++) {
+            for (int xx = 0; xx < W; xx++) {
+                int correct = input(xx, yy) + 1000 / 7 + lut(0);
+                if (out(xx, yy) != correct) {
+                    printf("GPU out(%d, %d) = %d instead of %d\n",
+                           xx, yy, out(xx, yy), correct);
+                    return -1;
+                }
+            }
+        }
+    }
+
+    printf("Success!\n");
+    return 0;
+}
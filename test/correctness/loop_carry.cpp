@@ -0,0 +1,129 @@
+#include "Halide.h"
+#include <stdio.h>
+#include <set>
+
+using namespace Halide;
+using namespace Halide::Internal;
+
+// Count the vector loads done inside loops from the input, and from
+// the scratch buffers that carry values from one iteration to the
+// next.
+class CountLoopLoads : public IRMutator {
+    using IRMutator::visit;
+
+    int loop_depth = 0;
+    std::set<std::string> scratch;
+
+    void visit(const Allocate *op) {
+        scratch.insert(op->name);
+        IRMutator::visit(op);
+    }
+
+    void visit(const For *op) {
+        loop_depth++;
+        IRMutator::visit(op);
+        loop_depth--;
+    }
+
+    void visit(const Load *op) {
+        if (loop_depth > 0 && op->type.is_vector()) {
+            if (op->name == "input") {
+                count++;
+            } else if (scratch.count(op->name)) {
+                carried++;
+            }
+        }
+        IRMutator::visit(op);
+    }
+public:
+    int count = 0, carried = 0;
+};
+
+int test(const std::vector<int> &taps, int vector_width, int expected_loads, bool expect_carried) {
+    const int W = 1024;
+    int max_tap = 0;
+    for (int t : taps) {
+        max_tap = std::max(max_tap, t);
+    }
+
+    ImageParam input(UInt(16), 1, "input");
+    Image<uint16_t> in(W + max_tap);
+    for (int i = 0; i < in.width(); i++) {
+        in(i) = (uint16_t)(i * 37 + (i >> 3));
+    }
+    input.set(in);
+
+    Var x;
+    Func f;
+    Expr e = cast<uint16_t>(0);
+    for (int t : taps) {
+        e = e + input(x + t);
+    }
+    f(x) = e;
+    f.bound(x, 0, W).vectorize(x, vector_width);
+
+    CountLoopLoads *counter = new CountLoopLoads;
+    f.add_custom_lowering_pass(counter);
+
+    Target t = get_jit_target_from_environment().with_feature(Target::LoopCarry);
+    Image<uint16_t> result = f.realize(W, t);
+
+    for (int i = 0; i < W; i++) {
+        uint16_t correct = 0;
+        for (int t : taps) {
+            correct += in(i + t);
+        }
+        if (result(i) != correct) {
+            printf("result(%d) = %d instead of %d\n", i, result(i), correct);
+            return -1;
+        }
+    }
+
+    if (counter->count != expected_loads) {
+        printf("Found %d vector loads of the input per iteration instead of %d\n",
+               counter->count, expected_loads);
+        return -1;
+    }
+
+    if ((counter->carried > 0) != expect_carried) {
+        printf("Expected %s values to be carried, but found %d loads of carried values\n",
+               expect_carried ? "some" : "no", counter->carried);
+        return -1;
+    }
+
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    Target t = get_jit_target_from_environment();
+    if (t.arch == Target::Hexagon) {
+        printf("The Hexagon backend carries values itself.\n");
+        printf("Success!\n");
+        return 0;
+    }
+
+    // A stencil is rebuilt out of a run of whole vectors from its
+    // lowest offset, and one vector at its highest offset. All but
+    // the last two vectors are carried over from the previous
+    // iteration.
+
+    // 7 taps over 4 lanes: vectors at 0, 4 and 6, with the one at 0
+    // carried.
+    if (test({0, 1, 2, 3, 4, 5, 6}, 4, 2, true) != 0) return -1;
+
+    // 9 taps over 4 lanes: vectors at 0, 4 and 8, where the one at 8
+    // is the next vector along from the one at 4, so only it is
+    // loaded.
+    if (test({0, 1, 2, 3, 4, 5, 6, 7, 8}, 4, 1, true) != 0) return -1;
+
+    // 7 taps over 8 lanes: vectors at 0 and 6, which are both new
+    // each iteration.
+    if (test({0, 1, 2, 3, 4, 5, 6}, 8, 2, false) != 0) return -1;
+
+    // Windows far apart aren't worth rebuilding out of a long run of
+    // vectors.
+    if (test({0, 40}, 4, 2, false) != 0) return -1;
+
+    printf("Success!\n");
+    return 0;
+}
@@ -0,0 +1,95 @@
+#include "Halide.h"
+#include <stdio.h>
+
+using namespace Halide;
+
+// Data-dependent lookups of each size class: tables small enough to
+// shuffle within registers, and larger ones that need gathers.
+int main(int argc, char **argv) {
+    const int W = 67, H = 5;
+    Image<uint8_t> input(W, H);
+    for (int y = 0; y < H; y++) {
+        for (int x = 0; x < W; x++) {
+            input(x, y) = (uint8_t)(x * 37 + y * 101);
+        }
+    }
+
+    Image<uint8_t> lut16(16), lut32(32);
+    Image<int> lut_int(256);
+    Image<float> lut_float(256);
+    for (int i = 0; i < 256; i++) {
+        if (i < 16) lut16(i) = (uint8_t)(i * 13 + 7);
+        if (i < 32) lut32(i) = (uint8_t)(255 - i * 5);
+        lut_int(i) = i * i - 1000;
+        lut_float(i) = i * 0.25f - 3.0f;
+    }
+
+    Var x, y;
+
+    {
+        // A 16 entry table of bytes.
+        Func f;
+        f(x, y) = lut16(cast<int>(input(x, y) % 16));
+        f.vectorize(x, 16);
+        Image<uint8_t> out = f.realize(W, H);
+        for (int yy = 0; yy < H; yy++) {
+            for (int xx = 0; xx < W; xx++) {
+                uint8_t correct = lut16((int)input(xx, yy) % 16);
+                if (out(xx, yy) != correct) {
+                    printf("lut16: out(%d, %d) = %d instead of %d\n",
+                           xx, yy, out(xx, yy), correct);
+                    return -1;
+                }
+            }
+        }
+    }
+
+    {
+        // A 32 entry table of bytes, with a wider vector than a
+        // single shuffle.
+        Func f;
+        f(x, y) = lut32(cast<int>(input(x, y) / 8));
+        f.vectorize(x, 32);
+        Image<uint8_t> out = f.realize(W, H);
+        for (int yy = 0; yy < H; yy++) {
+            for (int xx = 0; xx < W; xx++) {
+                uint8_t correct = lut32((int)input(xx, yy) / 8);
+                if (out(xx, yy) != correct) {
+                    printf("lut32: out(%d, %d) = %d instead of %d\n",
+                           xx, yy, out(xx, yy), correct);
+                    return -1;
+                }
+            }
+        }
+    }
+
+    {
+        // Tables of 32-bit values too large to hold in registers.
+        Func f, g;
+        f(x, y) = lut_int(cast<int>(input(x, y)));
+        g(x, y) = lut_float(cast<int>(input(x, y)));
+        f.vectorize(x, 8);
+        g.vectorize(x, 16);
+        Image<int> out_int = f.realize(W, H);
+        Image<float> out_float = g.realize(W, H);
+        for (int yy = 0; yy < H; yy++) {
+            for (int xx = 0; xx < W; xx++) {
+                int correct_int = lut_int((int)input(xx, yy));
+                float correct_float = lut_float((int)input(xx, yy));
+                if (out_int(xx, yy) != correct_int) {
+                    printf("lut_int: out(%d, %d) = %d instead of %d\n",
+                           xx, yy, out_int(xx, yy), correct_int);
+                    return -1;
+                }
+                if (out_float(xx, yy) != correct_float) {
+                    printf("lut_float: out(%d, %d) = %f instead of %f\n",
+                           xx, yy, out_float(xx, yy), correct_float);
+                    return -1;
+                }
+            }
+        }
+    }
+
+    printf("Success!\n");
+    return 0;
+}
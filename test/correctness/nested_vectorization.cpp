@@ -0,0 +1,107 @@
+#include "Halide.h"
+#include <stdio.h>
+
+using namespace Halide;
+using namespace Halide::Internal;
+
+// Look at the stores to a buffer. Stores from fused vector loops
+// should be as wide as the two loops together, and dense.
+class CheckStores : public IRMutator {
+    using IRMutator::visit;
+
+    void visit(const Store *op) {
+        if (op->name == name) {
+            if (op->value.type().lanes() == 16 && op->index.as<Ramp>()) {
+                dense_stores++;
+            } else if (op->value.type().is_vector() && !op->index.as<Ramp>()) {
+                scatters++;
+            }
+        }
+        IRMutator::visit(op);
+    }
+
+public:
+    std::string name;
+    int dense_stores = 0, scatters = 0;
+    CheckStores(const std::string &n) : name(n) {}
+};
+
+int main(int argc, char **argv) {
+    Target t = get_jit_target_from_environment();
+    if (t.has_gpu_feature()) {
+        printf("Not running test on GPU targets\n");
+        printf("Success!\n");
+        return 0;
+    }
+
+    {
+        // Four channels stored interleaved, vectorized across both
+        // x and the channels.
+        Func f("f"), g("g");
+        Var x("x"), y("y"), c("c");
+        Var xo("xo"), xi("xi"), co("co"), ci("ci");
+
+        f(x, y, c) = cast<uint8_t>(x * 3 + y * 5 + c * 7);
+        g(x, y, c) = f(x, y, c) + 1;
+
+        f.compute_root()
+            .reorder_storage(c, x, y)
+            .split(x, xo, xi, 4)
+            .split(c, co, ci, 4)
+            .reorder(ci, xi, co, xo, y)
+            .vectorize(ci)
+            .vectorize(xi);
+        g.bound(c, 0, 4);
+
+        CheckStores *checker = new CheckStores("f");
+        g.add_custom_lowering_pass(checker);
+
+        Image<uint8_t> result = g.realize(32, 8, 4);
+        for (int ch = 0; ch < 4; ch++) {
+            for (int yy = 0; yy < 8; yy++) {
+                for (int xx = 0; xx < 32; xx++) {
+                    uint8_t correct = (uint8_t)(xx * 3 + yy * 5 + ch * 7 + 1);
+                    if (result(xx, yy, ch) != correct) {
+                        printf("result(%d, %d, %d) = %d instead of %d\n",
+                               xx, yy, ch, result(xx, yy, ch), correct);
+                        return -1;
+                    }
+                }
+            }
+        }
+
+        if (checker->dense_stores == 0 || checker->scatters != 0) {
+            printf("Expected dense 16-wide stores to f, and no scatters. "
+                   "Got %d dense stores and %d scatters\n",
+                   checker->dense_stores, checker->scatters);
+            return -1;
+        }
+    }
+
+    {
+        // A 2x2 block vectorized in both dimensions over a planar
+        // layout. The accesses are rows of the block.
+        Func f("f");
+        Var x("x"), y("y"), xo("xo"), xi("xi"), yo("yo"), yi("yi");
+        f(x, y) = x * 2 + y * 100;
+        f.tile(x, y, xo, yo, xi, yi, 2, 2)
+            .reorder(xi, yi, xo, yo)
+            .vectorize(xi)
+            .vectorize(yi);
+
+        Image<int> result = f.realize(16, 16);
+        for (int yy = 0; yy < 16; yy++) {
+            for (int xx = 0; xx < 16; xx++) {
+                int correct = xx * 2 + yy * 100;
+                if (result(xx, yy) != correct) {
+                    printf("result(%d, %d) = %d instead of %d\n",
+                           xx, yy, result(xx, yy), correct);
+                    return -1;
+                }
+            }
+        }
+    }
+
+    printf("Success!\n");
+    return 0;
+}
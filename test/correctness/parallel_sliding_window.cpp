@@ -0,0 +1,110 @@
+#include <stdio.h>
+#include <atomic>
+#include "Halide.h"
+
+using namespace Halide;
+
+#ifdef _WIN32
+#define DLLEXPORT __declspec(dllexport)
+#else
+#define DLLEXPORT
+#endif
+
+std::atomic<int> count;
+extern "C" DLLEXPORT int call_counter(int x, int y) {
+    count++;
+    return x + 3*y;
+}
+HalideExtern_2(int, call_counter, int, int);
+
+int check(const Image<int> &im, int expected_calls) {
+    for (int y = 0; y < im.height(); y++) {
+        for (int x = 0; x < im.width(); x++) {
+            int correct = 3*x + 9*y;
+            if (im(x, y) != correct) {
+                printf("im(%d, %d) = %d instead of %d\n", x, y, im(x, y), correct);
+                return -1;
+            }
+        }
+    }
+    int c = count;
+    if (c != expected_calls) {
+        printf("f was called %d times instead of %d times\n", c, expected_calls);
+        return -1;
+    }
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    Var x, y;
+
+    {
+        // Strips of 10 rows. Each strip computes the two rows of f
+        // above and below it as well.
+        count = 0;
+        Func f, g;
+        f(x, y) = call_counter(x, y);
+        g(x, y) = f(x, y-1) + f(x, y) + f(x, y+1);
+
+        g.parallel(y);
+        f.store_root().compute_at(g, y).sliding_strip(10);
+
+        Image<int> im = g.realize(10, 100);
+        if (check(im, 10 * 12 * 10) != 0) {
+            return -1;
+        }
+    }
+
+    {
+        // A strip size that doesn't divide the extent. The last
+        // strip is shorter.
+        count = 0;
+        Func f, g;
+        f(x, y) = call_counter(x, y);
+        g(x, y) = f(x, y-1) + f(x, y) + f(x, y+1);
+
+        g.parallel(y);
+        f.store_root().compute_at(g, y).sliding_strip(7);
+
+        Image<int> im = g.realize(10, 100);
+        if (check(im, (14 * 9 + 4) * 10) != 0) {
+            return -1;
+        }
+    }
+
+    {
+        // The default strip size for 100 rows is 12.
+        count = 0;
+        Func f, g;
+        f(x, y) = call_counter(x, y);
+        g(x, y) = f(x, y-1) + f(x, y) + f(x, y+1);
+
+        g.parallel(y);
+        f.store_root().compute_at(g, y);
+
+        Image<int> im = g.realize(10, 100);
+        if (check(im, (14 * 8 + 6) * 10) != 0) {
+            return -1;
+        }
+    }
+
+    {
+        // A strip size of one turns it off, and every row of g
+        // computes three rows of f.
+        count = 0;
+        Func f, g;
+        f(x, y) = call_counter(x, y);
+        g(x, y) = f(x, y-1) + f(x, y) + f(x, y+1);
+
+        g.parallel(y);
+        f.store_root().compute_at(g, y).sliding_strip(1);
+
+        Image<int> im = g.realize(10, 100);
+        if (check(im, 3 * 100 * 10) != 0) {
+            return -1;
+        }
+    }
+
+    printf("Success!\n");
+    return 0;
+}
@@ -0,0 +1,167 @@
+#include "Halide.h"
+#include <stdio.h>
+#include <string>
+
+using namespace Halide;
+using namespace Halide::Internal;
+
+std::string report;
+
+void capture_report(void *user_context, const char *msg) {
+    report += msg;
+}
+
+// Does an Expr test whether k == 3?
+class TestsK3 : public IRVisitor {
+    using IRVisitor::visit;
+
+    void visit(const EQ *op) {
+        const Variable *v = op->a.as<Variable>();
+        if (v && v->name == "k" && is_const(op->b, 3)) {
+            result = true;
+        }
+        IRVisitor::visit(op);
+    }
+public:
+    bool result = false;
+};
+
+// Find a test of k == 3 that isn't in the else case of some other
+// test, and so can be reached.
+class FindReachableK3 : public IRMutator {
+    using IRMutator::visit;
+
+    int in_else = 0;
+
+    void visit(const IfThenElse *op) {
+        TestsK3 tests;
+        op->condition.accept(&tests);
+        if (tests.result && in_else == 0) {
+            found = true;
+        }
+        mutate(op->then_case);
+        in_else++;
+        mutate(op->else_case);
+        in_else--;
+        stmt = op;
+    }
+public:
+    bool found = false;
+};
+
+int main(int argc, char **argv) {
+    ImageParam input(Int(32), 1, "input");
+    Param<int> k("k"), offset("offset");
+    Var x;
+    RDom r(0, k);
+
+    Image<int> in(200);
+    for (int i = 0; i < in.width(); i++) {
+        in(i) = i * 17 - 1000;
+    }
+    input.set(in);
+    offset.set(1);
+
+    // Record the distribution of the parameters of a pipeline over
+    // some runs.
+    const int kernel_sizes[] = {3, 3, 5, 3, 3, 7, 5, 3, 5, 3};
+    {
+        Func f("f");
+        f(x) = sum(input(x + r));
+        f(x) += offset;
+        f.set_custom_print(capture_report);
+
+        Target t = get_jit_target_from_environment().with_feature(Target::ProfileParams);
+        for (int size : kernel_sizes) {
+            k.set(size);
+            f.realize(100, t);
+        }
+    }
+
+    ParamProfile profile;
+    if (!profile.parse(report)) {
+        printf("Malformed parameter profile:\n%s", report.c_str());
+        return -1;
+    }
+
+    const ParamProfile::Field *kernel_size = profile.find("f", "k");
+    const ParamProfile::Field *input_extent = profile.find("f", "input.extent.0");
+    const ParamProfile::Field *output_stride = profile.find("f", "f.stride.0");
+    const ParamProfile::Field *offset_value = profile.find("f", "offset");
+    if (!kernel_size || !input_extent || !output_stride || !offset_value) {
+        printf("Missing fields in parameter profile:\n%s", report.c_str());
+        return -1;
+    }
+    std::map<int64_t, uint64_t> correct_kernel_sizes = {{3, 6}, {5, 3}, {7, 1}};
+    if (kernel_size->total != 10 || kernel_size->counts != correct_kernel_sizes ||
+        input_extent->total != 10 || input_extent->counts.at(200) != 10 ||
+        output_stride->total != 10 || output_stride->counts.at(1) != 10 ||
+        offset_value->counts.size() != 1) {
+        printf("Wrong parameter profile:\n%s", report.c_str());
+        return -1;
+    }
+
+    // Specialize a fresh copy of the pipeline on the two most common
+    // kernel sizes. The offset never changed, so it's part of both
+    // conditions. The input and output extents never changed either,
+    // so they become the expected shapes of the buffers. The strides
+    // in dimension 0 are already constrained to 1.
+    {
+        Func f("f");
+        f(x) = sum(input(x + r));
+        f(x) += offset;
+
+        int count = specialize_on_param_profile({f.function()}, "f", profile, 2);
+        const std::vector<Specialization> &pure = f.function().definition().specializations();
+        const std::vector<Specialization> &update = f.function().update(0).specializations();
+        if (count != 2 || pure.size() != 2 || update.size() != 2) {
+            printf("Expected 2 specializations of each stage instead of %d %d %d\n",
+                   count, (int)pure.size(), (int)update.size());
+            return -1;
+        }
+        // The most common kernel size is tested first.
+        if (!equal(pure[0].condition, Expr(offset) == 1 && Expr(k) == 3) ||
+            !equal(pure[1].condition, Expr(offset) == 1 && Expr(k) == 5)) {
+            printf("Wrong specializations on the kernel size\n");
+            return -1;
+        }
+
+        Parameter output = f.function().output_buffers()[0];
+        if (!equal(input.parameter().extent_specialization(0), 200) ||
+            !equal(output.extent_specialization(0), 100) ||
+            input.parameter().stride_specialization(0).defined() ||
+            output.stride_specialization(0).defined()) {
+            printf("Wrong expected buffer shapes\n");
+            return -1;
+        }
+
+        // The kernel size specialization can be reached.
+        FindReachableK3 *finder = new FindReachableK3;
+        f.add_custom_lowering_pass(finder);
+        f.compile_jit();
+        if (!finder->found) {
+            printf("The specialization for k == 3 can't be reached\n");
+            return -1;
+        }
+
+        // Both the specialized and general cases must be correct.
+        for (int size : {3, 5, 7, 9}) {
+            k.set(size);
+            Image<int> out = f.realize(100);
+            for (int i = 0; i < out.width(); i++) {
+                int correct = 1;
+                for (int j = 0; j < size; j++) {
+                    correct += in(i + j);
+                }
+                if (out(i) != correct) {
+                    printf("out(%d) = %d instead of %d with a kernel size of %d\n",
+                           i, out(i), correct, size);
+                    return -1;
+                }
+            }
+        }
+    }
+
+    printf("Success!\n");
+    return 0;
+}
@@ -0,0 +1,93 @@
+#include "Halide.h"
+#include <stdio.h>
+
+using namespace Halide;
+
+// Loops split with TailStrategy::PeelToAlign start before the min of
+// the region being computed, and are guarded at both ends. Check
+// that they compute exactly the right region, for a variety of
+// sizes and mins that are and aren't aligned.
+int main(int argc, char **argv) {
+    Image<int> input(200, 4);
+    for (int y = 0; y < input.height(); y++) {
+        for (int x = 0; x < input.width(); x++) {
+            input(x, y) = x * 3 + y * 1000;
+        }
+    }
+
+    Var x, y;
+
+    for (int min = 0; min < 9; min++) {
+        for (int width = 1; width < 40; width += 7) {
+            // A pure definition writing to an output.
+            {
+                Func f;
+                f(x, y) = input(x + 1, y) - input(x, y) + y;
+                f.vectorize(x, 8, TailStrategy::PeelToAlign);
+
+                Image<int> out(width, 4);
+                out.set_min(min, 0);
+                f.realize(out);
+                for (int yy = 0; yy < 4; yy++) {
+                    for (int xx = min; xx < min + width; xx++) {
+                        int correct = 3 + yy;
+                        if (out(xx, yy) != correct) {
+                            printf("f(%d, %d) = %d instead of %d\n",
+                                   xx, yy, out(xx, yy), correct);
+                            return -1;
+                        }
+                    }
+                }
+            }
+
+            // An internal stage computed over a region that starts
+            // at a different place than its consumer, and an update
+            // definition.
+            {
+                Func g, h;
+                g(x, y) = input(x, y) * 2;
+                h(x, y) = g(x + 3, y) + g(x - 2 + min, y);
+                h(x, y) += 1;
+                g.compute_root().vectorize(x, 8, TailStrategy::PeelToAlign);
+                h.vectorize(x, 4, TailStrategy::PeelToAlign);
+                h.update().vectorize(x, 4, TailStrategy::PeelToAlign);
+
+                Image<int> out(width, 4);
+                out.set_min(min + 2, 0);
+                h.realize(out);
+                for (int yy = 0; yy < 4; yy++) {
+                    for (int xx = min + 2; xx < min + 2 + width; xx++) {
+                        int correct = input(xx + 3, yy) * 2 + input(xx - 2 + min, yy) * 2 + 1;
+                        if (out(xx, yy) != correct) {
+                            printf("h(%d, %d) = %d instead of %d\n",
+                                   xx, yy, out(xx, yy), correct);
+                            return -1;
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    // A split of a var that isn't a coordinate of the Func directly
+    // falls back to GuardWithIf.
+    {
+        Func f;
+        Var xo, xi;
+        f(x, y) = input(x, y) + 1;
+        f.split(x, xo, xi, 16).vectorize(xi, 8, TailStrategy::PeelToAlign);
+        Image<int> out = f.realize(37, 4);
+        for (int yy = 0; yy < 4; yy++) {
+            for (int xx = 0; xx < 37; xx++) {
+                if (out(xx, yy) != input(xx, yy) + 1) {
+                    printf("f(%d, %d) = %d instead of %d\n",
+                           xx, yy, out(xx, yy), input(xx, yy) + 1);
+                    return -1;
+                }
+            }
+        }
+    }
+
+    printf("Success!\n");
+    return 0;
+}
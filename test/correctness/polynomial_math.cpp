@@ -0,0 +1,184 @@
+#include "Halide.h"
+#include <stdio.h>
+#include <cmath>
+#include <float.h>
+#include <algorithm>
+#include <functional>
+
+using namespace Halide;
+using namespace Halide::Internal;
+
+// The error in a float relative to the correct answer, in units in
+// the last place of the correct answer.
+double ulp_error(float actual, double correct) {
+    float c = (float)correct;
+    if (std::isinf(c) || std::isinf(actual)) {
+        return actual == c ? 0 : INFINITY;
+    }
+    float mag = std::max(fabsf(c), FLT_MIN);
+    double ulp = (double)nextafterf(mag, INFINITY) - mag;
+    return fabs((double)actual - correct) / ulp;
+}
+
+// Count vector calls to a libm function.
+class CountVectorCalls : public IRMutator {
+    using IRMutator::visit;
+
+    void visit(const Call *op) {
+        if (op->name == name && op->type.is_vector()) {
+            count++;
+        }
+        IRMutator::visit(op);
+    }
+
+    std::string name;
+public:
+    int count = 0;
+    CountVectorCalls(const std::string &n) : name(n) {}
+};
+
+const int N = 1 << 16;
+
+// Check an approximation at a range of requested accuracies. Requests
+// tighter than the best approximation available get that one.
+bool check(const char *name, std::function<Expr(Expr, int)> approx,
+           std::function<double(double)> correct,
+           std::function<float(int)> input_value, int best) {
+    Image<float> input(N);
+    for (int i = 0; i < N; i++) {
+        input(i) = input_value(i);
+    }
+
+    for (int bound : {0, 5, 30, 1000, 100000}) {
+        Var x;
+        Func f;
+        f(x) = approx(input(x), bound);
+        f.vectorize(x, 8);
+        Image<float> out = f.realize(N);
+
+        double allowed = std::max(bound, best);
+        for (int i = 0; i < N; i++) {
+            double err = ulp_error(out(i), correct(input(i)));
+            if (!(err <= allowed)) {
+                printf("%s(%.9g) with a bound of %d ULPs = %.9g instead of %.9g (%g ULPs)\n",
+                       name, input(i), bound, out(i), correct(input(i)), err);
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+// Evenly spaced values in [lo, hi].
+std::function<float(int)> linear(float lo, float hi) {
+    return [=](int i) {return lo + (hi - lo) * ((float)i / (N - 1));};
+}
+
+int main(int argc, char **argv) {
+    if (!check("fast_exp", [](Expr x, int b) {return fast_exp(x, b);}, [](double x) {return exp(x);},
+               linear(-87.0f, 88.0f), 3) ||
+        !check("fast_log", [](Expr x, int b) {return fast_log(x, b);}, [](double x) {return log(x);},
+               // Logarithmically spaced values, including denormals.
+               [](int i) {return expf(-100.0f + 180.0f * ((float)i / (N - 1)));}, 3) ||
+        !check("fast_sin", [](Expr x, int b) {return fast_sin(x, b);}, [](double x) {return sin(x);},
+               linear(-4096.0f, 4096.0f), 3) ||
+        !check("fast_cos", [](Expr x, int b) {return fast_cos(x, b);}, [](double x) {return cos(x);},
+               linear(-4096.0f, 4096.0f), 3) ||
+        !check("fast_tanh", [](Expr x, int b) {return fast_tanh(x, b);}, [](double x) {return tanh(x);},
+               linear(-10.0f, 10.0f), 2) ||
+        !check("fast_erf", [](Expr x, int b) {return fast_erf(x, b);}, [](double x) {return erf(x);},
+               linear(-5.0f, 5.0f), 7) ||
+        !check("fast_atan2(x, 1.7)", [](Expr x, int b) {return fast_atan2(x, 1.7f, b);},
+               [](double x) {return atan2(x, 1.7);}, linear(-100.0f, 100.0f), 3) ||
+        !check("fast_atan2(-0.3, x)", [](Expr x, int b) {return fast_atan2(-0.3f, x, b);},
+               [](double x) {return atan2(-0.3, x);}, linear(-100.0f, 100.0f), 3)) {
+        return -1;
+    }
+
+    // Special values.
+    {
+        Func f;
+        f() = Tuple(fast_log(0.0f, 0), fast_log(-1.0f, 0),
+                    fast_exp(100.0f, 0), fast_exp(-200.0f, 0),
+                    fast_atan2(0.0f, 0.0f, 0));
+        Realization r = f.realize();
+        float log_zero = Image<float>(r[0])(), log_neg = Image<float>(r[1])();
+        float exp_big = Image<float>(r[2])(), exp_small = Image<float>(r[3])();
+        float atan2_zero = Image<float>(r[4])();
+        if (!(std::isinf(log_zero) && log_zero < 0) || !std::isnan(log_neg) ||
+            !(std::isinf(exp_big) && exp_big > 0) || exp_small != 0.0f ||
+            atan2_zero != 0.0f) {
+            printf("Wrong special values: %f %f %f %f %f\n",
+                   log_zero, log_neg, exp_big, exp_small, atan2_zero);
+            return -1;
+        }
+    }
+
+    // With fast_vector_math, vectorized calls to sin and friends
+    // should be replaced by the most accurate approximations, instead
+    // of calling libm per lane. Without it they are left alone.
+    for (bool fast_vector_math : {false, true}) {
+        Image<float> input(N);
+        for (int i = 0; i < N; i++) {
+            input(i) = linear(-100.0f, 100.0f)(i);
+        }
+
+        Var x;
+        Func f;
+        f(x) = Tuple(sin(input(x)), cos(input(x)), tanh(input(x)), atan2(input(x), 3.0f));
+        f.vectorize(x, 8);
+        std::vector<CountVectorCalls *> counters;
+        for (const char *name : {"sin_f32", "cos_f32", "tanh_f32", "atan2_f32"}) {
+            counters.push_back(new CountVectorCalls(name));
+            f.add_custom_lowering_pass(counters.back());
+        }
+        Target target = get_jit_target_from_environment();
+        if (fast_vector_math) {
+            target.set_feature(Target::FastVectorMath);
+        }
+        Realization r = f.realize(N, target);
+        for (CountVectorCalls *c : counters) {
+            if ((c->count != 0) == fast_vector_math) {
+                printf("Found %d vector calls to libm with fast_vector_math %s\n",
+                       c->count, fast_vector_math ? "on" : "off");
+                return -1;
+            }
+        }
+
+        Image<float> s(r[0]), c(r[1]), t(r[2]), a(r[3]);
+        for (int i = 0; i < N; i++) {
+            double v = input(i);
+            if (ulp_error(s(i), sin(v)) > 3 ||
+                ulp_error(c(i), cos(v)) > 3 ||
+                ulp_error(t(i), tanh(v)) > 2 ||
+                ulp_error(a(i), atan2(v, 3.0)) > 3) {
+                printf("Vectorized transcendentals of %f are inaccurate: %.9g %.9g %.9g %.9g\n",
+                       v, s(i), c(i), t(i), a(i));
+                return -1;
+            }
+        }
+    }
+
+    // pow loses accuracy in proportion to |y * log(x)|, which is at
+    // most about 8 here.
+    {
+        Var x, y;
+        Func f;
+        f(x, y) = fast_pow((x + 1) / 64.0f, (y - 32) / 16.0f, 0);
+        f.vectorize(x, 8);
+        Image<float> out = f.realize(256, 64);
+        for (int j = 0; j < out.height(); j++) {
+            for (int i = 0; i < out.width(); i++) {
+                double correct = pow((i + 1) / 64.0, (j - 32) / 16.0);
+                if (ulp_error(out(i, j), correct) > 64) {
+                    printf("fast_pow(%f, %f) = %.9g instead of %.9g\n",
+                           (i + 1) / 64.0, (j - 32) / 16.0, out(i, j), correct);
+                    return -1;
+                }
+            }
+        }
+    }
+
+    printf("Success!\n");
+    return 0;
+}
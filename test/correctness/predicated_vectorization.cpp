@@ -0,0 +1,184 @@
+#include "Halide.h"
+#include <stdio.h>
+#include <iostream>
+
+using namespace Halide;
+using namespace Halide::Internal;
+
+// Count the vector stores that are predicated.
+class CountPredicatedStores : public IRMutator {
+    using IRMutator::visit;
+
+    void visit(const Store *op) {
+        if (op->value.type().is_vector() && !is_one(op->predicate)) {
+            predicated_stores++;
+        }
+        IRMutator::visit(op);
+    }
+
+public:
+    int predicated_stores = 0;
+};
+
+// Count the loops, and the integer divisions by something that may
+// be zero in lanes that are turned off.
+class CountLoopsAndDivisions : public IRVisitor {
+    using IRVisitor::visit;
+
+    void visit(const For *op) {
+        loops++;
+        IRVisitor::visit(op);
+    }
+
+    void visit(const Div *op) {
+        if (!op->b.as<Select>()) {
+            unguarded_divisions++;
+        }
+        IRVisitor::visit(op);
+    }
+
+public:
+    int loops = 0, unguarded_divisions = 0;
+};
+
+int main(int argc, char **argv) {
+    // Skip this test on targets that scalarize instead.
+    Target t = get_jit_target_from_environment();
+    if (t.has_gpu_feature() || t.arch == Target::Hexagon) {
+        printf("Not running test on GPU or Hexagon targets\n");
+        printf("Success!\n");
+        return 0;
+    }
+
+    const int size = 103;
+    Image<int> input(size);
+    for (int i = 0; i < size; i++) {
+        input(i) = (i * 37) % 100;
+    }
+
+    {
+        // A data-dependent condition in an update vectorized over
+        // the reduction domain.
+        Func f;
+        Var x;
+        RDom r(0, size);
+        r.where(input(r) > 50);
+        f(x) = x;
+        f(r) = f(r) * 2 + input(r);
+
+        RVar ro, ri;
+        f.update().split(r, ro, ri, 8, TailStrategy::GuardWithIf).vectorize(ri);
+
+        CountPredicatedStores *counter = new CountPredicatedStores;
+        f.add_custom_lowering_pass(counter);
+
+        Image<int> result = f.realize(size);
+        for (int i = 0; i < size; i++) {
+            int correct = input(i) > 50 ? i * 2 + input(i) : i;
+            if (result(i) != correct) {
+                printf("result(%d) = %d instead of %d\n", i, result(i), correct);
+                return -1;
+            }
+        }
+
+        if (counter->predicated_stores == 0) {
+            printf("Expected the update to use predicated stores\n");
+            return -1;
+        }
+    }
+
+    {
+        // A vector loop tail of an odd size with data-dependent
+        // conditions inside.
+        Func g;
+        Var x;
+        RDom r1(0, size), r2(0, size);
+        r1.where(input(r1) % 3 == 0);
+        r2.where(input(r2) % 3 != 0);
+        g(x) = 0;
+        g(r1) = input(r1);
+        g(r2) = input(r2) * 2;
+
+        g.update(0).vectorize(r1, 8, TailStrategy::GuardWithIf);
+        g.update(1).vectorize(r2, 8, TailStrategy::GuardWithIf);
+
+        CountPredicatedStores *counter = new CountPredicatedStores;
+        g.add_custom_lowering_pass(counter);
+
+        Image<int> result = g.realize(size);
+        for (int i = 0; i < size; i++) {
+            int correct = input(i) % 3 == 0 ? input(i) : input(i) * 2;
+            if (result(i) != correct) {
+                printf("result(%d) = %d instead of %d\n", i, result(i), correct);
+                return -1;
+            }
+        }
+
+        if (counter->predicated_stores == 0) {
+            printf("Expected the loop tails to use predicated stores\n");
+            return -1;
+        }
+    }
+
+    {
+        // Integer division must not happen in the lanes that are
+        // turned off, where the divisor may be zero.
+        Image<int> d(size);
+        for (int i = 0; i < size; i++) {
+            d(i) = i % 4;
+        }
+
+        Func h;
+        Var x;
+        RDom r(0, size);
+        r.where(d(r) != 0);
+        h(x) = 0;
+        h(r) = input(r) / d(r);
+        h.update().vectorize(r, 8, TailStrategy::GuardWithIf);
+
+        CountPredicatedStores *counter = new CountPredicatedStores;
+        h.add_custom_lowering_pass(counter);
+
+        Image<int> result = h.realize(size);
+        for (int i = 0; i < size; i++) {
+            int correct = d(i) != 0 ? input(i) / d(i) : 0;
+            if (result(i) != correct) {
+                printf("result(%d) = %d instead of %d\n", i, result(i), correct);
+                return -1;
+            }
+        }
+
+        if (counter->predicated_stores == 0) {
+            printf("Expected the division to use predicated stores\n");
+            return -1;
+        }
+    }
+
+    {
+        // Both sides of an if/else with a vector condition are run
+        // with their stores predicated on the condition and its
+        // negation, instead of being scalarized.
+        Expr x = Variable::make(Int(32), "x");
+        Expr in = Load::make(Int(32), "in", x, BufferPtr(), Parameter());
+        Stmt s = IfThenElse::make(in > 50,
+                                  Store::make("out", in, x, Parameter()),
+                                  Store::make("out", 100 / in, x, Parameter()));
+        s = For::make("x", 0, 8, ForType::Vectorized, DeviceAPI::None, s);
+        s = vectorize_loops(s, t);
+
+        CountPredicatedStores counter;
+        counter.mutate(s);
+        CountLoopsAndDivisions loops_and_divisions;
+        s.accept(&loops_and_divisions);
+        if (counter.predicated_stores != 2 ||
+            loops_and_divisions.loops != 0 ||
+            loops_and_divisions.unguarded_divisions != 0) {
+            std::cout << "Expected an if/else with two predicated stores and a guarded division "
+                      << "instead of:\n" << s;
+            return -1;
+        }
+    }
+
+    printf("Success!\n");
+    return 0;
+}
@@ -0,0 +1,86 @@
+#include "Halide.h"
+#include <stdio.h>
+
+using namespace Halide;
+
+int main(int argc, char **argv) {
+    ImageParam in(Float(32), 2);
+    Param<float> gain;
+    Param<uint8_t> offset;
+    Var x, y;
+
+    Func f, g;
+    f(x, y) = in(x, y) * gain + offset;
+    g(x, y) = cast<int>(in(x, y)) + x;
+    f.vectorize(x, 4);
+
+    Image<float> in1(32, 16), in2(32, 16);
+    for (int y = 0; y < 16; y++) {
+        for (int x = 0; x < 32; x++) {
+            in1(x, y) = (float)(x + y);
+            in2(x, y) = (float)(x * y);
+        }
+    }
+
+    in.set(in1);
+    gain.set(2.0f);
+    offset.set(3);
+
+    Pipeline p({f, g});
+    PreparedPipeline prepared = p.prepare();
+
+    // Changing the Pipeline's params doesn't affect the prepared
+    // pipeline, which took their values when it was made.
+    gain.set(100.0f);
+
+    Image<float> f_out(32, 16);
+    Image<int> g_out(32, 16);
+    prepared(Realization(f_out, g_out));
+    for (int y = 0; y < 16; y++) {
+        for (int x = 0; x < 32; x++) {
+            float correct_f = in1(x, y) * 2.0f + 3;
+            int correct_g = (int)in1(x, y) + x;
+            if (f_out(x, y) != correct_f || g_out(x, y) != correct_g) {
+                printf("out(%d, %d) = {%f, %d} instead of {%f, %d}\n",
+                       x, y, f_out(x, y), g_out(x, y), correct_f, correct_g);
+                return -1;
+            }
+        }
+    }
+
+    // Rebind everything and call again, many times.
+    prepared.set(gain, 0.5f).set(offset, 7).set(in, in2);
+    for (int i = 0; i < 10; i++) {
+        prepared(Realization(f_out, g_out));
+    }
+    for (int y = 0; y < 16; y++) {
+        for (int x = 0; x < 32; x++) {
+            float correct_f = in2(x, y) * 0.5f + 7;
+            int correct_g = (int)in2(x, y) + x;
+            if (f_out(x, y) != correct_f || g_out(x, y) != correct_g) {
+                printf("out(%d, %d) = {%f, %d} instead of {%f, %d}\n",
+                       x, y, f_out(x, y), g_out(x, y), correct_f, correct_g);
+                return -1;
+            }
+        }
+    }
+
+    // A single-output pipeline can be called with an Image directly.
+    Pipeline p2(f);
+    PreparedPipeline prepared2 = p2.prepare();
+    prepared2.set(in, in1);
+    prepared2(f_out);
+    for (int y = 0; y < 16; y++) {
+        for (int x = 0; x < 32; x++) {
+            float correct = in1(x, y) * 100.0f + 3;
+            if (f_out(x, y) != correct) {
+                printf("f_out(%d, %d) = %f instead of %f\n",
+                       x, y, f_out(x, y), correct);
+                return -1;
+            }
+        }
+    }
+
+    printf("Success!\n");
+    return 0;
+}
@@ -276,6 +276,9 @@ void check_sse_all() {
         check("pavgb", 8*w, u8((u16(u8_1) + u16(u8_2) + 1)>>1));
         check("pavgw", 4*w, u16((u32(u16_1) + u32(u16_2) + 1)/2));
         check("pavgw", 4*w, u16((u32(u16_1) + u32(u16_2) + 1)>>1));
+        // A rounding shift right by one is an average with zero.
+        check("pavgb", 8*w, u8((u16(u8_1) + 1)/2));
+        check("pavgw", 4*w, u16((u32(u16_1) + 1)/2));
         check("pmaxsw", 4*w, max(i16_1, i16_2));
         check("pminsw", 4*w, min(i16_1, i16_2));
         check("pmaxub", 8*w, max(u8_1, u8_2));
@@ -592,6 +595,11 @@ void check_neon_all() {
         check(arm32 ? "vabd.s32" : "sabd", 2*w, u32(abs(i64(i32_2) - i32_3)));
         check(arm32 ? "vabd.u32" : "uabd", 2*w, u32(abs(i64(u32_2) - u32_3)));
 
+        // Written out with a select, or as max - min
+        check(arm32 ? "vabd.u8"  : "uabd", 8*w, select(u8_2 > u8_3, u8_2 - u8_3, u8_3 - u8_2));
+        check(arm32 ? "vabd.s16" : "sabd", 4*w, select(i16_2 < i16_3, i16_3 - i16_2, i16_2 - i16_3));
+        check(arm32 ? "vabd.u16" : "uabd", 4*w, max(u16_2, u16_3) - min(u16_2, u16_3));
+
         // VABDL    I       -       Absolute Difference Long
         check(arm32 ? "vabdl.s8"  : "sabdl", 8*w, i16(absd(i8_2, i8_3)));
         check(arm32 ? "vabdl.u8"  : "uabdl", 8*w, u16(absd(u8_2, u8_3)));
@@ -1089,10 +1097,14 @@ void check_neon_all() {
         check(arm32 ? "vrhadd.u32" : "urhadd", 2*w, u32((u64(u32_1) + u64(u32_2) + 1)/2));
 
         // VRSHL    I       -       Rounding Shift Left
-        // VRSHR    I       -       Rounding Shift Right
         // VRSHRN   I       -       Rounding Shift Right Narrow
         // We use the non-rounding forms of these
 
+        // VRSHR    I       -       Rounding Shift Right
+        check(arm32 ? "vrshr.u8"  : "urshr", 8*w,  u8((u16(u8_1) + 8)/16));
+        check(arm32 ? "vrshr.s16" : "srshr", 4*w, i16((i32(i16_1) + 32)/64));
+        check(arm32 ? "vrshr.u32" : "urshr", 2*w, u32((u64(u32_1) + 4)/8));
+
         // VRSQRTE  I, F    -       Reciprocal Square Root Estimate
         check(arm32 ? "vrsqrte.f32" : "frsqrte", 4*w, fast_inverse_sqrt(f32_1));
 
@@ -0,0 +1,126 @@
+#include "Halide.h"
+#include <stdio.h>
+
+using namespace Halide;
+using namespace Halide::Internal;
+
+// Count the asserts in the two branches of the test of the
+// specialized shapes.
+class CountAsserts : public IRMutator {
+    using IRMutator::visit;
+
+    struct MentionsVar : public IRVisitor {
+        using IRVisitor::visit;
+        std::string name;
+        bool result = false;
+        void visit(const Variable *op) {
+            result = result || op->name == name;
+        }
+    };
+
+    struct Count : public IRVisitor {
+        using IRVisitor::visit;
+        int count = 0;
+        void visit(const AssertStmt *op) {
+            count++;
+            IRVisitor::visit(op);
+        }
+    };
+
+    void visit(const IfThenElse *op) {
+        MentionsVar m;
+        m.name = "in.stride.1";
+        op->condition.accept(&m);
+        if (m.result && op->else_case.defined()) {
+            found++;
+            Count c1, c2;
+            op->then_case.accept(&c1);
+            op->else_case.accept(&c2);
+            specialized_asserts += c1.count;
+            general_asserts += c2.count;
+        }
+        IRMutator::visit(op);
+    }
+public:
+    int found = 0, specialized_asserts = 0, general_asserts = 0;
+};
+
+int check(Func f, ImageParam in, int W, int H) {
+    Image<float> input(W + 1, H);
+    for (int y = 0; y < H; y++) {
+        for (int x = 0; x < W + 1; x++) {
+            input(x, y) = (float)(x * 3 + y);
+        }
+    }
+    in.set(input);
+
+    Image<float> output(W, H);
+    f.realize(output);
+    for (int y = 0; y < H; y++) {
+        for (int x = 0; x < W; x++) {
+            float correct = input(x, y) + input(x + 1, y) * 2;
+            if (output(x, y) != correct) {
+                printf("%dx%d: output(%d, %d) = %f instead of %f\n",
+                       W, H, x, y, output(x, y), correct);
+                return -1;
+            }
+        }
+    }
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    ImageParam in(Float(32), 2, "in");
+    Var x, y;
+    Func f;
+    f(x, y) = in(x, y) + in(x + 1, y) * 2;
+    f.vectorize(x, 4);
+
+    // We expect to be called on 64x32 tiles.
+    in.dim(0).specialize_bounds(0, 65).specialize_stride(1);
+    in.dim(1).specialize_bounds(0, 32).specialize_stride(65);
+    f.output_buffer().dim(0).specialize_bounds(0, 64).specialize_stride(1);
+    f.output_buffer().dim(1).specialize_bounds(0, 32).specialize_stride(64);
+
+    CountAsserts *counter = new CountAsserts;
+    f.add_custom_lowering_pass(counter);
+
+    // The specialized path.
+    if (check(f, in, 64, 32)) {
+        return -1;
+    }
+
+    if (counter->found != 1) {
+        printf("Didn't find the test of the specialized shapes\n");
+        return -1;
+    }
+
+    if (counter->specialized_asserts != 0) {
+        printf("Found %d asserts in the specialized path\n", counter->specialized_asserts);
+        return -1;
+    }
+
+    if (counter->general_asserts == 0) {
+        printf("Found no asserts in the general path\n");
+        return -1;
+    }
+
+    // The general path.
+    if (check(f, in, 40, 17)) {
+        return -1;
+    }
+
+    // Bounds queries take the general path too.
+    in.reset();
+    Image<float> output(64, 32);
+    f.infer_input_bounds(output);
+    Image<float> inferred = in.get();
+    if (inferred.width() != 65 || inferred.height() != 32) {
+        printf("Inferred an input of size %dx%d instead of 65x32\n",
+               inferred.width(), inferred.height());
+        return -1;
+    }
+
+    printf("Success!\n");
+    return 0;
+}
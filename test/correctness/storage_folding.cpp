@@ -29,13 +29,15 @@ int main(int argc, char **argv) {
         g(x, y, c) = f(x-1, y+1, c) + f(x, y-1, c);
         f.store_root().compute_at(g, x);
 
-        // Should be able to fold storage in y and c
+        // Should be able to fold storage in y and c. Three rows are
+        // live at a time. Rounding that up to four would waste a
+        // third of the buffer, so it should fold by exactly three.
 
         g.set_custom_allocator(my_malloc, my_free);
 
         Image<int> im = g.realize(100, 1000, 3);
 
-        size_t expected_size = 101*4*sizeof(int) + sizeof(int);
+        size_t expected_size = 101*3*sizeof(int) + sizeof(int);
         if (custom_malloc_size == 0 || custom_malloc_size != expected_size) {
             printf("Scratch space allocated was %d instead of %d\n", (int)custom_malloc_size, (int)expected_size);
             return -1;
@@ -240,10 +242,9 @@ int main(int argc, char **argv) {
 
         // This is the same test as the above, except the stencil
         // requires 3 rows, of g, not 4. Test explicit storage folding
-        // by forcing it to fold over 3 elements. Automatic storage
-        // folding would prefer to fold by 4 elements to make modular
-        // arithmetic cheaper, but folding by 3 is valid and supported
-        // (e.g. if memory usage is a concern.)
+        // by forcing it to fold over 3 elements. Folding by a
+        // non-power-of-two is valid and supported (e.g. if memory
+        // usage is a concern.)
         g.compute_at(f, x).store_root().fold_storage(y, 3);
 
         f.set_custom_allocator(my_malloc, my_free);
@@ -324,6 +325,61 @@ int main(int argc, char **argv) {
         }
     }
 
+    {
+        custom_malloc_size = 0;
+        Func f, g;
+
+        f(x, y) = x + 2*y;
+        g(x) = f(x-1, x-1) + f(x, x) + f(x+1, x+1);
+
+        // The footprint of f slides along the diagonal, so it's
+        // monotonic in both x and y over the loop over g. Folding
+        // both dimensions should get it down to a 3x3 stack
+        // allocation. Folding only one would need a heap allocation
+        // spanning the whole of the other.
+        f.store_root().compute_at(g, x);
+
+        g.set_custom_allocator(my_malloc, my_free);
+
+        Image<int> im = g.realize(10000);
+
+        if (custom_malloc_size != 0) {
+            printf("There should not have been a heap allocation\n");
+            return -1;
+        }
+
+        for (int x = 0; x < im.width(); x++) {
+            int correct = 3*(x-1) + 3*x + 3*(x+1);
+            if (im(x) != correct) {
+                printf("im(%d) = %d instead of %d\n", x, im(x), correct);
+                return -1;
+            }
+        }
+    }
+
+    {
+        Func f, g;
+
+        f(x, y) = x + 2*y;
+        g(x) = f(x-1, x-1) + f(x, x) + f(x+1, x+1);
+
+        // Fold both dimensions explicitly, by extents that aren't
+        // powers of two.
+        f.store_root().compute_at(g, x).fold_storage({x, y}, {5, 6});
+
+        g.set_custom_allocator(my_malloc, my_free);
+
+        Image<int> im = g.realize(10000);
+
+        for (int x = 0; x < im.width(); x++) {
+            int correct = 9*x;
+            if (im(x) != correct) {
+                printf("im(%d) = %d instead of %d\n", x, im(x), correct);
+                return -1;
+            }
+        }
+    }
+
     printf("Success!\n");
     return 0;
 }
@@ -0,0 +1,182 @@
+#include "Halide.h"
+#include <stdio.h>
+
+using namespace Halide;
+using namespace Halide::Internal;
+
+// Count the vector loads that aren't dense.
+class CountStridedLoads : public IRMutator {
+    using IRMutator::visit;
+
+    void visit(const Load *op) {
+        const Ramp *r = op->index.as<Ramp>();
+        if (op->type.is_vector() && !(r && is_one(r->stride))) {
+            count++;
+        }
+        IRMutator::visit(op);
+    }
+public:
+    int count = 0;
+};
+
+template<typename T>
+int test_transpose(int n) {
+    const int W = 96, H = 48;
+    Image<T> input(H, W);
+    for (int y = 0; y < input.height(); y++) {
+        for (int x = 0; x < input.width(); x++) {
+            input(x, y) = (T)(x * 3 + y * 7);
+        }
+    }
+
+    Var x, y;
+    Func f;
+    f(x, y) = input(y, x);
+    f.transpose_tile(x, y, n);
+
+    CountStridedLoads *counter = new CountStridedLoads;
+    f.add_custom_lowering_pass(counter);
+
+    Image<T> result = f.realize(W, H);
+
+    for (int y = 0; y < H; y++) {
+        for (int x = 0; x < W; x++) {
+            if (result(x, y) != input(y, x)) {
+                printf("%dx%d transpose: result(%d, %d) = %d instead of %d\n",
+                       n, n, x, y, (int)result(x, y), (int)input(y, x));
+                return -1;
+            }
+        }
+    }
+
+    if (counter->count != 0) {
+        printf("%dx%d transpose: found %d strided loads\n", n, n, counter->count);
+        return -1;
+    }
+
+    return 0;
+}
+
+int test_packed_to_planar(int channels) {
+    const int W = 64, H = 16;
+    Image<uint8_t> input = Image<uint8_t>::make_interleaved(W, H, channels);
+    for (int y = 0; y < H; y++) {
+        for (int x = 0; x < W; x++) {
+            for (int c = 0; c < channels; c++) {
+                input(x, y, c) = (uint8_t)(x + y * 5 + c * 101);
+            }
+        }
+    }
+
+    Var x, y, c;
+    Func f;
+    f(x, y, c) = input(x, y, c);
+    f.bound(c, 0, channels).reorder(c, x, y).unroll(c).vectorize(x, 16);
+
+    CountStridedLoads *counter = new CountStridedLoads;
+    f.add_custom_lowering_pass(counter);
+
+    Image<uint8_t> result = f.realize(W, H, channels);
+
+    for (int y = 0; y < H; y++) {
+        for (int x = 0; x < W; x++) {
+            for (int c = 0; c < channels; c++) {
+                if (result(x, y, c) != input(x, y, c)) {
+                    printf("%d channel packed to planar: result(%d, %d, %d) = %d instead of %d\n",
+                           channels, x, y, c, result(x, y, c), input(x, y, c));
+                    return -1;
+                }
+            }
+        }
+    }
+
+    if (counter->count != 0) {
+        printf("%d channel packed to planar: found %d strided loads\n", channels, counter->count);
+        return -1;
+    }
+
+    return 0;
+}
+
+int test_deinterleave(int factor) {
+    const int W = 240;
+    Image<int> input(W);
+    for (int x = 0; x < W; x++) {
+        input(x) = x * 13;
+    }
+
+    // Indexing with x % factor makes the lowering split the vector
+    // into factor interleaved pieces.
+    Var x;
+    Func f;
+    f(x) = input(x / factor) + x % factor;
+    f.vectorize(x, factor * 4);
+
+    Image<int> result = f.realize(W);
+
+    for (int x = 0; x < W; x++) {
+        int correct = input(x / factor) + x % factor;
+        if (result(x) != correct) {
+            printf("deinterleave by %d: result(%d) = %d instead of %d\n",
+                   factor, x, result(x), correct);
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+// The strided loads of an 8x8 transpose, optionally behind a
+// condition, which must not be moved ahead of it.
+int test_guarded_loads(bool guarded) {
+    const int n = 8;
+    Expr cond = Variable::make(Bool(n), "cond");
+    std::vector<Stmt> stores;
+    for (int k = 0; k < n; k++) {
+        Expr value = Load::make(Int(32, n), "in", Ramp::make(k, n, n), BufferPtr(), Parameter());
+        if (guarded) {
+            value = Call::make(value.type(), Call::if_then_else,
+                               {cond, value, Broadcast::make(0, n)}, Call::PureIntrinsic);
+        }
+        stores.push_back(Store::make("out", value, Ramp::make(k * n, 1, n), Parameter()));
+    }
+
+    CountStridedLoads counter;
+    counter.mutate(rewrite_transposes(Block::make(stores)));
+    int expected = guarded ? n : 0;
+    if (counter.count != expected) {
+        printf("Expected %d strided loads in the %s transpose, found %d\n",
+               expected, guarded ? "guarded" : "unguarded", counter.count);
+        return -1;
+    }
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    if (test_transpose<uint16_t>(8) ||
+        test_transpose<uint8_t>(16) ||
+        test_transpose<float>(4) ||
+        test_transpose<int>(3) ||
+        test_transpose<uint16_t>(2)) {
+        return -1;
+    }
+
+    for (int channels : {2, 3, 4}) {
+        if (test_packed_to_planar(channels)) {
+            return -1;
+        }
+    }
+
+    for (int factor = 2; factor <= 8; factor++) {
+        if (test_deinterleave(factor)) {
+            return -1;
+        }
+    }
+
+    if (test_guarded_loads(false) || test_guarded_loads(true)) {
+        return -1;
+    }
+
+    printf("Success!\n");
+    return 0;
+}
@@ -0,0 +1,178 @@
+#include "Halide.h"
+#include <stdio.h>
+#include <cmath>
+
+using namespace Halide;
+using namespace Halide::Internal;
+
+// Count the horizontal reductions, and the allocations of vector
+// accumulators.
+class CountReductions : public IRMutator {
+    using IRMutator::visit;
+
+    void visit(const Call *op) {
+        if (op->is_intrinsic(Call::vector_reduce_add) ||
+            op->is_intrinsic(Call::vector_reduce_max)) {
+            reductions++;
+        }
+        IRMutator::visit(op);
+    }
+
+    void visit(const Allocate *op) {
+        if (op->name.find(".accumulator") != std::string::npos) {
+            accumulators++;
+        }
+        IRMutator::visit(op);
+    }
+
+public:
+    int reductions = 0, accumulators = 0;
+};
+
+int main(int argc, char **argv) {
+    // Hexagon has no horizontal reductions, so the updates are done
+    // one lane at a time there.
+    Target t = get_jit_target_from_environment();
+    bool has_reductions = t.arch != Target::Hexagon;
+
+    const int size = 1024, rows = 8, width = 100;
+    Image<int> a(size), b(size);
+    Image<uint8_t> bytes(width, rows);
+    Image<float> floats(size);
+    for (int i = 0; i < size; i++) {
+        a(i) = (i * 17) % 31 - 15;
+        b(i) = (i * 7) % 13 - 6;
+        floats(i) = (float)((i * 37) % 1000) / 10.0f;
+    }
+    for (int y = 0; y < rows; y++) {
+        for (int x = 0; x < width; x++) {
+            bytes(x, y) = (uint8_t)(x * 3 + y * 61);
+        }
+    }
+
+    {
+        // A dot product. No allow_race_conditions is required.
+        Func dot;
+        RDom r(0, size);
+        dot() = 0;
+        dot() += a(r) * b(r);
+        dot.update().vectorize(r, 8);
+
+        CountReductions *counter = new CountReductions;
+        dot.add_custom_lowering_pass(counter);
+
+        Image<int> result = dot.realize();
+        int correct = 0;
+        for (int i = 0; i < size; i++) {
+            correct += a(i) * b(i);
+        }
+        if (result(0) != correct) {
+            printf("dot = %d instead of %d\n", result(0), correct);
+            return -1;
+        }
+
+        if (has_reductions && (counter->reductions == 0 || counter->accumulators == 0)) {
+            printf("Expected the dot product to accumulate in a vector and reduce once. "
+                   "Found %d reductions and %d accumulators\n",
+                   counter->reductions, counter->accumulators);
+            return -1;
+        }
+    }
+
+    {
+        // Row sums of bytes into 32 bits, with a loop tail.
+        Func row_sum;
+        Var y;
+        RDom r(0, width);
+        row_sum(y) = cast<uint32_t>(0);
+        row_sum(y) += cast<uint32_t>(bytes(r, y));
+        row_sum.update().vectorize(r, 16);
+
+        CountReductions *counter = new CountReductions;
+        row_sum.add_custom_lowering_pass(counter);
+
+        Image<uint32_t> result = row_sum.realize(rows);
+        for (int yy = 0; yy < rows; yy++) {
+            uint32_t correct = 0;
+            for (int x = 0; x < width; x++) {
+                correct += bytes(x, yy);
+            }
+            if (result(yy) != correct) {
+                printf("row_sum(%d) = %u instead of %u\n", yy, result(yy), correct);
+                return -1;
+            }
+        }
+
+        if (has_reductions && counter->reductions == 0) {
+            printf("Expected the row sum to use horizontal reductions\n");
+            return -1;
+        }
+    }
+
+    {
+        // A maximum, which is exact for floats.
+        Func biggest;
+        RDom r(0, size);
+        biggest() = floats(0);
+        biggest() = max(biggest(), floats(r));
+        biggest.update().vectorize(r, 4);
+
+        Image<float> result = biggest.realize();
+        float correct = floats(0);
+        for (int i = 0; i < size; i++) {
+            correct = std::max(correct, floats(i));
+        }
+        if (result(0) != correct) {
+            printf("biggest = %f instead of %f\n", result(0), correct);
+            return -1;
+        }
+    }
+
+    {
+        // A minimum and maximum over infinities must not stop at
+        // the largest finite floats.
+        Image<float> infs(64);
+        for (int i = 0; i < infs.width(); i++) {
+            infs(i) = (i % 2) ? INFINITY : -INFINITY;
+        }
+        Func lo, hi;
+        RDom r(0, infs.width());
+        lo() = INFINITY;
+        lo() = min(lo(), infs(r));
+        hi() = -INFINITY;
+        hi() = max(hi(), infs(r));
+        lo.update().vectorize(r, 8);
+        hi.update().vectorize(r, 8);
+
+        float lo_result = Image<float>(lo.realize())();
+        float hi_result = Image<float>(hi.realize())();
+        if (lo_result != -INFINITY || hi_result != INFINITY) {
+            printf("min and max of infinities are %f and %f\n", lo_result, hi_result);
+            return -1;
+        }
+    }
+
+    {
+        // An update that isn't associative can't be a horizontal
+        // reduction, and must still see every lane's value in turn.
+        Func poly;
+        RDom r(0, size);
+        poly() = 0;
+        poly() = poly() * 3 + a(r);
+        poly.update().allow_race_conditions().vectorize(r, 8);
+
+        Image<int> result = poly.realize();
+        int correct = 0;
+        for (int i = 0; i < size; i++) {
+            // Wrap around like Halide's int32 arithmetic.
+            correct = (int)((uint32_t)correct * 3 + (uint32_t)a(i));
+        }
+        if (result(0) != correct) {
+            printf("poly = %d instead of %d\n", result(0), correct);
+            return -1;
+        }
+    }
+
+    printf("Success!\n");
+    return 0;
+}